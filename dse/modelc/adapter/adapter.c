@@ -4,6 +4,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <string.h>
 #include <errno.h>
@@ -12,8 +13,12 @@
 #include <dse/clib/collections/hashmap.h>
 #include <dse/clib/util/strings.h>
 #include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/encoding.h>
 #include <dse/modelc/adapter/private.h>
+#include <dse/modelc/adapter/realtime.h>
+#include <dse/modelc/adapter/timeline.h>
 #include <dse/modelc/adapter/timer.h>
+#include <dse/modelc/adapter/tracelog.h>
 #include <dse/modelc/controller/model_private.h>
 
 
@@ -82,6 +87,12 @@ Adapter* adapter_create(Endpoint* endpoint)
     }
     adapter->stop_request = false;
     adapter->endpoint = endpoint;
+    adapter->sv_encoding = SV_ENCODING_V1; /* Until negotiated. */
+
+    /* Deferred trace log (SIMBUS_TRACEFILE). */
+    tracelog_open_env();
+    /* Timeline recorder (SIMBUS_TIMELINE). */
+    timeline_open_env(endpoint->bus_mode ? "simbus" : "modelc");
 
     return adapter;
 
@@ -180,6 +191,21 @@ Channel* adapter_init_channel(AdapterModel* am, const char* channel_name,
 }
 
 
+void adapter_set_signal_deadband(Channel* channel, const char* signal_name,
+    double absolute, double relative)
+{
+    assert(channel);
+
+    SignalValue* sv = _get_signal_value(channel, signal_name);
+    sv->deadband = absolute;
+    sv->deadband_relative = relative;
+    if (absolute != 0.0 || relative != 0.0) {
+        log_debug("Signal deadband: %s (absolute=%f, relative=%f)",
+            signal_name, absolute, relative);
+    }
+}
+
+
 Channel* adapter_get_channel(AdapterModel* am, const char* channel_name)
 {
     /* Public interface to get channel, decoupled. */
@@ -200,7 +226,42 @@ void adapter_connect(Adapter* adapter, SimulationSpec* sim, int retry_count)
         AdapterModel*         am = mip->adapter_model;
         rc |= adapter->vtable->connect(am, sim, retry_count);
     }
-    if (rc != 0) log_error("Adapter connect error (%d)", rc);
+    /* Not connected (errno is set), unless stopped the Model can not
+       continue. */
+    if (rc != 0 && adapter->stop_request == false) {
+        log_fatal("Adapter connect error (%d)", rc);
+    }
+}
+
+
+static int _prefault_signal_value(void* _sv, void* _data)
+{
+    UNUSED(_data);
+    SignalValue* sv = _sv;
+    realtime_prefault(sv->bin, sv->bin_buffer_size);
+    return 0;
+}
+
+
+/* Pre-fault the buffers of the Adapter Model (allocated by registration) so
+   that page faults do not occur on the realtime path. Transport buffers are
+   not included (see realtime_apply(), mlock). */
+static void _prefault_adapter_model(AdapterModel* am)
+{
+    for (uint32_t i = 0; i < am->channels_length; i++) {
+        Channel* ch = _get_channel_byindex(am, i);
+        hashmap_iterator(
+            &ch->signal_values, _prefault_signal_value, false, NULL);
+        realtime_prefault(
+            ch->index.names, ch->index.capacity * sizeof(const char*));
+        realtime_prefault(ch->index.map, ch->index.capacity * sizeof(SignalMap));
+        realtime_prefault(ch->batch.data, ch->batch.size);
+        realtime_prefault(ch->forward.data, ch->forward.size);
+        realtime_prefault(ch->forward.written,
+            ch->forward.written_capacity * sizeof(SignalValue*));
+        realtime_prefault(
+            ch->changed.signal, ch->changed.capacity * sizeof(SignalValue*));
+    }
 }
 
 
@@ -216,6 +277,7 @@ void adapter_register(Adapter* adapter, SimulationSpec* sim)
         ModelInstancePrivate* mip = mi->private;
         AdapterModel*         am = mip->adapter_model;
         rc |= adapter->vtable->register_(am);
+        if (realtime_profile()->enabled) _prefault_adapter_model(am);
     }
     if (rc != 0) log_error("Adapter register error (%d)", rc);
 }
@@ -316,9 +378,11 @@ static void _destroy_signal_value(void* map_item, void* data)
 
     SignalValue* sv = map_item;
     if (sv) {
-        if (sv->name) free(sv->name);
+        /* The name is interned. */
         if (sv->bin) free(sv->bin);
+        memstat_add(MEMSTAT_BINARY, -(int64_t)sv->bin_buffer_size);
         // Hashmap will free sv object.
+        memstat_add(MEMSTAT_SIGNAL, -(int64_t)sizeof(SignalValue));
     }
 }
 
@@ -330,6 +394,11 @@ void adapter_destroy_adapter_model(AdapterModel* am)
             hashmap_destroy_ext(
                 &ch->signal_values, _destroy_signal_value, NULL);
             _destroy_index(ch);
+            free(ch->forward.data);
+            free(ch->forward.offset);
+            free(ch->forward.written);
+            free(ch->changed.signal);
+            sv_buffer_destroy(&ch->batch);
             if (ch->model_register_set) {
                 set_destroy(ch->model_register_set);
                 free(ch->model_register_set);
@@ -355,6 +424,9 @@ void adapter_destroy(Adapter* adapter)
 {
     if (adapter == NULL) return;
 
+    /* Drain the trace log while the SignalValue names are still valid. */
+    tracelog_close();
+    timeline_close();
     hashmap_destroy(&adapter->models);
     if (adapter->endpoint) {
         Endpoint* endpoint = adapter->endpoint;
@@ -420,3 +492,79 @@ void adapter_dump_debug(Adapter* adapter, SimulationSpec* sim)
     }
     log_simbus("========================================");
 }
+
+
+void adapter_model_dump_memory(AdapterModel* am, const char* name)
+{
+    for (uint32_t i = 0; i < am->channels_length; i++) {
+        Channel* ch = _get_channel_byindex(am, i);
+        if (ch->bin_capacity == 0) continue;
+        log_notice("  %s:%s binary: allocated=%lu, hwm=%u (bytes)", name,
+            ch->name, ch->bin_capacity, ch->bin_hwm);
+    }
+}
+
+
+/**
+ *  adapter_model_dump_stats
+ *
+ *  Print (or write to a file) the statistics of each channel, the counters
+ *  are reported per cycle (Notify).
+ *
+ *  Parameters
+ *  ----------
+ *  am : AdapterModel*
+ *      The Adapter Model.
+ *  name : const char*
+ *      Name of the Adapter Model (for the report).
+ *  file : FILE*
+ *      Write the report to this file, NULL to log the report.
+ */
+void adapter_model_dump_stats(AdapterModel* am, const char* name, FILE* file)
+{
+    char line[256];
+
+    for (uint32_t i = 0; i < am->channels_length; i++) {
+        Channel*      ch = _get_channel_byindex(am, i);
+        ChannelStats* s = &ch->stats;
+        double        n = s->cycles ? (double)s->cycles : 1.0;
+        snprintf(line, sizeof(line),
+            "  %s:%s cycles=%" PRIu64 ", per cycle: signals=%.1f, "
+            "encoded=%.0f, decoded=%.0f, binary=%.0f (bytes), "
+            "writers=%.1f (max %u), encode=%.1f, decode=%.1f (us)",
+            name, ch->name, s->cycles, s->signals_changed / n,
+            s->bytes_encoded / n, s->bytes_decoded / n, s->binary_bytes / n,
+            s->writers / n, s->writers_max, s->encode_ns / n / 1000.0,
+            s->decode_ns / n / 1000.0);
+        if (file) {
+            fprintf(file, "%s\n", line);
+        } else {
+            log_notice("%s", line);
+        }
+    }
+}
+
+
+void adapter_dump_stats(Adapter* adapter, SimulationSpec* sim)
+{
+    assert(adapter);
+
+    log_notice("Channel Statistics:");
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        ModelInstancePrivate* mip = mi->private;
+        if (mip->adapter_model == NULL) continue;
+        adapter_model_dump_stats(mip->adapter_model, mi->name, NULL);
+    }
+}
+
+
+void adapter_dump_memory(Adapter* adapter, SimulationSpec* sim)
+{
+    assert(adapter);
+
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        ModelInstancePrivate* mip = mi->private;
+        if (mip->adapter_model == NULL) continue;
+        adapter_model_dump_memory(mip->adapter_model, mi->name);
+    }
+}
@@ -6,6 +6,7 @@
 #define DSE_MODELC_ADAPTER_ADAPTER_H_
 
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <time.h>
@@ -18,6 +19,8 @@
 
 #define ADAPTER_FALLBACK_CHANNEL "test"
 #define UID_KEY_LEN              12
+#define LOOKAHEAD_ANNOTATION     "lookahead"
+#define BATCH_ANNOTATION         "batch"
 
 
 typedef struct Adapter      Adapter;
@@ -55,17 +58,54 @@ Adapter Objects
 */
 
 typedef struct SignalValue {
-    char*    name;
-    uint32_t uid;
+    /* Interned name (see intern.h), do not free. */
+    const char* name;
+    uint32_t    uid;
     /* Double. */
-    double   val;
-    double   final_val;
+    double      val;
+    double      final_val;
+    /* Change threshold (deadband), 0 = disabled. Changes are evaluated
+       against the last transmitted value (tx_val). */
+    double      deadband;
+    double      deadband_relative;
+    double      tx_val;
     /* Binary. */
-    void*    bin;
-    uint32_t bin_size;
-    uint32_t bin_buffer_size;
+    void*       bin;
+    uint32_t    bin_size;
+    uint32_t    bin_buffer_size;
+    /* Set when a value is received (Notify), cleared when the value is
+       marshalled to the Model (see signal_changed()). */
+    bool        changed;
+    /* Position in the channel index (see _generate_index()). */
+    uint32_t    index;
+    /* SimBus, writer classification. The first Model which writes the
+       signal is its writer, a write by any other Model (or configuration)
+       marks the signal as multi-writer (sticky). */
+    uint32_t    writer_uid;
+    bool        multi_writer;
 } SignalValue;
 
+/* Channel statistics (counters), see adapter_model_dump_stats(). */
+typedef struct ChannelStats {
+    uint64_t cycles;          /* Notify sent. */
+    uint64_t signals_changed; /* Signals encoded (sent). */
+    uint64_t bytes_encoded;
+    uint64_t bytes_decoded;
+    uint64_t binary_bytes;    /* Binary signal bytes encoded (sent). */
+    uint64_t writers;         /* SignalVectors (with changes) received. */
+    uint32_t writers_step;    /* Of the current cycle (SimBus). */
+    uint32_t writers_max;     /* Per cycle (SimBus). */
+    uint64_t encode_ns;
+    uint64_t decode_ns;
+} ChannelStats;
+
+/* Encoding buffer, reused (see encoding.h). */
+typedef struct SvBuffer {
+    uint8_t* data;
+    uint32_t length;
+    uint32_t size;
+} SvBuffer;
+
 typedef struct SignalMap {
     const char*  name;
     SignalValue* signal;
@@ -79,18 +119,59 @@ typedef struct Channel {
     /* Signal properties. */
     HashMap signal_values;  // map{name:SignalValue}
     struct {
-        /* Index supporting the signal_values hash. */
-        char**     names;
-        uint32_t   count;
-        uint32_t   hash_code;
+        /* Index supporting the signal_values hash. The storage is kept
+           (and reused) when the index is invalidated. */
+        const char** names; /* Interned names. */
+        uint32_t     count;
+        uint32_t     capacity;
+        uint32_t     hash_code;
+        bool         valid;
         /* Map used by _this_ channel (contains all signals). */
-        SignalMap* map;
+        SignalMap*   map;
     } index;
 
     /* Bus properties. */
     SimpleSet* model_register_set;
     SimpleSet* model_ready_set;
     uint32_t   expected_model_count;
+
+    /* Memory accounting, binary buffers. */
+    size_t   bin_capacity; /* Allocated, sum of all signals (bytes). */
+    uint32_t bin_hwm;      /* Largest binary value received (bytes). */
+
+    /* SimBus, forwarding of single-writer deltas (see handler.c). The
+       deltas (payloads) received in a cycle are held, concatenated, and
+       forwarded when valid. */
+    struct {
+        bool          valid;
+        uint32_t      encoding;
+        uint8_t*      data;
+        uint32_t      length;
+        uint32_t      size;
+        uint32_t*     offset; /* Offset of each held delta (in data). */
+        uint32_t      count;
+        uint32_t      capacity;
+        /* Signals written in this cycle. */
+        SignalValue** written;
+        uint32_t      written_count;
+        uint32_t      written_capacity;
+    } forward;
+
+    /* Model, deltas queued for a batched Notify (see adapter_msg.c). */
+    SvBuffer batch;
+
+    /* Model, signals changed (received) since the most recent marshal to the
+       Model Functions (see controller_changed_to_model()). On overflow the
+       list is incomplete and all signals are evaluated. */
+    struct {
+        SignalValue** signal;
+        uint32_t      count;
+        uint32_t      capacity;
+        bool          overflow;
+    } changed;
+
+    /* Statistics. */
+    ChannelStats stats;
 } Channel;
 
 
@@ -100,6 +181,15 @@ typedef struct AdapterModel {
     double   model_time;
     double   stop_time;
 
+    /* Lookahead, steps the model may run ahead of the bus (0 = disabled). */
+    uint32_t lookahead;
+    uint32_t lookahead_pending; /* ModelReady sent, ModelStart not received. */
+    double   lookahead_step_size;
+
+    /* Batch, steps per Notify (0 = disabled), agreed with the SimBus. */
+    uint32_t batch;
+    uint32_t batch_count; /* Steps queued (Notify not sent). */
+
     /* Channel properties. */
     HashMap  channels;  // map{name: Channel}.
     char**   channels_keys;
@@ -127,6 +217,11 @@ typedef struct Adapter {
     double        bus_step_size;
     double        bus_time_correction;
     AdapterModel* bus_adapter_model;
+    uint32_t      bus_lookahead; /* Bound on model lookahead (steps). */
+    uint32_t      bus_batch;     /* Bound on model batch factor (steps). */
+
+    /* SignalVector encoding of Notify messages (see encoding.h). */
+    uint32_t sv_encoding;
 
     /* Endpoint container. */
     Endpoint* endpoint;
@@ -140,6 +235,8 @@ typedef struct Adapter {
 DLL_PRIVATE Adapter* adapter_create(Endpoint* endpoint);
 DLL_PRIVATE Channel* adapter_init_channel(AdapterModel* am,
     const char* channel_name, const char** signal_name, uint32_t count);
+DLL_PRIVATE void     adapter_set_signal_deadband(Channel* channel,
+        const char* signal_name, double absolute, double relative);
 DLL_PRIVATE void     adapter_connect(
         Adapter* adapter, SimulationSpec* sim, int retry_count);
 DLL_PRIVATE void     adapter_register(Adapter* adapter, SimulationSpec* sim);
@@ -156,6 +253,11 @@ DLL_PRIVATE SignalMap* adapter_get_signal_map(AdapterModel* am,
     const char* channel_name, const char** signal_name, uint32_t signal_count);
 DLL_PRIVATE void adapter_dump_debug(Adapter* adapter, SimulationSpec* sim);
 DLL_PRIVATE void adapter_model_dump_debug(AdapterModel* am, const char* name);
+DLL_PRIVATE void adapter_dump_memory(Adapter* adapter, SimulationSpec* sim);
+DLL_PRIVATE void adapter_model_dump_memory(AdapterModel* am, const char* name);
+DLL_PRIVATE void adapter_dump_stats(Adapter* adapter, SimulationSpec* sim);
+DLL_PRIVATE void adapter_model_dump_stats(
+    AdapterModel* am, const char* name, FILE* file);
 
 /* adapter_msg.c */
 DLL_PUBLIC AdapterVTable* adapter_create_msg_vtable(void);
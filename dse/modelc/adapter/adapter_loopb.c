@@ -11,6 +11,8 @@
 #include <dse/clib/util/strings.h>
 #include <dse/modelc/adapter/adapter.h>
 #include <dse/modelc/adapter/private.h>
+#include <dse/modelc/adapter/intern.h>
+#include <dse/modelc/adapter/tracelog.h>
 #include <dse/modelc/adapter/simbus/simbus.h>
 #include <dse/modelc/controller/controller.h>
 #include <dse/modelc/runtime.h>
@@ -27,6 +29,32 @@ typedef enum AdapterState {
 } AdapterState;
 
 
+/* Routing tables, adapter SignalValue <-> loopback vector index. Calculated
+   when a model registers (or when the vectors/index change) so that the
+   per-step paths are array walks. */
+typedef struct LoopbSignalRoute {
+    SignalValue* sv;
+    uint32_t     vi; /* Index into the loopback vector. */
+} LoopbSignalRoute;
+
+
+typedef struct LoopbChannelRoute {
+    Channel*          ch;
+    SimbusChannel*    sc;
+    uint32_t          hash_code; /* Of the channel index. */
+    LoopbSignalRoute* signal;
+    uint32_t          count;
+} LoopbChannelRoute;
+
+
+typedef struct LoopbModelRoute {
+    AdapterModel*      am;
+    uint32_t           generation; /* Of the loopback vectors. */
+    LoopbChannelRoute* channel;
+    uint32_t           count;
+} LoopbModelRoute;
+
+
 typedef struct AdapterLoopbVTable {
     AdapterVTable vtable;
 
@@ -34,6 +62,11 @@ typedef struct AdapterLoopbVTable {
     double       step_size;
     HashMap      channels;  // map{name:SimbusChannel}
     AdapterState state;
+
+    /* Routing tables (one per model). */
+    uint32_t         generation;
+    LoopbModelRoute* routes;
+    uint32_t         route_count;
 } AdapterLoopbVTable;
 
 
@@ -59,7 +92,7 @@ static int _destroy_vector(void* _sc, void* _)
     SimbusChannel* sc = _sc;
 
     for (uint32_t i = 0; i < sc->vector.count; i++) {
-        free(sc->vector.signal[i]);
+        /* The signal name is interned. */
         free(sc->vector.binary[i]);
     }
     free(sc->vector.signal);
@@ -108,6 +141,12 @@ static int _generate_vector(void* _sc, void* _)
     /* Allocate vector storage. */
     sc->vector.signal = set_to_array(&sc->signals, &size);
     sc->vector.count = size;
+    for (uint32_t i = 0; i < sc->vector.count; i++) {
+        /* Replace the copy with the interned name. */
+        char* name = sc->vector.signal[i];
+        sc->vector.signal[i] = (char*)intern_str(name);
+        free(name);
+    }
     sc->vector.uid = calloc(size, sizeof(uint32_t));
     sc->vector.binary = calloc(size, sizeof(void*));
     sc->vector.length = calloc(size, sizeof(uint32_t));
@@ -143,6 +182,85 @@ static void _regenerate_vectors(AdapterLoopbVTable* v)
     /* Currently destructive (vectors are reallocated, content/values lost). */
     _destroy_vectors(v);
     hashmap_iterator(&v->channels, _generate_vector, false, NULL);
+    /* Routing tables are recalculated on next use. */
+    v->generation++;
+}
+
+
+/* Routing Tables
+-------------- */
+
+static void _destroy_model_route(LoopbModelRoute* mr)
+{
+    for (uint32_t i = 0; i < mr->count; i++) {
+        free(mr->channel[i].signal);
+    }
+    free(mr->channel);
+    mr->channel = NULL;
+    mr->count = 0;
+}
+
+
+static void _build_model_route(AdapterLoopbVTable* v, LoopbModelRoute* mr)
+{
+    AdapterModel* am = mr->am;
+
+    _destroy_model_route(mr);
+    mr->channel = calloc(am->channels_length, sizeof(LoopbChannelRoute));
+    mr->count = am->channels_length;
+    mr->generation = v->generation;
+    for (uint32_t ch_idx = 0; ch_idx < am->channels_length; ch_idx++) {
+        LoopbChannelRoute* cr = &mr->channel[ch_idx];
+        cr->ch = _get_channel_byindex(am, ch_idx);
+        cr->sc = _get_simbus_channel(v, cr->ch->name);
+        assert(cr->sc);
+
+        _refresh_index(cr->ch);
+        cr->hash_code = cr->ch->index.hash_code;
+        cr->signal = calloc(cr->ch->index.count, sizeof(LoopbSignalRoute));
+        for (uint32_t i = 0; i < cr->ch->index.count; i++) {
+            SignalValue* sv = cr->ch->index.map[i].signal;
+            if (sv == NULL) continue;
+            if (sv->name == NULL) continue;
+            uint32_t* sc_index = hashmap_get(&cr->sc->vector.index, sv->name);
+            if (sc_index == NULL) continue;
+            cr->signal[cr->count++] = (LoopbSignalRoute){
+                .sv = sv,
+                .vi = *sc_index,
+            };
+        }
+    }
+}
+
+
+static LoopbModelRoute* _get_model_route(
+    AdapterLoopbVTable* v, AdapterModel* am)
+{
+    LoopbModelRoute* mr = NULL;
+    for (uint32_t i = 0; i < v->route_count; i++) {
+        if (v->routes[i].am == am) {
+            mr = &v->routes[i];
+            break;
+        }
+    }
+    if (mr == NULL) {
+        v->routes =
+            realloc(v->routes, (v->route_count + 1) * sizeof(LoopbModelRoute));
+        mr = &v->routes[v->route_count++];
+        *mr = (LoopbModelRoute){ .am = am };
+        _build_model_route(v, mr);
+        return mr;
+    }
+
+    /* Recalculate if the vectors, or a channel index, have changed. */
+    bool valid = (mr->generation == v->generation) &&
+                 (mr->count == am->channels_length);
+    for (uint32_t i = 0; valid && i < mr->count; i++) {
+        LoopbChannelRoute* cr = &mr->channel[i];
+        if (cr->ch->index.hash_code != cr->hash_code) valid = false;
+    }
+    if (valid == false) _build_model_route(v, mr);
+    return mr;
 }
 
 
@@ -189,21 +307,14 @@ static int adapter_loopb_register(AdapterModel* am)
 
     simbus_register_channels(am);
 
-    for (uint32_t ch_idx = 0; ch_idx < am->channels_length; ch_idx++) {
-        Channel*       ch = _get_channel_byindex(am, ch_idx);
-        SimbusChannel* sc = _get_simbus_channel(v, ch->name);
-        assert(sc);
-        log_simbus("SignalIndex <-- [%s]", ch->name);
+    LoopbModelRoute* mr = _get_model_route(v, am);
+    for (uint32_t ch_idx = 0; ch_idx < mr->count; ch_idx++) {
+        LoopbChannelRoute* cr = &mr->channel[ch_idx];
+        log_simbus("SignalIndex <-- [%s]", cr->ch->name);
 
-        _refresh_index(ch);
-        for (uint32_t i = 0; i < ch->index.count; i++) {
-            SignalValue* sv = _get_signal_value_byindex(ch, i);
-            if (sv == NULL) continue;
-            if (sv->name == NULL) continue;
-            uint32_t* sc_index = hashmap_get(&sc->vector.index, sv->name);
-            if (sc_index == NULL) continue;
-
-            sv->uid = sc->vector.uid[*sc_index];
+        for (uint32_t i = 0; i < cr->count; i++) {
+            SignalValue* sv = cr->signal[i].sv;
+            sv->uid = cr->sc->vector.uid[cr->signal[i].vi];
             log_simbus("    SignalLookup: %s [UID=%u]", sv->name, sv->uid);
         }
     }
@@ -236,31 +347,32 @@ static int adapter_loopb_model_ready(AdapterModel* am)
     log_simbus("Notify/ModelReady --> [...]");
     log_simbus("    model_time=%f", am->model_time);
 
-    for (uint32_t ch_idx = 0; ch_idx < am->channels_length; ch_idx++) {
-        Channel*       ch = _get_channel_byindex(am, ch_idx);
-        SimbusChannel* sc = _get_simbus_channel(v, ch->name);
-        assert(sc);
-        log_simbus("SignalVector --> [%s]", ch->name);
+    bool             trace = tracelog_enabled(TRACELOG_SIGNAL);
+    LoopbModelRoute* mr = _get_model_route(v, am);
+    for (uint32_t ch_idx = 0; ch_idx < mr->count; ch_idx++) {
+        LoopbChannelRoute* cr = &mr->channel[ch_idx];
+        SimbusVector*      vector = &cr->sc->vector;
+        log_simbus("SignalVector --> [%s]", cr->ch->name);
 
-        for (uint32_t i = 0; i < ch->index.count; i++) {
-            SignalValue* sv = _get_signal_value_byindex(ch, i);
-            if (sv == NULL) continue;
-            if (sv->name == NULL) continue;
-            uint32_t* sc_index = hashmap_get(&sc->vector.index, sv->name);
-            if (sc_index == NULL) continue;
+        for (uint32_t i = 0; i < cr->count; i++) {
+            SignalValue* sv = cr->signal[i].sv;
+            uint32_t     vi = cr->signal[i].vi;
 
             if (sv->bin && sv->bin_size) {
-                dse_buffer_append(&sc->vector.binary[*sc_index],
-                    &sc->vector.length[*sc_index],
-                    &sc->vector.buffer_size[*sc_index], sv->bin, sv->bin_size);
-                log_simbus("    SignalValue: %u = <binary> (len=%u) [name=%s]",
-                    sv->uid, sv->bin_size, sv->name);
+                dse_buffer_append(&vector->binary[vi], &vector->length[vi],
+                    &vector->buffer_size[vi], sv->bin, sv->bin_size);
+                if (trace) {
+                    tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, sv->uid, 0,
+                        0, sv->bin_size, sv->name);
+                }
                 /* Indicate the binary object was consumed. */
                 sv->bin_size = 0;
             } else if (sv->val != sv->final_val) {
-                sc->vector.scalar[*sc_index] = sv->final_val;
-                log_simbus("    SignalValue: %u = %f [name=%s]", sv->uid,
-                    sv->final_val, sv->name);
+                vector->scalar[vi] = sv->final_val;
+                if (trace) {
+                    tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, sv->uid,
+                        sv->final_val, 0, 0, sv->name);
+                }
             }
         }
     }
@@ -286,30 +398,33 @@ static int adapter_loopb_model_start(AdapterModel* am)
     log_simbus("    model_time=%f", am->model_time);
     log_simbus("    stop_time=%f", am->stop_time);
 
-    for (uint32_t ch_idx = 0; ch_idx < am->channels_length; ch_idx++) {
-        Channel*       ch = _get_channel_byindex(am, ch_idx);
-        SimbusChannel* sc = _get_simbus_channel(v, ch->name);
-        assert(sc);
-        log_simbus("SignalVector <-- [%s]", ch->name);
-
-        _refresh_index(ch);
-        for (uint32_t i = 0; i < ch->index.count; i++) {
-            SignalValue* sv = _get_signal_value_byindex(ch, i);
-            if (sv == NULL) continue;
-            if (sv->name == NULL) continue;
-            uint32_t* sc_index = hashmap_get(&sc->vector.index, sv->name);
-            if (sc_index == NULL) continue;
-
-            if (sc->vector.binary[*sc_index] && sc->vector.length[*sc_index]) {
-                dse_buffer_append(&sv->bin, &sv->bin_size, &sv->bin_buffer_size,
-                    sc->vector.binary[*sc_index], sc->vector.length[*sc_index]);
-                log_simbus("    SignalValue: %u = <binary> (len=%u) [name=%s]",
-                    sv->uid, sv->bin_size, sv->name);
+    bool             trace = tracelog_enabled(TRACELOG_SIGNAL);
+    LoopbModelRoute* mr = _get_model_route(v, am);
+    for (uint32_t ch_idx = 0; ch_idx < mr->count; ch_idx++) {
+        LoopbChannelRoute* cr = &mr->channel[ch_idx];
+        SimbusVector*      vector = &cr->sc->vector;
+        log_simbus("SignalVector <-- [%s]", cr->ch->name);
+
+        for (uint32_t i = 0; i < cr->count; i++) {
+            SignalValue* sv = cr->signal[i].sv;
+            uint32_t     vi = cr->signal[i].vi;
+
+            if (vector->binary[vi] && vector->length[vi]) {
+                _signal_value_bin_append(
+                    cr->ch, sv, vector->binary[vi], vector->length[vi]);
+                _signal_value_set_changed(cr->ch, sv);
+                if (trace) {
+                    tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, sv->uid, 0,
+                        0, sv->bin_size, sv->name);
+                }
             } else {
-                if (sv->val != sc->vector.scalar[*sc_index]) {
-                    sv->val = sc->vector.scalar[*sc_index];
-                    log_simbus("    SignalValue: %u = %f [name=%s]", sv->uid,
-                        sv->val, sv->name);
+                if (sv->val != vector->scalar[vi]) {
+                    sv->val = vector->scalar[vi];
+                    _signal_value_set_changed(cr->ch, sv);
+                    if (trace) {
+                        tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, sv->uid,
+                            sv->val, 0, 0, sv->name);
+                    }
                 }
                 sv->final_val = sv->val;
             }
@@ -326,6 +441,12 @@ void adapter_loopb_destroy(Adapter* adapter)
     if (adapter->vtable == NULL) return;
 
     AdapterLoopbVTable* v = (AdapterLoopbVTable*)adapter->vtable;
+    for (uint32_t i = 0; i < v->route_count; i++) {
+        _destroy_model_route(&v->routes[i]);
+    }
+    free(v->routes);
+    v->routes = NULL;
+    v->route_count = 0;
     hashmap_destroy_ext(&v->channels, _destroy_channel, NULL);
 }
 
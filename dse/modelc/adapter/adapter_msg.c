@@ -3,21 +3,28 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <assert.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 #include <msgpack.h>
 #include <dse/logger.h>
 #include <dse/clib/util/strings.h>
 #include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/encoding.h>
 #include <dse/modelc/adapter/message.h>
 #include <dse/modelc/adapter/timer.h>
+#include <dse/modelc/adapter/timeline.h>
+#include <dse/modelc/adapter/tracelog.h>
 #include <dse/modelc/adapter/private.h>
 #include <dse/modelc/controller/model_private.h>
 #include <dse/modelc/runtime.h>
 
 
-#define UNUSED(x) ((void)x)
+#define UNUSED(x)               ((void)x)
+#define REGISTER_BACKOFF_MIN_MS 10
+#define REGISTER_BACKOFF_MAX_MS 1000
 
 
 typedef struct notify_spec_t {
@@ -25,6 +32,9 @@ typedef struct notify_spec_t {
     notify(NotifyMessage_table_t) message;
     flatcc_builder_t* builder;
     struct timespec   notifyrecv_ts;
+    /* Batch, queue the deltas (send when the batch is complete). */
+    bool              batch;
+    bool              send;
 } notify_spec_t;
 
 
@@ -36,34 +46,46 @@ static void sv_delta_to_msgpack(Channel* channel, msgpack_packer* pk)
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
-        if ((sv->val != sv->final_val) || (sv->bin && sv->bin_size)) {
+        if ((sv->bin && sv->bin_size) || _signal_value_changed(sv)) {
             changed_signal_count++;
         }
     }
+    channel->stats.signals_changed += changed_signal_count;
     /* 1st Object in root Array, list of UID's. */
     msgpack_pack_array(pk, changed_signal_count);
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
-        if ((sv->val != sv->final_val) || (sv->bin && sv->bin_size)) {
+        if ((sv->bin && sv->bin_size) || _signal_value_changed(sv)) {
             msgpack_pack_uint32(pk, sv->uid);
         }
     }
     /* 2st Object in root Array, list of Values. */
     msgpack_pack_array(pk, changed_signal_count);
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
         if (sv->bin && sv->bin_size) {
             msgpack_pack_bin_with_body(pk, sv->bin, sv->bin_size);
-            log_simbus("    SignalWrite: %u = <binary> (len=%u) [name=%s]",
-                sv->uid, sv->bin_size, sv->name);
+            channel->stats.binary_bytes += sv->bin_size;
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_WRITE_BIN, sv->uid, 0, 0,
+                    sv->bin_size, sv->name);
+            }
             /* Indicate the binary object was consumed. */
             sv->bin_size = 0;
-        } else if (sv->val != sv->final_val) {
+        } else if (_signal_value_changed(sv)) {
             msgpack_pack_double(pk, sv->final_val);
-            log_simbus("    SignalWrite: %u = %f [name=%s]", sv->uid,
-                sv->final_val, sv->name);
+            sv->tx_val = sv->final_val;
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_WRITE, sv->uid,
+                    sv->final_val, 0, 0, sv->name);
+            }
+        } else if (sv->deadband != 0.0 || sv->deadband_relative != 0.0) {
+            /* Change within the deadband, not transmitted. Keep the value
+               of the Model (it is not echoed back by the bus). */
+            sv->val = sv->final_val;
         }
     }
 }
@@ -77,6 +99,7 @@ static int notify_encode_sv(void* value, void* data)
 
     msgpack_sbuffer sbuf;
     msgpack_packer  pk;
+    uint64_t        timeline_ts = timeline_begin();
     msgpack_sbuffer_init(&sbuf);
     msgpack_packer_init(&pk, &sbuf, msgpack_sbuffer_write);
 
@@ -87,21 +110,56 @@ static int notify_encode_sv(void* value, void* data)
         _refresh_index(ch);
         log_simbus("SignalVector --> [%s:%u]", ch->name, am->model_uid);
 
-        msgpack_sbuffer_clear(&sbuf);
-        sv_delta_to_msgpack(ch, &pk);
+        uint8_t*        data = NULL;
+        size_t          length = 0;
+        struct timespec ts = get_timespec_now();
+        if (notify_data->adapter->sv_encoding == SV_ENCODING_V2) {
+            AdapterMsgVTable* v =
+                (AdapterMsgVTable*)notify_data->adapter->vtable;
+            if (sv_encode_v2(ch, &v->sv_buffer, false) == 0) {
+                data = v->sv_buffer.data;
+                length = v->sv_buffer.length;
+            }
+        } else {
+            msgpack_sbuffer_clear(&sbuf);
+            sv_delta_to_msgpack(ch, &pk);
+            data = (uint8_t*)sbuf.data;
+            length = sbuf.size;
+        }
+        if (notify_data->batch) {
+            /* Queue the delta, the batch is sent when complete. The queued
+               values are the reference for the delta of the next step (the
+               bus does not echo them until the batch is sent). */
+            sv_batch_append(&ch->batch, am->model_time, data, length);
+            ch->stats.encode_ns += get_elapsedtime_ns(ts);
+            for (uint32_t j = 0; j < ch->index.count; j++) {
+                SignalValue* sv = ch->index.map[j].signal;
+                sv->val = sv->final_val;
+            }
+            if (notify_data->send == false) continue;
+            data = ch->batch.data;
+            length = ch->batch.length;
+        }
 
         flatbuffers_string_ref_t sv_name =
             flatbuffers_string_create_str(builder, ch->name);
-        flatbuffers_uint8_vec_ref_t sv_msgpack_data =
-            flatbuffers_uint8_vec_create(
-                builder, (uint8_t*)sbuf.data, sbuf.size);
+        flatbuffers_uint8_vec_ref_t sv_data =
+            flatbuffers_uint8_vec_create(builder, data, length);
         notify(SignalVector_ref_t) sv = notify(SignalVector_create(
-            builder, sv_name, am->model_uid, sv_msgpack_data));
+            builder, sv_name, am->model_uid, sv_data));
         notify(SignalVector_vec_push(builder, sv));
-        log_simbus("    data payload: %lu bytes", sbuf.size);
+        log_simbus("    data payload: %lu bytes", length);
+        if (notify_data->batch) {
+            ch->batch.length = 0;
+        } else {
+            ch->stats.encode_ns += get_elapsedtime_ns(ts);
+        }
+        ch->stats.bytes_encoded += length;
+        ch->stats.cycles++;
     }
 
     msgpack_sbuffer_destroy(&sbuf);
+    timeline_end(TIMELINE_ENCODE, am->model_uid, am->model_time, timeline_ts);
     return 0;
 }
 
@@ -123,146 +181,263 @@ Adapter Message Functions
 -------------------------
 */
 
-static int adapter_msg_connect(
-    AdapterModel* am, SimulationSpec* sim, int retry_count)
+static int32_t _send_model_register(AdapterModel* am, Channel* ch,
+    double step_size, const char* info, PendingRequest* request)
 {
     Adapter*          adapter = am->adapter;
     AdapterMsgVTable* v = (AdapterMsgVTable*)adapter->vtable;
     flatcc_builder_t* builder = &(v->builder);
     ns(MessageType_union_ref_t) message;
 
-    for (uint32_t channel_index = 0; channel_index < am->channels_length;
-         channel_index++) {
-        Channel* ch = _get_channel_byindex(am, channel_index);
+    /* ModelRegister (without 'create') */
+    flatcc_builder_reset(builder);
+    ns(ModelRegister_start)(builder);
+    ns(ModelRegister_step_size_add)(builder, step_size);
+    message = ns(MessageType_as_ModelRegister(ns(ModelRegister_end)(builder)));
+    log_simbus("ModelRegister --> [%s]", ch->name);
+    log_simbus("    model_uid=%d", am->model_uid);
+    log_simbus("    step_size=%f", step_size);
+    if (info) log_simbus("    info=%s", info);
+
+    *request = (PendingRequest){
+        .channel_name = ch->name,
+        .model_uid = am->model_uid,
+    };
+    int32_t rc = send_message_token(adapter, ch->endpoint_channel,
+        am->model_uid, message, info, &request->token);
+    if (rc) request->token = 0; /* Not sent, retry. */
+    log_simbus("    token=%d", request->token);
+    return rc;
+}
 
-        /* ModelRegister (without 'create') */
-        flatcc_builder_reset(builder);
-        ns(ModelRegister_start)(builder);
-        ns(ModelRegister_step_size_add)(builder, sim->step_size);
-        message =
-            ns(MessageType_as_ModelRegister(ns(ModelRegister_end)(builder)));
-        int rc = 0;
-        for (int i = 0; i < retry_count; i++) {
-            log_simbus("ModelRegister --> [%s]", ch->name);
-            log_simbus("    model_uid=%d", am->model_uid);
-            log_simbus("    step_size=%f", sim->step_size);
-            rc = send_message(
-                adapter, ch->endpoint_channel, am->model_uid, message, true);
-            if (rc == 0) break;
-            if (adapter->stop_request) break;
-            log_simbus("adapter_connect: retry (rc=%d)", rc);
+
+static int adapter_msg_connect(
+    AdapterModel* am, SimulationSpec* sim, int retry_count)
+{
+    Adapter* adapter = am->adapter;
+    uint32_t count = am->channels_length;
+    if (count == 0) return 0;
+
+    /* Announce the supported SignalVector encoding, the lookahead and the
+       batch factor. */
+    char info[SV_INFO_LEN] = "";
+    if (sv_encoding_default() == SV_ENCODING_V2) {
+        snprintf(info, sizeof(info), "%s", SV_ENCODING_V2_INFO);
+    }
+    if (am->lookahead) {
+        size_t len = strlen(info);
+        snprintf(info + len, sizeof(info) - len, "%s%s=%u", len ? ";" : "",
+            SV_INFO_LOOKAHEAD, am->lookahead);
+    }
+    if (am->batch > 1) {
+        size_t len = strlen(info);
+        snprintf(info + len, sizeof(info) - len, "%s%s=%u", len ? ";" : "",
+            SV_INFO_BATCH, am->batch);
+    }
+
+    /* ModelRegister on all channels (pipelined), then wait for the ACKs. */
+    PendingRequest* request = calloc(count, sizeof(PendingRequest));
+    for (uint32_t i = 0; i < count; i++) {
+        Channel* ch = _get_channel_byindex(am, i);
+        _send_model_register(
+            am, ch, sim->step_size, info[0] ? info : NULL, &request[i]);
+    }
+    /* Each wait is bounded by the backoff interval (exponential), the
+       overall wait by retry_count transport timeouts. */
+    int32_t         rc = 0;
+    uint32_t        backoff_ms = REGISTER_BACKOFF_MIN_MS;
+    uint64_t        budget_ms = retry_count * sim->timeout * 1000;
+    struct timespec ts = get_timespec_now();
+    while (1) {
+        rc = wait_pending(adapter, request, count, backoff_ms);
+        if (rc == 0) break;
+        if (adapter->stop_request) break;
+        uint64_t elapsed_ms = get_elapsedtime_ns(ts) / 1000000;
+        if (elapsed_ms >= budget_ms) break;
+        log_simbus("adapter_connect: retry (rc=%d, backoff=%ums)", rc,
+            backoff_ms);
+
+        /* Repeat outstanding ModelRegisters, with a longer interval. */
+        backoff_ms *= 2;
+        if (backoff_ms > REGISTER_BACKOFF_MAX_MS) {
+            backoff_ms = REGISTER_BACKOFF_MAX_MS;
+        }
+        if (backoff_ms > budget_ms - elapsed_ms) {
+            backoff_ms = budget_ms - elapsed_ms;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (request[i].done) continue;
+            Channel* ch = _get_channel_byindex(am, i);
+            _send_model_register(
+                am, ch, sim->step_size, info[0] ? info : NULL, &request[i]);
         }
-        if (rc) log_error("ModelRegister on [%s] failed!", ch->name);
     }
+    /* No ACK on a channel within the budget (or stopped), not connected. */
+    bool done = true;
+    for (uint32_t i = 0; i < count; i++) {
+        if (request[i].done) continue;
+        log_error("ModelRegister on [%s] failed!", request[i].channel_name);
+        done = false;
+    }
+    if (done == false) {
+        free(request);
+        errno = (adapter->stop_request) ? ECANCELED : ETIME;
+        return -1;
+    }
+
+    /* Lookahead and batch factor, the smallest agreed (ACK response) on all
+       channels (no response, lockstep and no batch). */
+    uint32_t lookahead = am->lookahead;
+    uint32_t batch = am->batch;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t _lookahead =
+            sv_info_value(request[i].response, SV_INFO_LOOKAHEAD);
+        if (_lookahead < lookahead) lookahead = _lookahead;
+        uint32_t _batch = sv_info_value(request[i].response, SV_INFO_BATCH);
+        if (_batch < batch) batch = _batch;
+    }
+    if (am->lookahead) {
+        am->lookahead = lookahead;
+        log_notice("Lookahead: %u steps ahead (model_uid=%u)", am->lookahead,
+            am->model_uid);
+    }
+    if (am->batch > 1) {
+        am->batch = (batch > 1) ? batch : 0;
+        log_notice("Batch: %u steps per Notify (model_uid=%u)", am->batch,
+            am->model_uid);
+    }
+    free(request);
 
     return 0;
 }
 
 
-static int adapter_msg_register(AdapterModel* am)
+static void _send_signal_index(AdapterModel* am, Channel* ch)
 {
     Adapter*          adapter = am->adapter;
     AdapterMsgVTable* v = (AdapterMsgVTable*)adapter->vtable;
     flatcc_builder_t* builder = &(v->builder);
+    ns(MessageType_union_ref_t) message;
 
-    /* SignalIndex on all channels. */
-    for (uint32_t channel_index = 0; channel_index < am->channels_length;
-         channel_index++) {
-        Channel* ch = _get_channel_byindex(am, channel_index);
-        ns(MessageType_union_ref_t) message;
+    _refresh_index(ch);
+    uint32_t signal_list_length = ch->index.count;
 
-        _refresh_index(ch);
-        uint32_t signal_list_length = ch->index.count;
+    /* SignalIndex with SignalLookup */
+    log_simbus("SignalIndex --> [%s]", ch->name);
+    flatcc_builder_reset(builder);
 
-        /* SignalIndex with SignalLookup */
-        log_simbus("SignalIndex --> [%s]", ch->name);
-        flatcc_builder_reset(builder);
+    /* SignalLookups, encode into a vector */
+    ns(SignalLookup_ref_t)* signal_lookup_list =
+        calloc(signal_list_length, sizeof(ns(SignalLookup_ref_t)));
+
+    for (uint32_t i = 0; i < signal_list_length; i++) {
+        SignalValue* sv = _get_signal_value_byindex(ch, i);
+
+        flatbuffers_string_ref_t signal_name;
+        signal_name = flatbuffers_string_create_str(builder, sv->name);
+        ns(SignalLookup_start(builder));
+        ns(SignalLookup_name_add(builder, signal_name));
+        signal_lookup_list[i] = ns(SignalLookup_end(builder));
+        log_simbus("    SignalLookup: %s [UID=%u]", sv->name, sv->uid);
+    }
+    ns(SignalLookup_vec_ref_t) signal_lookup_vector;
+    ns(SignalLookup_vec_start(builder));
+    for (uint32_t i = 0; i < signal_list_length; i++)
+        ns(SignalLookup_vec_push(builder, signal_lookup_list[i]));
+    signal_lookup_vector = ns(SignalLookup_vec_end(builder));
+
+    /* Construct the final message */
+    message = ns(MessageType_as_SignalIndex(
+        ns(SignalIndex_create(builder, signal_lookup_vector))));
+    send_message(adapter, ch->endpoint_channel, am->model_uid, message, false);
+    free(signal_lookup_list);
+}
 
-        /* SignalLookups, encode into a vector */
-        ns(SignalLookup_ref_t)* signal_lookup_list =
-            calloc(signal_list_length, sizeof(ns(SignalLookup_ref_t)));
 
-        for (uint32_t i = 0; i < signal_list_length; i++) {
-            SignalValue* sv = _get_signal_value_byindex(ch, i);
+static void _send_signal_read(AdapterModel* am, Channel* ch)
+{
+    Adapter*          adapter = am->adapter;
+    AdapterMsgVTable* v = (AdapterMsgVTable*)adapter->vtable;
+    flatcc_builder_t* builder = &(v->builder);
+    ns(MessageType_union_ref_t) message;
 
-            flatbuffers_string_ref_t signal_name;
-            signal_name = flatbuffers_string_create_str(builder, sv->name);
-            ns(SignalLookup_start(builder));
-            ns(SignalLookup_name_add(builder, signal_name));
-            signal_lookup_list[i] = ns(SignalLookup_end(builder));
-            log_simbus("    SignalLookup: %s [UID=%u]", sv->name, sv->uid);
-        }
-        ns(SignalLookup_vec_ref_t) signal_lookup_vector;
-        ns(SignalLookup_vec_start(builder));
-        for (uint32_t i = 0; i < signal_list_length; i++)
-            ns(SignalLookup_vec_push(builder, signal_lookup_list[i]));
-        signal_lookup_vector = ns(SignalLookup_vec_end(builder));
-
-        /* Construct the final message */
-        message = ns(MessageType_as_SignalIndex(
-            ns(SignalIndex_create(builder, signal_lookup_vector))));
-        send_message(
-            adapter, ch->endpoint_channel, am->model_uid, message, false);
-        free(signal_lookup_list);
+    uint32_t signal_list_length = ch->index.count;
 
-        /* Wait on SignalIndex (and handle SignalValue) */
-        log_debug("adapter_register: wait on SignalIndex ...");
-        {
-            const char* msg_channel_name = NULL;
-            bool        found = false;
-            wait_message(adapter, &msg_channel_name,
-                ns(MessageType_SignalIndex), 0, &found);
-            if (!found) {
-                log_fatal("No SignalIndex received from SimBus!!!");
-            }
-            assert(msg_channel_name);
+    /* SignalRead */
+    log_simbus("SignalRead --> [%s]", ch->name);
+    flatcc_builder_reset(builder);
+
+    /* Encode the MsgPack payload: data:[ubyte] = [[SignalUID]] */
+    msgpack_sbuffer sbuf;
+    msgpack_packer  pk;
+    msgpack_sbuffer_init(&sbuf);
+    msgpack_packer_init(&pk, &sbuf, msgpack_sbuffer_write);
+    msgpack_pack_array(&pk, 1);
+    msgpack_pack_array(&pk, signal_list_length);
+    for (unsigned int i = 0; i < signal_list_length; i++) {
+        SignalValue* sv = _get_signal_value_byindex(ch, i);
+        if (sv->uid) {
+            msgpack_pack_uint32(&pk, sv->uid);
+            log_simbus("    SignalRead: %u [name=%s]", sv->uid, sv->name);
         }
+    }
+    log_simbus("    data payload: %lu bytes", sbuf.size);
 
-        /* SignalRead */
-        log_simbus("SignalRead --> [%s]", ch->name);
-        flatcc_builder_reset(builder);
+    /* Construct the final message */
+    flatbuffers_uint8_vec_ref_t data_vector;
+    data_vector =
+        flatbuffers_uint8_vec_create(builder, (uint8_t*)sbuf.data, sbuf.size);
+    message = ns(
+        MessageType_as_SignalRead(ns(SignalRead_create(builder, data_vector))));
+    send_message(adapter, ch->endpoint_channel, am->model_uid, message, false);
 
-        /* Encode the MsgPack payload: data:[ubyte] = [[SignalUID]] */
-        msgpack_sbuffer sbuf;
-        msgpack_packer  pk;
-        msgpack_sbuffer_init(&sbuf);
-        msgpack_packer_init(&pk, &sbuf, msgpack_sbuffer_write);
-        msgpack_pack_array(&pk, 1);
-        msgpack_pack_array(&pk, signal_list_length);
-        for (unsigned int i = 0; i < signal_list_length; i++) {
-            SignalValue* sv = _get_signal_value_byindex(ch, i);
-            if (sv->uid) {
-                msgpack_pack_uint32(&pk, sv->uid);
-                log_simbus("    SignalRead: %u [name=%s]", sv->uid, sv->name);
-            }
-        }
-        log_simbus("    data payload: %lu bytes", sbuf.size);
-
-        /* Construct the final message */
-        flatbuffers_uint8_vec_ref_t data_vector;
-        data_vector = flatbuffers_uint8_vec_create(
-            builder, (uint8_t*)sbuf.data, sbuf.size);
-        message = ns(MessageType_as_SignalRead(
-            ns(SignalRead_create(builder, data_vector))));
-        send_message(
-            adapter, ch->endpoint_channel, am->model_uid, message, false);
+    msgpack_sbuffer_destroy(&sbuf);
+}
 
-        /* Wait on SignalIndex (and handle SignalValue) after SignalRead */
-        log_debug("adapter_register: wait on SignalValue after SignalRead ...");
-        {
-            const char* msg_channel_name = NULL;
-            bool        found = false;
-            wait_message(adapter, &msg_channel_name,
-                ns(MessageType_SignalValue), 0, &found);
-            if (!found) {
-                log_fatal("No SignalValue received from SimBus!!!");
-            }
-            assert(msg_channel_name);
-        }
 
-        msgpack_sbuffer_destroy(&sbuf);
+static int adapter_msg_register(AdapterModel* am)
+{
+    Adapter* adapter = am->adapter;
+    uint32_t count = am->channels_length;
+    if (count == 0) return 0;
+
+    /* Requests are pipelined: send on all channels, then wait for all
+       responses (matched by channel). */
+    PendingRequest* request = calloc(count, sizeof(PendingRequest));
+
+    /* SignalIndex on all channels, wait on SignalIndex (and handle
+       SignalValue). */
+    for (uint32_t i = 0; i < count; i++) {
+        Channel* ch = _get_channel_byindex(am, i);
+        _send_signal_index(am, ch);
+        request[i] = (PendingRequest){
+            .channel_name = ch->name,
+            .model_uid = am->model_uid,
+            .message_type = ns(MessageType_SignalIndex),
+        };
+    }
+    log_debug("adapter_register: wait on SignalIndex ...");
+    if (wait_pending(adapter, request, count, 0)) {
+        log_fatal("No SignalIndex received from SimBus!!!");
+    }
+
+    /* SignalRead on all channels (the SignalIndex provided the UIDs), wait
+       on SignalValue. */
+    for (uint32_t i = 0; i < count; i++) {
+        Channel* ch = _get_channel_byindex(am, i);
+        _send_signal_read(am, ch);
+        request[i] = (PendingRequest){
+            .channel_name = ch->name,
+            .model_uid = am->model_uid,
+            .message_type = ns(MessageType_SignalValue),
+        };
+    }
+    log_debug("adapter_register: wait on SignalValue after SignalRead ...");
+    if (wait_pending(adapter, request, count, 0)) {
+        log_fatal("No SignalValue received from SimBus!!!");
     }
 
+    free(request);
     return 0;
 }
 
@@ -279,6 +454,23 @@ static int adapter_msg_model_ready(AdapterModel* am)
 
     flatcc_builder_reset(builder);
 
+    /* Batch, the deltas of each step are queued (timestamped) and sent with
+       a single Notify when the batch is complete. The first ModelStart is
+       always waited on (it provides the step size). */
+    if (am->batch > 1 && am->lookahead_step_size > 0.0) {
+        notify_data.batch = true;
+        am->batch_count++;
+        if (am->batch_count < am->batch) {
+            log_simbus("Batch: [%u]", am->model_uid);
+            log_simbus("    model_time=%f", am->model_time);
+            log_simbus("    queued=%u", am->batch_count);
+            hashmap_iterator(
+                &adapter->models, notify_encode_sv, true, &notify_data);
+            return 0;
+        }
+        notify_data.send = true;
+    }
+
     log_simbus("Notify/ModelReady --> [...]");
     log_simbus("    model_time=%f", am->model_time);
 
@@ -304,7 +496,16 @@ static int adapter_msg_model_ready(AdapterModel* am)
     notify(NotifyMessage_bench_notify_time_ns_add(builder,
         get_elapsedtime_ns(am->bench_notifyrecv_ts) - am->bench_steptime_ns));
     notify(NotifyMessage_ref_t) message = notify(NotifyMessage_end(builder));
+    uint64_t timeline_ts = timeline_begin();
     send_notify_message(adapter, message);
+    timeline_end(TIMELINE_SEND, am->model_uid, am->model_time, timeline_ts);
+    if (notify_data.batch) {
+        /* The SimBus responds to each step of the batch. */
+        am->lookahead_pending += am->batch_count;
+        am->batch_count = 0;
+    } else {
+        am->lookahead_pending++;
+    }
 
     return 0;
 }
@@ -314,19 +515,51 @@ static int adapter_msg_model_start(AdapterModel* am)
 {
     Adapter* adapter = am->adapter;
 
+    /* Lookahead, the model may step ahead of the bus (using the last received
+     * inputs) while at most lookahead+1 ModelReady are outstanding (lockstep
+     * is 1), the inputs of a step are then lookahead steps late. The first
+     * ModelStart is always waited on (it provides the step size). */
+    if (am->lookahead && am->lookahead_step_size > 0.0 &&
+        am->lookahead_pending <= am->lookahead) {
+        am->stop_time = am->model_time + am->lookahead_step_size;
+        log_simbus("Lookahead: [%u]", am->model_uid);
+        log_simbus("    model_time=%f", am->model_time);
+        log_simbus("    stop_time=%f", am->stop_time);
+        log_simbus("    pending=%u", am->lookahead_pending);
+        return 0;
+    }
+
+    /* Batch, the model steps (using the last received inputs) until the
+     * batch is complete. */
+    if (am->batch > 1 && am->batch_count) {
+        am->stop_time = am->model_time + am->lookahead_step_size;
+        log_simbus("Batch: [%u]", am->model_uid);
+        log_simbus("    model_time=%f", am->model_time);
+        log_simbus("    stop_time=%f", am->stop_time);
+        return 0;
+    }
+
     /* Wait on Notify. Notify will contain all channel/signal values.
-     * Indicated by parameters channel_name and message_type being NULL/0. */
+     * Indicated by parameters channel_name and message_type being NULL/0.
+     * After a batch, the SimBus sends a Notify for each step of the batch,
+     * the deltas are applied in order. */
     log_debug("adapter_ready: wait on Notify ...");
-    bool found = false;
-    int  rc = 0;
+    bool     found = false;
+    int      rc = 0;
+    uint64_t timeline_ts = timeline_begin();
 
-    rc = wait_message(adapter, NULL, 0, 0, &found);
-    if (rc != 0) {
-        log_error("wait_message returned %d", rc);
+    do {
+        rc = wait_message(adapter, NULL, 0, 0, &found);
+        if (rc != 0) {
+            log_error("wait_message returned %d", rc);
 
-        /* Handle specific error conditions. */
-        if (rc == ETIME) return rc; /* TIMEOUT */
-    }
+            /* Handle specific error conditions. */
+            if (rc == ETIME) return rc; /* TIMEOUT */
+            break;
+        }
+    } while (am->batch > 1 && am->lookahead_pending > am->lookahead &&
+             adapter->stop_request == false);
+    timeline_end(TIMELINE_WAIT, am->model_uid, am->model_time, timeline_ts);
 
     if (0) {
         /* Wait on ModelStart from all channels (and handle SignalValue,
@@ -448,6 +681,7 @@ static void process_signal_value_data(
     }
 
     /* Update the SignalValue for each included Signal UID:Value pair. */
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
     for (uint32_t i = 0; i < uid_obj.via.array.size; i++) {
         uint32_t    _uid = uid_obj.via.array.ptr[i].via.u64;
         double      _value = 0;
@@ -481,17 +715,23 @@ static void process_signal_value_data(
         }
         if (_bin_size) {
             /* Binary. */
-            dse_buffer_append(&sv->bin, &sv->bin_size, &sv->bin_buffer_size,
-                _bin_ptr, _bin_size);
-            log_simbus("    SignalValue: %u = <binary> (len=%u) [name=%s]",
-                _uid, sv->bin_size, sv->name);
+            _signal_value_bin_append(channel, sv, _bin_ptr, _bin_size);
+            _signal_value_set_changed(channel, sv);
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, _uid, 0, 0,
+                    sv->bin_size, sv->name);
+            }
         } else {
             /* Double. */
             sv->val = _value;
             sv->final_val =
                 _value; /* Reset final_val (changes will trigger SignalWrite) */
-            log_simbus(
-                "    SignalValue: %u = %f [name=%s]", _uid, sv->val, sv->name);
+            sv->tx_val = _value;
+            _signal_value_set_changed(channel, sv);
+            if (trace) {
+                tracelog_signal(
+                    TRACELOG_FMT_SIGNAL_VALUE, _uid, sv->val, 0, 0, sv->name);
+            }
         }
     }
 
@@ -635,8 +875,19 @@ static int notify_model(void* value, void* data)
     am->bench_notifyrecv_ts = notify_data->notifyrecv_ts;
     notify(NotifyMessage_table_t) message = notify_data->message;
     log_simbus("Notify/ModelStart <-- [%u]", am->model_uid);
-    am->model_time = notify(NotifyMessage_model_time(message));
-    am->stop_time = notify(NotifyMessage_schedule_time(message));
+    double model_time = notify(NotifyMessage_model_time(message));
+    double stop_time = notify(NotifyMessage_schedule_time(message));
+    if (am->lookahead_pending) am->lookahead_pending--;
+    if (am->lookahead || am->batch > 1) {
+        /* The model may be ahead of the bus, keep the local model time. */
+        am->lookahead_step_size = stop_time - model_time;
+        if (am->model_time > model_time) {
+            model_time = am->model_time;
+            stop_time = model_time + am->lookahead_step_size;
+        }
+    }
+    am->model_time = model_time;
+    am->stop_time = stop_time;
     if (am->stop_time <= am->model_time) {
         log_error("WARNING:stop_time is NOT greater than model_time!");
     }
@@ -645,6 +896,7 @@ static int notify_model(void* value, void* data)
     log_simbus("    stop_time=%f", am->stop_time);
 
     /* Handle embedded SignalVector tables. */
+    uint64_t timeline_ts = timeline_begin();
     notify(SignalVector_vec_t) vector = notify(NotifyMessage_signals(message));
     size_t vector_len = notify(SignalVector_vec_len(vector));
     for (uint32_t _vi = 0; _vi < vector_len; _vi++) {
@@ -670,8 +922,23 @@ static int notify_model(void* value, void* data)
         Channel* channel = hashmap_get(&am->channels, channel_name);
         if (channel == NULL) continue;
         log_simbus("SignalVector <-- [%s]", channel->name);
-        process_signal_value_data(channel, data_vector, data_length);
+        struct timespec ts = get_timespec_now();
+        if (sv_encoding_is_v2(data_vector, data_length)) {
+            sv_decode_v2(channel, data_vector, data_length, false);
+            /* The SimBus selected V2, reply with V2 (unless forced V1). */
+            Adapter* adapter = notify_data->adapter;
+            if (adapter->sv_encoding != SV_ENCODING_V2 &&
+                sv_encoding_default() == SV_ENCODING_V2) {
+                log_simbus("    sv_encoding=%u", SV_ENCODING_V2);
+                adapter->sv_encoding = SV_ENCODING_V2;
+            }
+        } else {
+            process_signal_value_data(channel, data_vector, data_length);
+        }
+        channel->stats.decode_ns += get_elapsedtime_ns(ts);
+        channel->stats.bytes_decoded += data_length;
     }
+    timeline_end(TIMELINE_DECODE, am->model_uid, am->model_time, timeline_ts);
 
     return 0;
 }
@@ -703,6 +970,19 @@ void adapter_msg_destroy(Adapter* adapter)
     flatcc_builder_clear(&v->builder);
     free(v->ep_buffer);
     v->ep_buffer = NULL;
+    sv_buffer_destroy(&v->sv_buffer);
+}
+
+
+/* Builder allocator, the default allocator with memory accounting. */
+static int _flatcc_builder_alloc(void* alloc_context, flatcc_iovec_t* b,
+    size_t request, int zero_fill, int alloc_type)
+{
+    size_t len = b->iov_len;
+    int    rc = flatcc_builder_default_alloc(
+        alloc_context, b, request, zero_fill, alloc_type);
+    memstat_add(MEMSTAT_FLATCC, (int64_t)b->iov_len - (int64_t)len);
+    return rc;
 }
 
 
@@ -721,7 +1001,8 @@ AdapterVTable* adapter_create_msg_vtable(void)
     v->handle_message = handle_channel_message;
     v->handle_notify_message = handle_notify_message;
     /* Supporting data objects. */
-    flatcc_builder_init(&v->builder);
+    flatcc_builder_custom_init(
+        &v->builder, NULL, NULL, _flatcc_builder_alloc, NULL);
     v->builder.buffer_flags |= flatcc_builder_with_size;
 
     return (AdapterVTable*)v;
@@ -0,0 +1,513 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/encoding.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/adapter/private.h>
+#include <dse/modelc/adapter/tracelog.h>
+
+
+#define ALIGN_8(x) (((x) + 7) & ~((size_t)7))
+
+
+typedef struct SvV2Layout {
+    size_t scalar_uid;
+    size_t scalar;
+    size_t binary_uid;
+    size_t binary_len;
+    size_t binary_data;
+    size_t length;
+} SvV2Layout;
+
+
+static SvV2Layout _layout(const SvV2Header* h)
+{
+    SvV2Layout l;
+    l.scalar_uid = sizeof(SvV2Header);
+    l.scalar = ALIGN_8(l.scalar_uid + h->scalar_count * sizeof(uint32_t));
+    l.binary_uid = l.scalar + h->scalar_count * sizeof(double);
+    l.binary_len = l.binary_uid + h->binary_count * sizeof(uint32_t);
+    l.binary_data = l.binary_len + h->binary_count * sizeof(uint32_t);
+    l.length = l.binary_data + h->binary_size;
+    return l;
+}
+
+
+/**
+ *  sv_encoding_default
+ *
+ *  Returns
+ *  -------
+ *      uint32_t : The highest SignalVector encoding supported by this process
+ *          (SV_ENCODING_V1 if forced with SIMBUS_SV_ENCODING=1).
+ */
+uint32_t sv_encoding_default(void)
+{
+    const char* env = getenv(ENV_SIMBUS_SV_ENCODING);
+    if (env && atoi(env) == SV_ENCODING_V1) return SV_ENCODING_V1;
+    return SV_ENCODING_V2;
+}
+
+
+bool sv_encoding_is_v2(const uint8_t* data, size_t length)
+{
+    if (data == NULL || length < sizeof(SvV2Header)) return false;
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    return (magic == SV_ENCODING_V2_MAGIC);
+}
+
+
+/**
+ *  sv_info_value
+ *
+ *  Get the value of an item of a ModelRegister info string
+ *  ("key=value;key=value").
+ *
+ *  Parameters
+ *  ----------
+ *  info : const char*
+ *      The info string (may be NULL).
+ *  key : const char*
+ *      The item key.
+ *
+ *  Returns
+ *  -------
+ *      uint32_t : The item value, 0 if the item is not present.
+ */
+uint32_t sv_info_value(const char* info, const char* key)
+{
+    if (info == NULL || key == NULL) return 0;
+    size_t      len = strlen(key);
+    const char* p = info;
+    while (p && *p) {
+        if (strncmp(p, key, len) == 0 && p[len] == '=') {
+            return strtoul(p + len + 1, NULL, 10);
+        }
+        p = strchr(p, ';');
+        if (p) p++;
+    }
+    return 0;
+}
+
+
+bool sv_encoding_is_batch(const uint8_t* data, size_t length)
+{
+    if (data == NULL || length < sizeof(SvBatchHeader)) return false;
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    return (magic == SV_BATCH_MAGIC);
+}
+
+
+/**
+ *  sv_batch_append
+ *
+ *  Append a (timestamped) delta to a batch. An empty batch buffer (length 0)
+ *  is initialised.
+ *
+ *  Parameters
+ *  ----------
+ *  batch : SvBuffer*
+ *      The batch, resized as required (release with sv_buffer_destroy()).
+ *  model_time : double
+ *      The model time of the delta (end of the step).
+ *  data : const uint8_t*
+ *      The delta (V1 or V2 encoded).
+ *  length : uint32_t
+ *      Length of the delta.
+ *
+ *  Returns
+ *  -------
+ *      0 : The delta was appended.
+ *      -1 : The buffer could not be allocated (errno is set).
+ */
+int sv_batch_append(SvBuffer* batch, double model_time, const uint8_t* data,
+    uint32_t length)
+{
+    size_t offset = batch->length ? batch->length : sizeof(SvBatchHeader);
+    size_t required = ALIGN_8(offset + sizeof(SvBatchEntry) + length);
+    if (batch->size < required) {
+        size_t size = batch->size ? batch->size : 1024;
+        while (size < required) size *= 2;
+        void* p = memstat_realloc(MEMSTAT_FLATCC, batch->data, size);
+        if (p == NULL) {
+            if (errno == 0) errno = ENOMEM;
+            log_error("SignalVector batch realloc failed!");
+            return -1;
+        }
+        batch->data = p;
+        batch->size = size;
+    }
+
+    SvBatchHeader h = { .magic = SV_BATCH_MAGIC };
+    if (batch->length) memcpy(&h, batch->data, sizeof(h));
+    h.count++;
+    memcpy(batch->data, &h, sizeof(h));
+
+    SvBatchEntry e = { .model_time = model_time, .length = length };
+    memcpy(batch->data + offset, &e, sizeof(e));
+    if (length) memcpy(batch->data + offset + sizeof(e), data, length);
+    memset(batch->data + offset + sizeof(e) + length, 0,
+        required - (offset + sizeof(e) + length));
+    batch->length = required;
+
+    return 0;
+}
+
+
+/**
+ *  sv_batch_next
+ *
+ *  Iterate the deltas of a batch.
+ *
+ *  Parameters
+ *  ----------
+ *  data : const uint8_t*
+ *      The batch (data:[ubyte] of the SignalVector table).
+ *  length : size_t
+ *      Length of the batch.
+ *  offset : size_t*
+ *      Iterator position, set to 0 for the first delta.
+ *  model_time : double*
+ *      (out) The model time of the delta.
+ *  delta : const uint8_t**
+ *      (out) The delta (in place).
+ *  delta_length : uint32_t*
+ *      (out) Length of the delta.
+ *
+ *  Returns
+ *  -------
+ *      1 : A delta was returned.
+ *      0 : No more deltas.
+ *      -1 : The batch is malformed (errno = EBADMSG).
+ */
+int sv_batch_next(const uint8_t* data, size_t length, size_t* offset,
+    double* model_time, const uint8_t** delta, uint32_t* delta_length)
+{
+    if (!sv_encoding_is_batch(data, length)) goto error_bad_msg;
+    if (*offset == 0) *offset = sizeof(SvBatchHeader);
+    if (*offset >= length) return 0;
+    if (*offset + sizeof(SvBatchEntry) > length) goto error_bad_msg;
+
+    SvBatchEntry e;
+    memcpy(&e, data + *offset, sizeof(e));
+    size_t end = *offset + sizeof(e) + e.length;
+    if (end > length) goto error_bad_msg;
+    *model_time = e.model_time;
+    *delta = data + *offset + sizeof(e);
+    *delta_length = e.length;
+    *offset = ALIGN_8(end);
+    return 1;
+
+error_bad_msg:
+    log_simbus("WARNING: malformed SignalVector (batch)!");
+    errno = EBADMSG;
+    return -1;
+}
+
+
+/**
+ *  sv_encode_v2
+ *
+ *  Encode the changed signals (delta) of a Channel with the V2 encoding. The
+ *  side effects on the signals (transmitted value, consumed binary objects)
+ *  are the same as for the V1 (MsgPack) encoders.
+ *
+ *  Parameters
+ *  ----------
+ *  channel : Channel*
+ *      The Channel, its index must be current (see _refresh_index()).
+ *  buffer : SvBuffer*
+ *      Buffer for the encoded data, resized as required (reused by the
+ *      caller, release with sv_buffer_destroy()).
+ *  bus_mode : bool
+ *      Encoding for a SimBus (Notify to Models), otherwise for a Model.
+ *
+ *  Returns
+ *  -------
+ *      0 : The signals were encoded, buffer->length is the encoded length.
+ *      -1 : The buffer could not be allocated (errno is set).
+ */
+int sv_encode_v2(Channel* channel, SvBuffer* buffer, bool bus_mode)
+{
+    SvV2Header h = { .magic = SV_ENCODING_V2_MAGIC };
+
+    /* Count the changed signals. */
+    for (uint32_t i = 0; i < channel->index.count; i++) {
+        SignalValue* sv = channel->index.map[i].signal;
+        if (sv->uid == 0) continue;
+        if (sv->bin && sv->bin_size) {
+            h.binary_count++;
+            h.binary_size += sv->bin_size;
+        } else if (_signal_value_changed(sv)) {
+            h.scalar_count++;
+        }
+    }
+
+    /* Size the buffer. */
+    SvV2Layout l = _layout(&h);
+    if (buffer->size < l.length) {
+        void* p = memstat_realloc(MEMSTAT_FLATCC, buffer->data, l.length);
+        if (p == NULL) {
+            if (errno == 0) errno = ENOMEM;
+            log_error("SignalVector buffer realloc failed!");
+            return -1;
+        }
+        buffer->data = p;
+        buffer->size = l.length;
+    }
+    memset(buffer->data, 0, l.scalar); /* Header and padding. */
+    memcpy(buffer->data, &h, sizeof(h));
+    buffer->length = l.length;
+    channel->stats.signals_changed += h.scalar_count + h.binary_count;
+    channel->stats.binary_bytes += h.binary_size;
+
+    /* Encode the changed signals. */
+    uint8_t* b = buffer->data;
+    uint32_t si = 0;
+    uint32_t bi = 0;
+    size_t   bin_offset = l.binary_data;
+    bool     trace = tracelog_enabled(TRACELOG_SIGNAL);
+    for (uint32_t i = 0; i < channel->index.count; i++) {
+        SignalValue* sv = channel->index.map[i].signal;
+        if (sv->uid == 0) continue;
+        if (sv->bin && sv->bin_size) {
+            memcpy(b + l.binary_uid + bi * sizeof(uint32_t), &sv->uid,
+                sizeof(uint32_t));
+            memcpy(b + l.binary_len + bi * sizeof(uint32_t), &sv->bin_size,
+                sizeof(uint32_t));
+            memcpy(b + bin_offset, sv->bin, sv->bin_size);
+            bin_offset += sv->bin_size;
+            bi++;
+            if (trace) {
+                tracelog_signal(bus_mode ? TRACELOG_FMT_SIGNAL_VALUE_BIN
+                                         : TRACELOG_FMT_SIGNAL_WRITE_BIN,
+                    sv->uid, 0, 0, sv->bin_size, sv->name);
+            }
+            /* Indicate the binary object was consumed (Model). */
+            if (!bus_mode) sv->bin_size = 0;
+        } else if (_signal_value_changed(sv)) {
+            memcpy(b + l.scalar_uid + si * sizeof(uint32_t), &sv->uid,
+                sizeof(uint32_t));
+            memcpy(b + l.scalar + si * sizeof(double), &sv->final_val,
+                sizeof(double));
+            si++;
+            sv->tx_val = sv->final_val;
+            if (trace) {
+                tracelog_signal(bus_mode ? TRACELOG_FMT_SIGNAL_VALUE
+                                         : TRACELOG_FMT_SIGNAL_WRITE,
+                    sv->uid, sv->final_val, 0, 0, sv->name);
+            }
+        } else if (!bus_mode &&
+                   (sv->deadband != 0.0 || sv->deadband_relative != 0.0)) {
+            /* Change within the deadband, not transmitted. Keep the value
+               of the Model (it is not echoed back by the bus). */
+            sv->val = sv->final_val;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ *  sv_decode_v2
+ *
+ *  Decode a V2 encoded SignalVector and update the signals of a Channel. The
+ *  arrays are read in place.
+ *
+ *  Parameters
+ *  ----------
+ *  channel : Channel*
+ *      The Channel.
+ *  data : const uint8_t*
+ *      The encoded data (data:[ubyte] of the SignalVector table).
+ *  length : size_t
+ *      Length of the encoded data.
+ *  bus_mode : bool
+ *      Decoding for a SimBus (values written by a Model), otherwise for a
+ *      Model (values from the SimBus).
+ *
+ *  Returns
+ *  -------
+ *      0 : The signals were updated.
+ *      -1 : The encoded data is malformed (errno = EBADMSG).
+ */
+int sv_decode_v2(
+    Channel* channel, const uint8_t* data, size_t length, bool bus_mode)
+{
+    _refresh_index(channel);
+
+    SvV2Header h;
+    if (!sv_encoding_is_v2(data, length)) goto error_bad_msg;
+    memcpy(&h, data, sizeof(h));
+    SvV2Layout l = _layout(&h);
+    if (l.length > length) goto error_bad_msg;
+
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
+
+    /* Scalar signals. */
+    for (uint32_t i = 0; i < h.scalar_count; i++) {
+        uint32_t uid;
+        double   value;
+        memcpy(&uid, data + l.scalar_uid + i * sizeof(uint32_t), sizeof(uid));
+        memcpy(&value, data + l.scalar + i * sizeof(double), sizeof(value));
+        SignalValue* sv = _find_signal_by_uid(channel, uid);
+        if (sv == NULL) {
+            log_simbus("WARNING: signal with uid (%u) not found!", uid);
+            continue;
+        }
+        if (bus_mode) {
+            sv->final_val = value;
+            _signal_value_written(channel, sv);
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_WRITE_PREV, uid,
+                    sv->final_val, sv->val, 0, sv->name);
+            }
+        } else {
+            sv->val = value;
+            sv->final_val = value;
+            sv->tx_val = value;
+            _signal_value_set_changed(channel, sv);
+            if (trace) {
+                tracelog_signal(
+                    TRACELOG_FMT_SIGNAL_VALUE, uid, sv->val, 0, 0, sv->name);
+            }
+        }
+    }
+
+    /* Binary signals. */
+    size_t bin_offset = l.binary_data;
+    for (uint32_t i = 0; i < h.binary_count; i++) {
+        uint32_t uid;
+        uint32_t len;
+        memcpy(&uid, data + l.binary_uid + i * sizeof(uint32_t), sizeof(uid));
+        memcpy(&len, data + l.binary_len + i * sizeof(uint32_t), sizeof(len));
+        if (bin_offset + len > l.length) goto error_bad_msg;
+        const uint8_t* bin = data + bin_offset;
+        bin_offset += len;
+        SignalValue* sv = _find_signal_by_uid(channel, uid);
+        if (sv == NULL) {
+            log_simbus("WARNING: signal with uid (%u) not found!", uid);
+            continue;
+        }
+        if (len == 0) continue;
+        _signal_value_bin_append(channel, sv, bin, len);
+        if (bus_mode) _signal_value_written(channel, sv);
+        if (!bus_mode) _signal_value_set_changed(channel, sv);
+        if (trace) {
+            tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, uid, 0, 0,
+                sv->bin_size, sv->name);
+        }
+    }
+
+    return 0;
+
+error_bad_msg:
+    log_simbus("WARNING: malformed SignalVector (V2 encoding)!");
+    errno = EBADMSG;
+    return -1;
+}
+
+
+/**
+ *  sv_merge_v2
+ *
+ *  Merge V2 encoded SignalVectors (scalar signals only) into a single V2
+ *  encoded SignalVector. The UID and value arrays are concatenated, in order,
+ *  the values are not decoded.
+ *
+ *  Parameters
+ *  ----------
+ *  buffer : SvBuffer*
+ *      Buffer for the merged data, resized as required.
+ *  data : const uint8_t*
+ *      The encoded SignalVectors, concatenated.
+ *  offset : const uint32_t*
+ *      Offset of each encoded SignalVector (in data).
+ *  count : uint32_t
+ *      Number of encoded SignalVectors.
+ *  length : uint32_t
+ *      Length of data.
+ *
+ *  Returns
+ *  -------
+ *      0 : The SignalVectors were merged, buffer->length is the merged
+ *          length.
+ *      -1 : An encoded SignalVector is malformed or contains binary signals
+ *          (errno = EBADMSG), or the buffer could not be allocated.
+ */
+int sv_merge_v2(SvBuffer* buffer, const uint8_t* data, const uint32_t* offset,
+    uint32_t count, uint32_t length)
+{
+    SvV2Header h = { .magic = SV_ENCODING_V2_MAGIC };
+
+    /* Validate and count the scalar signals. */
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t   end = (i + 1 < count) ? offset[i + 1] : length;
+        SvV2Header ph;
+        if (!sv_encoding_is_v2(data + offset[i], end - offset[i])) {
+            goto error_bad_msg;
+        }
+        memcpy(&ph, data + offset[i], sizeof(ph));
+        if (ph.binary_count || _layout(&ph).length > end - offset[i]) {
+            goto error_bad_msg;
+        }
+        h.scalar_count += ph.scalar_count;
+    }
+
+    /* Size the buffer. */
+    SvV2Layout l = _layout(&h);
+    if (buffer->size < l.length) {
+        void* p = memstat_realloc(MEMSTAT_FLATCC, buffer->data, l.length);
+        if (p == NULL) {
+            if (errno == 0) errno = ENOMEM;
+            log_error("SignalVector buffer realloc failed!");
+            return -1;
+        }
+        buffer->data = p;
+        buffer->size = l.length;
+    }
+    memset(buffer->data, 0, l.scalar); /* Header and padding. */
+    memcpy(buffer->data, &h, sizeof(h));
+    buffer->length = l.length;
+
+    /* Concatenate the arrays. */
+    uint32_t si = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* p = data + offset[i];
+        SvV2Header     ph;
+        memcpy(&ph, p, sizeof(ph));
+        SvV2Layout pl = _layout(&ph);
+        memcpy(buffer->data + l.scalar_uid + si * sizeof(uint32_t),
+            p + pl.scalar_uid, ph.scalar_count * sizeof(uint32_t));
+        memcpy(buffer->data + l.scalar + si * sizeof(double), p + pl.scalar,
+            ph.scalar_count * sizeof(double));
+        si += ph.scalar_count;
+    }
+
+    return 0;
+
+error_bad_msg:
+    log_simbus("WARNING: malformed SignalVector (V2 encoding, merge)!");
+    errno = EBADMSG;
+    return -1;
+}
+
+
+void sv_buffer_destroy(SvBuffer* buffer)
+{
+    if (buffer == NULL) return;
+    memstat_free(MEMSTAT_FLATCC, buffer->data);
+    buffer->data = NULL;
+    buffer->length = buffer->size = 0;
+}
@@ -0,0 +1,118 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_ENCODING_H_
+#define DSE_MODELC_ADAPTER_ENCODING_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/modelc/adapter/adapter.h>
+#include <dse/platform.h>
+
+
+#define ENV_SIMBUS_SV_ENCODING "SIMBUS_SV_ENCODING"
+#define SV_ENCODING_V1         1 /* MsgPack [[UID:0..N],[Value:0..N]] */
+#define SV_ENCODING_V2         2 /* Native arrays, see below. */
+#define SV_ENCODING_V2_MAGIC   0x32565344 /* "DSV2" (little endian) */
+/* Announced by a Model (ChannelMessage response of ModelRegister). */
+#define SV_ENCODING_V2_INFO    "sv_encoding=2"
+#define SV_BATCH_MAGIC         0x42565344 /* "DSVB" (little endian) */
+
+/* ModelRegister info (and ACK response), "key=value" items separated by
+   ';'. The SimBus responds with the agreed lookahead and batch factor. */
+#define SV_INFO_ENCODING       "sv_encoding"
+#define SV_INFO_LOOKAHEAD      "lookahead"
+#define SV_INFO_BATCH          "batch"
+#define SV_INFO_LEN            64
+
+
+/*
+SignalVector Encoding
+---------------------
+
+The data:[ubyte] vector of a Notify SignalVector table is encoded with either
+the V1 encoding (MsgPack, [[UID:0..N],[Value:0..N]]) or the V2 encoding which
+carries the UIDs and values as native (host byte order) arrays:
+
+    offset  content
+    ------  -------
+    0       SvV2Header
+    16      scalar_uid[scalar_count]  uint32
+    (pad)   aligned to 8
+    ...     scalar[scalar_count]      double
+    ...     binary_uid[binary_count]  uint32
+    ...     binary_len[binary_count]  uint32
+    ...     binary data (binary_size bytes, concatenated)
+
+The V2 encoding is self describing (a V1 payload always starts with the
+MsgPack fixarray marker 0x92) and decoders accept both encodings. A decoder
+iterates the arrays in place, there is no allocation and no per value type
+dispatch.
+
+The encoding is negotiated at ModelRegister: a Model announces V2 support
+(SV_ENCODING_V2_INFO) and the SimBus selects V2 for its Notify messages only
+when all Models announced support. A Model selects V2 for its Notify messages
+after it receives a V2 encoded Notify from the SimBus. Setting the environment
+variable SIMBUS_SV_ENCODING=1 forces the V1 encoding.
+*/
+typedef struct SvV2Header {
+    uint32_t magic;
+    uint32_t scalar_count;
+    uint32_t binary_count;
+    uint32_t binary_size;
+} SvV2Header;
+
+
+/*
+Batch Encoding
+--------------
+
+A Model with a batch factor N (negotiated at ModelRegister, see
+SV_INFO_BATCH) runs N steps per Notify. The deltas of each step are queued,
+timestamped, in the data:[ubyte] vector of a single SignalVector table:
+
+    offset  content
+    ------  -------
+    0       SvBatchHeader
+    8       SvBatchEntry, followed by the delta (V1 or V2 encoded)
+    (pad)   aligned to 8
+    ...     (repeated, SvBatchHeader.count entries)
+
+The SimBus applies each delta at its model_time (the end of the step which
+produced the delta).
+*/
+typedef struct SvBatchHeader {
+    uint32_t magic;
+    uint32_t count;
+} SvBatchHeader;
+
+typedef struct SvBatchEntry {
+    double   model_time;
+    uint32_t length;
+    uint32_t reserved;
+} SvBatchEntry;
+
+
+/* encoding.c */
+DLL_PRIVATE uint32_t sv_encoding_default(void);
+DLL_PRIVATE bool     sv_encoding_is_v2(const uint8_t* data, size_t length);
+DLL_PRIVATE int      sv_encode_v2(
+         Channel* channel, SvBuffer* buffer, bool bus_mode);
+DLL_PRIVATE int sv_decode_v2(
+    Channel* channel, const uint8_t* data, size_t length, bool bus_mode);
+DLL_PRIVATE uint32_t sv_info_value(const char* info, const char* key);
+DLL_PRIVATE bool     sv_encoding_is_batch(const uint8_t* data, size_t length);
+DLL_PRIVATE int      sv_batch_append(SvBuffer* batch, double model_time,
+         const uint8_t* data, uint32_t length);
+DLL_PRIVATE int sv_batch_next(const uint8_t* data, size_t length,
+    size_t* offset, double* model_time, const uint8_t** delta,
+    uint32_t* delta_length);
+DLL_PRIVATE int sv_merge_v2(SvBuffer* buffer, const uint8_t* data,
+    const uint32_t* offset, uint32_t count, uint32_t length);
+DLL_PRIVATE void sv_buffer_destroy(SvBuffer* buffer);
+
+
+#endif  // DSE_MODELC_ADAPTER_ENCODING_H_
@@ -9,6 +9,7 @@
 #include <dse/logger.h>
 #include <dse/modelc/adapter/adapter.h>
 #include <dse/modelc/adapter/private.h>
+#include <dse/modelc/adapter/intern.h>
 
 
 /*
@@ -18,38 +19,61 @@ Index related internal API
 
 void _destroy_index(Channel* channel)
 {
-    if (channel->index.names) {
-        for (uint32_t _ = 0; _ < channel->index.count; _++)
-            free(channel->index.names[_]);
-        free(channel->index.names);
-        channel->index.names = NULL;
-        channel->index.count = 0;
-    }
-    if (channel->index.map) {
-        free(channel->index.map);
-        channel->index.map = NULL;
-    }
+    free(channel->index.names);
+    free(channel->index.map);
+    channel->index.names = NULL;
+    channel->index.map = NULL;
+    channel->index.count = 0;
+    channel->index.capacity = 0;
+    channel->index.valid = false;
 }
 
-void _generate_index(Channel* channel)
+static int _index_signal_value(void* _sv, void* _channel)
 {
-    _destroy_index(channel);
+    SignalValue* sv = _sv;
+    Channel*     channel = _channel;
+    uint32_t     i = channel->index.count++;
+
+    channel->index.names[i] = sv->name;
+    channel->index.map[i] = (SignalMap){ .name = sv->name, .signal = sv };
+    sv->index = i;
+    return 0;
+}
 
-    channel->index.names = hashmap_keys(&channel->signal_values);
-    channel->index.count = hashmap_number_keys(channel->signal_values);
-    channel->index.map = _get_signal_value_map(
-        channel, (const char**)channel->index.names, channel->index.count);
+void _generate_index(Channel* channel)
+{
+    /* Names are interned (no copy), the storage is only reallocated when the
+       number of signals exceeds the capacity of the index. */
+    uint32_t count = hashmap_number_keys(channel->signal_values);
+    if (count > channel->index.capacity) {
+        uint32_t capacity = channel->index.capacity;
+        if (capacity == 0) capacity = 8;
+        while (capacity < count)
+            capacity *= 2;
+        channel->index.names =
+            realloc(channel->index.names, capacity * sizeof(const char*));
+        channel->index.map =
+            realloc(channel->index.map, capacity * sizeof(SignalMap));
+        assert(channel->index.names);
+        assert(channel->index.map);
+        channel->index.capacity = capacity;
+    }
+    channel->index.count = 0;
+    hashmap_iterator(
+        &channel->signal_values, _index_signal_value, false, channel);
+    channel->index.valid = true;
 }
 
 void _invalidate_index(Channel* channel)
 {
     channel->index.hash_code++;  // Signal consumers of index change.
-    _destroy_index(channel);
+    channel->index.count = 0;
+    channel->index.valid = false;
 }
 
 void _refresh_index(Channel* channel)
 {
-    if (channel->index.names == NULL) _generate_index(channel);
+    if (channel->index.valid == false) _generate_index(channel);
 }
 
 
@@ -104,7 +128,8 @@ SignalValue* _get_signal_value(Channel* channel, const char* signal_name)
 
     /* Add a new SignalValue, assume dynamically provided name. */
     sv = calloc(1, sizeof(SignalValue));
-    sv->name = strdup(signal_name);
+    memstat_add(MEMSTAT_SIGNAL, sizeof(SignalValue));
+    sv->name = intern_str(signal_name);
     sv = hashmap_set(&channel->signal_values, signal_name, sv);
     assert(sv);
     _invalidate_index(channel);
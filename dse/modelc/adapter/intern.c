@@ -0,0 +1,238 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/intern.h>
+
+
+#define INTERN_TABLE_INITIAL 1024 /* Must be a power of 2. */
+
+
+typedef struct InternChunk {
+    struct InternChunk* next;
+    size_t              size;
+    size_t              used;
+    char                data[];
+} InternChunk;
+
+
+typedef struct InternEntry {
+    uint32_t    hash;
+    uint32_t    id; /* 0 : empty slot. */
+    const char* str;
+} InternEntry;
+
+
+static struct {
+    InternChunk*  chunk; /* Current chunk, head of the chunk list. */
+    InternEntry*  table; /* Open addressing (linear probe). */
+    uint32_t      table_size;
+    const char**  strings; /* Indexed by id - 1. */
+    uint32_t      strings_size;
+    uint32_t      count;
+    size_t        bytes;
+} __intern = { 0 };
+
+/* The SimBus and Models may run on separate threads of one process (inproc
+   transport), signals are interned from both. */
+static pthread_mutex_t __intern_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static uint32_t _hash(const char* s, size_t* len)
+{
+    // FNV-1a hash (http://www.isthe.com/chongo/tech/comp/fnv/)
+    uint32_t h = 2166136261UL; /* FNV_OFFSET 32 bit */
+    size_t   i = 0;
+    for (; s[i]; i++) {
+        h = h ^ (unsigned char)s[i];
+        h = h * 16777619UL; /* FNV_PRIME 32 bit */
+    }
+    *len = i;
+    return h;
+}
+
+
+static char* _arena_alloc(size_t size)
+{
+    InternChunk* c = __intern.chunk;
+    if (c == NULL || (c->size - c->used) < size) {
+        size_t chunk_size =
+            (size > INTERN_ARENA_CHUNK) ? size : INTERN_ARENA_CHUNK;
+        c = malloc(sizeof(InternChunk) + chunk_size);
+        if (c == NULL) return NULL;
+        c->next = __intern.chunk;
+        c->size = chunk_size;
+        c->used = 0;
+        __intern.chunk = c;
+        __intern.bytes += sizeof(InternChunk) + chunk_size;
+    }
+    char* p = &c->data[c->used];
+    c->used += size;
+    return p;
+}
+
+
+static int _table_grow(void)
+{
+    uint32_t size = __intern.table_size ? __intern.table_size * 2
+                                        : INTERN_TABLE_INITIAL;
+    InternEntry* table = calloc(size, sizeof(InternEntry));
+    if (table == NULL) return -ENOMEM;
+
+    /* Rehash the existing entries. */
+    for (uint32_t i = 0; i < __intern.table_size; i++) {
+        InternEntry* e = &__intern.table[i];
+        if (e->id == 0) continue;
+        uint32_t slot = e->hash & (size - 1);
+        while (table[slot].id) slot = (slot + 1) & (size - 1);
+        table[slot] = *e;
+    }
+    __intern.bytes += (size - __intern.table_size) * sizeof(InternEntry);
+    free(__intern.table);
+    __intern.table = table;
+    __intern.table_size = size;
+
+    /* The id array grows with the table (load factor is at most 1/2). */
+    const char** strings = realloc(__intern.strings, size * sizeof(char*));
+    if (strings == NULL) return -ENOMEM;
+    __intern.bytes += (size - __intern.strings_size) * sizeof(char*);
+    __intern.strings = strings;
+    __intern.strings_size = size;
+
+    return 0;
+}
+
+
+static uint32_t _intern_id(const char* s)
+{
+    if ((__intern.count + 1) * 2 > __intern.table_size) {
+        if (_table_grow()) {
+            log_error("Intern table realloc failed!");
+            errno = ENOMEM;
+            return 0;
+        }
+    }
+
+    size_t   len;
+    uint32_t hash = _hash(s, &len);
+    uint32_t slot = hash & (__intern.table_size - 1);
+    while (__intern.table[slot].id) {
+        InternEntry* e = &__intern.table[slot];
+        if (e->hash == hash && strcmp(e->str, s) == 0) return e->id;
+        slot = (slot + 1) & (__intern.table_size - 1);
+    }
+
+    /* New string. */
+    char* str = _arena_alloc(len + 1);
+    if (str == NULL) {
+        log_error("Intern arena malloc failed!");
+        errno = ENOMEM;
+        return 0;
+    }
+    memcpy(str, s, len + 1);
+    __intern.strings[__intern.count] = str;
+    __intern.count++;
+    __intern.table[slot] = (InternEntry){
+        .hash = hash,
+        .id = __intern.count,
+        .str = str,
+    };
+
+    return __intern.count;
+}
+
+
+/**
+ *  intern_id
+ *
+ *  Intern a string and return its id. The string is copied into the table
+ *  only the first time it is interned.
+ *
+ *  Parameters
+ *  ----------
+ *  s : const char*
+ *      The string to intern.
+ *
+ *  Returns
+ *  -------
+ *      uint32_t : The id of the interned string (1..N).
+ *      0 : The string was NULL, or could not be interned (errno is set).
+ */
+DLL_PRIVATE uint32_t intern_id(const char* s)
+{
+    if (s == NULL) return 0;
+
+    pthread_mutex_lock(&__intern_lock);
+    uint32_t id = _intern_id(s);
+    pthread_mutex_unlock(&__intern_lock);
+    return id;
+}
+
+
+/**
+ *  intern_str
+ *
+ *  Intern a string and return the stable (interned) pointer.
+ *
+ *  Parameters
+ *  ----------
+ *  s : const char*
+ *      The string to intern.
+ *
+ *  Returns
+ *  -------
+ *      const char* : The interned string (do not free).
+ *      NULL : The string was NULL, or could not be interned.
+ */
+DLL_PRIVATE const char* intern_str(const char* s)
+{
+    return intern_lookup(intern_id(s));
+}
+
+
+DLL_PRIVATE const char* intern_lookup(uint32_t id)
+{
+    const char* str = NULL;
+
+    pthread_mutex_lock(&__intern_lock);
+    if (id && id <= __intern.count) str = __intern.strings[id - 1];
+    pthread_mutex_unlock(&__intern_lock);
+    return str;
+}
+
+
+DLL_PRIVATE void intern_stats(uint32_t* count, size_t* bytes)
+{
+    pthread_mutex_lock(&__intern_lock);
+    if (count) *count = __intern.count;
+    if (bytes) *bytes = __intern.bytes;
+    pthread_mutex_unlock(&__intern_lock);
+}
+
+
+/**
+ *  intern_destroy
+ *
+ *  Release the table, all previously interned pointers become invalid.
+ */
+DLL_PRIVATE void intern_destroy(void)
+{
+    pthread_mutex_lock(&__intern_lock);
+    InternChunk* c = __intern.chunk;
+    while (c) {
+        InternChunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    free(__intern.table);
+    free(__intern.strings);
+    memset(&__intern, 0, sizeof(__intern));
+    pthread_mutex_unlock(&__intern_lock);
+}
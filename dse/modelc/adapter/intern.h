@@ -0,0 +1,39 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_INTERN_H_
+#define DSE_MODELC_ADAPTER_INTERN_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <dse/platform.h>
+
+
+#define INTERN_ARENA_CHUNK (64 * 1024)
+
+
+/*
+Interned String Table
+---------------------
+
+Process wide table of (signal) names. Each unique string is stored once, in
+an arena, and is identified by a stable id (1..N, 0 is reserved for NULL). The
+returned pointers remain valid until intern_destroy() is called, they can be
+shared (without copying) by channels, models and vectors.
+
+The table is not thread safe, strings should be interned from the thread
+which operates the adapter (other threads may read interned strings).
+*/
+
+
+/* intern.c */
+DLL_PRIVATE uint32_t    intern_id(const char* s);
+DLL_PRIVATE const char* intern_str(const char* s);
+DLL_PRIVATE const char* intern_lookup(uint32_t id);
+DLL_PRIVATE void        intern_stats(uint32_t* count, size_t* bytes);
+DLL_PRIVATE void        intern_destroy(void);
+
+
+#endif  // DSE_MODELC_ADAPTER_INTERN_H_
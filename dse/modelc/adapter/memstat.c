@@ -0,0 +1,171 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/memstat.h>
+
+
+#define UNUSED(x) ((void)x)
+
+/* Size prefix of wrapped allocations, keeps the malloc() alignment. */
+#define MEMSTAT_HEADER_SIZE 16
+
+
+static const char* __tag_names[__MEMSTAT_TAG_COUNT__] = {
+    [MEMSTAT_SIGNAL] = "signal",
+    [MEMSTAT_BINARY] = "binary",
+    [MEMSTAT_CONTROLLER] = "controller",
+    [MEMSTAT_TRANSPORT] = "transport",
+    [MEMSTAT_FLATCC] = "flatcc",
+    [MEMSTAT_SIMBUS] = "simbus",
+};
+
+
+/* Counters may be updated from transport threads. */
+static MemStatCounter        __counters[__MEMSTAT_TAG_COUNT__] = { 0 };
+static volatile sig_atomic_t __dump_request = 0;
+
+
+/**
+ *  memstat_add
+ *
+ *  Account storage against a tag.
+ *
+ *  Parameters
+ *  ----------
+ *  tag : MemStatTag
+ *      The tag (subsystem) which owns the storage.
+ *  size : int64_t
+ *      Bytes allocated (positive) or released (negative).
+ */
+DLL_PRIVATE void memstat_add(MemStatTag tag, int64_t size)
+{
+    if (tag >= __MEMSTAT_TAG_COUNT__ || size == 0) return;
+    MemStatCounter* c = &__counters[tag];
+
+    int64_t current =
+        __atomic_add_fetch(&c->current, size, __ATOMIC_RELAXED);
+    if (size < 0) return;
+    __atomic_add_fetch(&c->allocs, 1, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&c->peak, __ATOMIC_RELAXED);
+    while (current > peak) {
+        if (__atomic_compare_exchange_n(&c->peak, &peak, current, false,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+}
+
+
+DLL_PRIVATE void memstat_get(MemStatTag tag, MemStatCounter* counter)
+{
+    if (tag >= __MEMSTAT_TAG_COUNT__ || counter == NULL) return;
+    MemStatCounter* c = &__counters[tag];
+    counter->current = __atomic_load_n(&c->current, __ATOMIC_RELAXED);
+    counter->peak = __atomic_load_n(&c->peak, __ATOMIC_RELAXED);
+    counter->allocs = __atomic_load_n(&c->allocs, __ATOMIC_RELAXED);
+}
+
+
+/**
+ *  memstat_malloc
+ *
+ *  Allocate accounted storage. Storage must be released (or resized) with
+ *  memstat_free() (or memstat_realloc()) using the same tag.
+ */
+DLL_PRIVATE void* memstat_malloc(MemStatTag tag, size_t size)
+{
+    uint8_t* p = malloc(MEMSTAT_HEADER_SIZE + size);
+    if (p == NULL) return NULL;
+    *(size_t*)p = size;
+    memstat_add(tag, (int64_t)size);
+    return p + MEMSTAT_HEADER_SIZE;
+}
+
+
+DLL_PRIVATE void* memstat_calloc(MemStatTag tag, size_t nmemb, size_t size)
+{
+    size_t   len = nmemb * size;
+    uint8_t* p = calloc(1, MEMSTAT_HEADER_SIZE + len);
+    if (p == NULL) return NULL;
+    *(size_t*)p = len;
+    memstat_add(tag, (int64_t)len);
+    return p + MEMSTAT_HEADER_SIZE;
+}
+
+
+DLL_PRIVATE void* memstat_realloc(MemStatTag tag, void* ptr, size_t size)
+{
+    if (ptr == NULL) return memstat_malloc(tag, size);
+
+    uint8_t* p = (uint8_t*)ptr - MEMSTAT_HEADER_SIZE;
+    size_t   old_size = *(size_t*)p;
+    p = realloc(p, MEMSTAT_HEADER_SIZE + size);
+    if (p == NULL) return NULL;
+    *(size_t*)p = size;
+    memstat_add(tag, (int64_t)size - (int64_t)old_size);
+    return p + MEMSTAT_HEADER_SIZE;
+}
+
+
+DLL_PRIVATE void memstat_free(MemStatTag tag, void* ptr)
+{
+    if (ptr == NULL) return;
+
+    uint8_t* p = (uint8_t*)ptr - MEMSTAT_HEADER_SIZE;
+    memstat_add(tag, -(int64_t)(*(size_t*)p));
+    free(p);
+}
+
+
+/* On-demand report
+   ---------------- */
+
+static void _memstat_signal_handler(int signum)
+{
+    UNUSED(signum);
+    __dump_request = 1;
+}
+
+
+/**
+ *  memstat_install_handler
+ *
+ *  Install a SIGUSR1 handler which requests an on-demand report. The report
+ *  is printed by the run loop (see memstat_dump_requested()) rather than from
+ *  the signal handler.
+ */
+DLL_PRIVATE void memstat_install_handler(void)
+{
+#ifndef _WIN32
+    signal(SIGUSR1, _memstat_signal_handler);
+#endif
+}
+
+
+DLL_PRIVATE bool memstat_dump_requested(void)
+{
+    if (__dump_request == 0) return false;
+    __dump_request = 0;
+    return true;
+}
+
+
+DLL_PRIVATE void memstat_print(const char* name)
+{
+    log_notice("Memory Accounting (%s):", name);
+    for (uint32_t i = 0; i < __MEMSTAT_TAG_COUNT__; i++) {
+        MemStatCounter c;
+        memstat_get(i, &c);
+        if (c.allocs == 0) continue;
+        log_notice("  %-12s: current=%" PRId64 ", peak=%" PRId64
+                   " (bytes), allocs=%" PRIu64,
+            __tag_names[i], c.current, c.peak, c.allocs);
+    }
+}
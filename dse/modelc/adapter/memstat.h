@@ -0,0 +1,62 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_MEMSTAT_H_
+#define DSE_MODELC_ADAPTER_MEMSTAT_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/platform.h>
+
+
+/*
+Memory Accounting
+-----------------
+
+Allocations are accounted against a tag (subsystem). Storage which is both
+allocated and released by this code base uses the tagged wrappers:
+
+    void* p = memstat_malloc(MEMSTAT_TRANSPORT, size);
+    memstat_free(MEMSTAT_TRANSPORT, p);
+
+Storage managed elsewhere (e.g. objects released by a clib collection, or
+buffers resized by dse_buffer_append()) is accounted with memstat_add(),
+using a negative size when the storage is released.
+
+The current and peak bytes for each tag are printed at exit. An on-demand
+report is printed (from the run loop) after the process receives SIGUSR1.
+*/
+typedef enum MemStatTag {
+    MEMSTAT_SIGNAL = 0, /* Adapter SignalValue objects. */
+    MEMSTAT_BINARY,     /* Adapter binary signal buffers. */
+    MEMSTAT_CONTROLLER, /* Model Function Channel storage, marshal plan. */
+    MEMSTAT_TRANSPORT,  /* Transport queues and messages. */
+    MEMSTAT_FLATCC,     /* Flatbuffer builder storage and buffers. */
+    MEMSTAT_SIMBUS,     /* SimBus storage (e.g. lookahead frames). */
+    __MEMSTAT_TAG_COUNT__,
+} MemStatTag;
+
+
+typedef struct MemStatCounter {
+    int64_t  current;
+    int64_t  peak;
+    uint64_t allocs;
+} MemStatCounter;
+
+
+/* memstat.c */
+DLL_PRIVATE void* memstat_malloc(MemStatTag tag, size_t size);
+DLL_PRIVATE void* memstat_calloc(MemStatTag tag, size_t nmemb, size_t size);
+DLL_PRIVATE void* memstat_realloc(MemStatTag tag, void* ptr, size_t size);
+DLL_PRIVATE void  memstat_free(MemStatTag tag, void* ptr);
+DLL_PRIVATE void  memstat_add(MemStatTag tag, int64_t size);
+DLL_PRIVATE void  memstat_get(MemStatTag tag, MemStatCounter* counter);
+DLL_PRIVATE void  memstat_install_handler(void);
+DLL_PRIVATE bool  memstat_dump_requested(void);
+DLL_PRIVATE void  memstat_print(const char* name);
+
+
+#endif  // DSE_MODELC_ADAPTER_MEMSTAT_H_
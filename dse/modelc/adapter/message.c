@@ -5,10 +5,14 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <errno.h>
 #include <dse/logger.h>
 #include <dse/modelc/adapter/adapter.h>
 #include <dse/modelc/adapter/private.h>
 #include <dse/modelc/adapter/message.h>
+#include <dse/modelc/adapter/probe.h>
+#include <dse/modelc/adapter/timer.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
 #include <dse_schemas/flatbuffers/simbus_channel_builder.h>
 
@@ -16,11 +20,37 @@
 static int32_t get_token(void)
 {
     static int32_t _token = 0;
-    return ++_token;
+    return __atomic_add_fetch(&_token, 1, __ATOMIC_RELAXED);
     // TODO: use an random int or handle overflow.
 }
 
 
+static bool _match_pending(AdapterMsgVTable* v, const char* channel_name,
+    uint32_t model_uid, int32_t token, ns(MessageType_union_type_t) msg_type,
+    const char* response)
+{
+    for (uint32_t i = 0; i < v->pending_count; i++) {
+        PendingRequest* r = &v->pending[i];
+        if (r->done) continue;
+        if (r->token) {
+            if (r->token != token) continue;
+        } else {
+            if (r->message_type == ns(MessageType_NONE)) continue;
+            if (r->message_type != msg_type) continue;
+            if (r->model_uid != model_uid) continue;
+            if (channel_name == NULL || r->channel_name == NULL) continue;
+            if (strcmp(r->channel_name, channel_name) != 0) continue;
+        }
+        r->done = true;
+        if (response) {
+            strncpy(r->response, response, sizeof(r->response) - 1);
+        }
+        return true;
+    }
+    return false;
+}
+
+
 static bool process_sbch_message(Adapter* adapter, uint8_t* msg_ptr,
     const char* channel_name, ns(MessageType_union_type_t) message_type,
     int32_t     token)
@@ -53,6 +83,22 @@ static bool process_sbch_message(Adapter* adapter, uint8_t* msg_ptr,
             log_trace("    msg ack (token=%d)", message_token);
         }
     }
+    /* Is this a response to a pipelined request? */
+    if (uid_match && v->pending_count) {
+        ns(MessageType_union_type_t) _msg_type;
+        _msg_type = ns(ChannelMessage_message_type(channel_message));
+        const char* _response = NULL;
+        if (ns(ChannelMessage_response_is_present(channel_message))) {
+            _response = ns(ChannelMessage_response(channel_message));
+        }
+        if (_match_pending(v, channel_name, message_model_uid,
+                message_token, _msg_type, _response)) {
+            /* ACKs are not passed to the Message Handler. */
+            if (message_token) ack_found = true;
+            log_trace("    pending match (token=%d, type=%d)", message_token,
+                _msg_type);
+        }
+    }
     /* Call the Message Handler. */
     if (adapter->bus_mode || (uid_match && !ack_found)) {
         ns(MessageType_union_type_t) _msg_type;
@@ -97,6 +143,7 @@ static bool process_message_stream(Adapter* adapter, const char* channel_name,
     size_t   msg_len = 0;
     uint8_t* msg_ptr = buffer;
 
+    PROBE1(endpoint_recv, length);
     /* Messages are in a stream, each with a size prefix. */
     while (((msg_ptr - buffer) + msg_len) < (uint32_t)length) {
         msg_ptr = flatbuffers_read_size_prefix(msg_ptr, &msg_len);
@@ -141,8 +188,10 @@ int32_t wait_message(Adapter* adapter, const char**    channel_name,
         const char* msg_channel_name = NULL;
 
         errno = 0;
+        PROBE2(wait_block, message_type, token);
         length = endpoint->recv_fbs(
             endpoint, &msg_channel_name, buffer, buffer_length);
+        PROBE1(wait_unblock, length);
         if (length <= 0) {
             /* If the length was 0 (or less) then no message was received. */
 
@@ -181,15 +230,91 @@ int32_t wait_message(Adapter* adapter, const char**    channel_name,
 }
 
 
-/**send_message
+/**wait_pending
 
-NOTE: the message will already be encoded to the builder object on the
-adapter->vtable, therefore, this function should only be called once per
-message (i.e. send_all should be unwound to a for loop with a
-flacc_builder_reset() call on each loop ... or a buffer memcpy).
+Wait for the responses of pipelined requests (see send_message_token()). All
+messages received while waiting are processed by the Message Handler.
+
+The wait is bounded by bound_ms, each receive of the Endpoint is then bounded
+by the remaining time (see endpoint_recv_timeout()). Otherwise the wait ends
+with the timeout of the transport.
+
+Returns
+-------
+    0 : All requests were answered (request[].done).
+    ETIME : Timeout, some requests are outstanding.
+    ECANCELED : Stop request (interrupt).
  */
-int32_t send_message(Adapter* adapter, void* endpoint_channel,
-    uint32_t model_uid, ns(MessageType_union_ref_t) message, bool ack)
+int32_t wait_pending(Adapter* adapter, PendingRequest* request, uint32_t count,
+    uint32_t bound_ms)
+{
+    assert(adapter);
+    assert(adapter->vtable);
+
+    Endpoint*         endpoint = adapter->endpoint;
+    AdapterMsgVTable* v = (AdapterMsgVTable*)adapter->vtable;
+    uint8_t**         buffer = &(v->ep_buffer); /* realloc may be called */
+    uint32_t*         buffer_length = &(v->ep_buffer_length);
+    int32_t           rc = 0;
+    struct timespec   ts = get_timespec_now();
+
+    v->pending = request;
+    v->pending_count = count;
+    while (1) {
+        uint32_t outstanding = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (request[i].done == false) outstanding++;
+        }
+        if (outstanding == 0) break;
+        if (adapter->stop_request || endpoint->stop_request) {
+            rc = ECANCELED;
+            break;
+        }
+
+        /* Bound the receive to the remaining time. */
+        if (bound_ms) {
+            uint64_t elapsed_ms = get_elapsedtime_ns(ts) / 1000000;
+            if (elapsed_ms >= bound_ms) {
+                log_simbus("wait_pending: timeout (%u outstanding)",
+                    outstanding);
+                rc = ETIME;
+                break;
+            }
+            __atomic_store_n(&endpoint->recv_bound_ms,
+                bound_ms - (uint32_t)elapsed_ms, __ATOMIC_RELAXED);
+        }
+
+        /* Receive a FBS Message Stream. */
+        const char* msg_channel_name = NULL;
+        errno = 0;
+        PROBE2(wait_block, ns(MessageType_NONE), 0);
+        int32_t length = endpoint->recv_fbs(
+            endpoint, &msg_channel_name, buffer, buffer_length);
+        PROBE1(wait_unblock, length);
+        if (length <= 0) {
+            if (errno == ETIME && bound_ms) continue; /* Check the bound. */
+            if (errno == ETIME) {
+                log_simbus("wait_pending: timeout (%u outstanding)",
+                    outstanding);
+                rc = ETIME;
+                break;
+            }
+            continue;
+        }
+        process_message_stream(adapter, msg_channel_name, *buffer, length,
+            ns(MessageType_NONE), 0);
+    }
+    v->pending = NULL;
+    v->pending_count = 0;
+    __atomic_store_n(&endpoint->recv_bound_ms, 0, __ATOMIC_RELAXED);
+
+    return rc;
+}
+
+
+static int32_t _send_message(Adapter* adapter, void* endpoint_channel,
+    uint32_t model_uid, ns(MessageType_union_ref_t) message, int32_t token,
+    bool wait, const char* info)
 {
     assert(model_uid);
     assert(adapter);
@@ -199,20 +324,23 @@ int32_t send_message(Adapter* adapter, void* endpoint_channel,
     flatcc_builder_t* builder = &(v->builder);
     uint8_t*          buf;
     size_t            size;
-    int32_t           token = 0;
     int               rc;
     ns(ChannelMessage_ref_t) channel_message;
     int send_message__rc = 0;
 
     //    if (model_uid == 0) model_uid = adapter->model_uid;
-    if (ack) token = get_token();
     /* Build the Channel Message (without 'create' because it wants all
      * parameters) */
     ns(ChannelMessage_start)(builder);
     ns(ChannelMessage_model_uid_add)(builder, model_uid);
     ns(ChannelMessage_message_add_value)(builder, message);
-    if (ack) ns(ChannelMessage_token_add)(builder, token);
+    if (token) ns(ChannelMessage_token_add)(builder, token);
     ns(ChannelMessage_message_add_type)(builder, message.type);
+    if (info) {
+        flatbuffers_string_ref_t _info;
+        _info = flatbuffers_string_create_str(builder, info);
+        ns(ChannelMessage_response_add)(builder, _info);
+    }
     channel_message = ns(ChannelMessage_end)(builder);
     /* Construct the buffer. */
     flatcc_builder_create_buffer(builder, flatbuffers_channel_identifier,
@@ -220,16 +348,18 @@ int32_t send_message(Adapter* adapter, void* endpoint_channel,
         builder->buffer_flags);
     buf = flatcc_builder_finalize_buffer(
         builder, &size); /* malloc, must call free. */
+    memstat_add(MEMSTAT_FLATCC, size);
 
     /* Send the Channel Message with the configured Transport. */
     rc = endpoint->send_fbs(
         endpoint, endpoint_channel, buf, (uint32_t)size, model_uid);
+    PROBE2(endpoint_send, model_uid, size);
     if (rc != 0) {
         send_message__rc = EBADMSG;
         log_error("send_fbs returned %d", rc);
         goto error_clean_up;
     }
-    if (token > 0) {
+    if (token > 0 && wait) {
         const char* _msg_channel_name = NULL;
         bool        found = false;
         rc = wait_message(
@@ -262,11 +392,59 @@ int32_t send_message(Adapter* adapter, void* endpoint_channel,
     }
 
 error_clean_up:
+    memstat_add(MEMSTAT_FLATCC, -(int64_t)size);
     FLATCC_BUILDER_FREE(buf);
     return send_message__rc;
 }
 
 
+/**send_message
+
+NOTE: the message will already be encoded to the builder object on the
+adapter->vtable, therefore, this function should only be called once per
+message (i.e. send_all should be unwound to a for loop with a
+flacc_builder_reset() call on each loop ... or a buffer memcpy).
+ */
+int32_t send_message(Adapter* adapter, void* endpoint_channel,
+    uint32_t model_uid, ns(MessageType_union_ref_t) message, bool ack)
+{
+    return send_message_info(
+        adapter, endpoint_channel, model_uid, message, ack, NULL);
+}
+
+
+/**send_message_info
+
+As send_message(), additionally sets the response field of the Channel
+Message (e.g. capabilities announced with ModelRegister).
+ */
+int32_t send_message_info(Adapter* adapter, void* endpoint_channel,
+    uint32_t model_uid, ns(MessageType_union_ref_t) message, bool ack,
+    const char* info)
+{
+    int32_t token = (ack) ? get_token() : 0;
+    return _send_message(
+        adapter, endpoint_channel, model_uid, message, token, true, info);
+}
+
+
+/**send_message_token
+
+As send_message_info(), with a token (i.e. an ACK is requested) but without
+waiting for the ACK. The token is returned so that the ACK can be matched
+later (see wait_pending()).
+ */
+int32_t send_message_token(Adapter* adapter, void* endpoint_channel,
+    uint32_t model_uid, ns(MessageType_union_ref_t) message,
+    const char* info, int32_t* token)
+{
+    assert(token);
+    *token = get_token();
+    return _send_message(
+        adapter, endpoint_channel, model_uid, message, *token, false, info);
+}
+
+
 /**send_message_ack
 
 NOTE: when calling send_message_ack() start a new builder object and make a
@@ -307,10 +485,12 @@ int32_t send_message_ack(Adapter* adapter, void* endpoint_channel,
         builder->buffer_flags);
     buf = flatcc_builder_finalize_buffer(
         builder, &size); /* malloc, must call free. */
+    memstat_add(MEMSTAT_FLATCC, size);
 
     /* Send the Channel Message with the configured Transport. */
     rc = endpoint->send_fbs(
         endpoint, endpoint_channel, buf, (uint32_t)size, model_uid);
+    PROBE2(endpoint_send, model_uid, size);
     if (rc != 0) goto error_clean_up;
 
     /* Echo the outgoing messages for development/debug. */
@@ -324,6 +504,7 @@ int32_t send_message_ack(Adapter* adapter, void* endpoint_channel,
     }
 
 error_clean_up:
+    memstat_add(MEMSTAT_FLATCC, -(int64_t)size);
     FLATCC_BUILDER_FREE(buf);
     return 0;
 }
@@ -341,9 +522,12 @@ int32_t send_notify_message(
         builder->buffer_flags);
     size_t   size = 0;
     uint8_t* buf = flatcc_builder_finalize_buffer(builder, &size);
+    memstat_add(MEMSTAT_FLATCC, size);
 
     /* Send the Channel Message with the configured Transport. */
     endpoint->send_fbs(endpoint, NULL, buf, (uint32_t)size, 0);
+    PROBE2(endpoint_send, 0, size);
+    memstat_add(MEMSTAT_FLATCC, -(int64_t)size);
     FLATCC_BUILDER_FREE(buf);
     return 0;
 }
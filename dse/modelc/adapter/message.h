@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <dse_schemas/flatbuffers/simbus_channel_builder.h>
 #include <dse_schemas/flatbuffers/simbus_notify_builder.h>
+#include <dse/modelc/adapter/encoding.h>
 #include <dse/platform.h>
 
 
@@ -28,6 +29,18 @@ typedef void (*HandleChannelMessageFunc)(Adapter* adapter,
 typedef void (*HandleNotifyMessageFunc)(
     Adapter* adapter, notify(NotifyMessage_table_t) notify_message);
 
+/* A pipelined request, the response is matched either by the ACK token or
+   (token = 0) by the channel, model and message type of the response. */
+typedef struct PendingRequest {
+    const char* channel_name;
+    uint32_t    model_uid;
+    int32_t     token;
+    ns(MessageType_union_type_t) message_type;
+    bool done;
+    /* Response of the ACK (if provided), truncated. */
+    char response[SV_INFO_LEN];
+} PendingRequest;
+
 typedef struct AdapterMsgVTable {
     AdapterVTable vtable;
 
@@ -39,6 +52,11 @@ typedef struct AdapterMsgVTable {
     flatcc_builder_t builder;
     uint8_t*         ep_buffer;
     uint32_t         ep_buffer_length;
+    SvBuffer         sv_buffer; /* SignalVector encoding (V2). */
+
+    /* Outstanding requests (only set during wait_pending()). */
+    PendingRequest* pending;
+    uint32_t        pending_count;
 } AdapterMsgVTable;
 
 
@@ -47,11 +65,19 @@ DLL_PRIVATE int32_t send_notify_message(
     Adapter* adapter, notify(NotifyMessage_ref_t) message);
 DLL_PRIVATE int32_t send_message(Adapter* adapter, void* endpoint_channel,
     uint32_t model_uid, ns(MessageType_union_ref_t) message, bool ack);
+DLL_PRIVATE int32_t send_message_info(Adapter* adapter,
+    void* endpoint_channel, uint32_t model_uid,
+    ns(MessageType_union_ref_t) message, bool ack, const char* info);
+DLL_PRIVATE int32_t send_message_token(Adapter* adapter,
+    void* endpoint_channel, uint32_t model_uid,
+    ns(MessageType_union_ref_t) message, const char* info, int32_t* token);
 DLL_PRIVATE int32_t send_message_ack(Adapter* adapter, void* endpoint_channel,
     uint32_t model_uid, ns(MessageType_union_ref_t) message, int32_t token,
     int32_t rc, char* response);
 DLL_PRIVATE int32_t wait_message(Adapter* adapter, const char** channel_name,
     ns(MessageType_union_type_t) message_type, int32_t token, bool* found);
+DLL_PRIVATE int32_t wait_pending(Adapter* adapter, PendingRequest* request,
+    uint32_t count, uint32_t bound_ms);
 
 
 #endif  // DSE_MODELC_ADAPTER_MESSAGE_H_
@@ -7,7 +7,12 @@
 
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <dse/clib/util/strings.h>
 #include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/memstat.h>
 #include <dse/platform.h>
 
 
@@ -28,4 +33,81 @@ DLL_PRIVATE SignalMap* _get_signal_value_map(
     Channel* channel, const char** signal_name, uint32_t signal_count);
 
 
+/* Delta detection for double signals. Without a deadband any change of
+   final_val is transmitted, otherwise the change (from the last transmitted
+   value) must exceed both the absolute and relative thresholds. */
+static inline bool _signal_value_changed(SignalValue* sv)
+{
+    if (sv->deadband == 0.0 && sv->deadband_relative == 0.0) {
+        return sv->val != sv->final_val;
+    }
+    double delta = fabs(sv->final_val - sv->tx_val);
+    return (delta > sv->deadband) &&
+           (delta > sv->deadband_relative * fabs(sv->tx_val));
+}
+
+
+/* Append to the binary buffer of a signal, accounting buffer growth (the
+   buffer is resized by dse_buffer_append()) and the channel high-water mark. */
+static inline void _signal_value_bin_append(
+    Channel* channel, SignalValue* sv, const void* data, uint32_t size)
+{
+    uint32_t capacity = sv->bin_buffer_size;
+    dse_buffer_append(
+        &sv->bin, &sv->bin_size, &sv->bin_buffer_size, data, size);
+    if (sv->bin_buffer_size != capacity) {
+        memstat_add(MEMSTAT_BINARY, (int64_t)sv->bin_buffer_size - capacity);
+        channel->bin_capacity += sv->bin_buffer_size - capacity;
+    }
+    if (sv->bin_size > channel->bin_hwm) channel->bin_hwm = sv->bin_size;
+}
+
+
+/* Record a signal written (SimBus) in the current cycle, the list is used to
+   classify writers and resolve only the written signals (see handler.c). */
+static inline void _signal_value_written(Channel* channel, SignalValue* sv)
+{
+    if (channel->forward.written_count == channel->forward.written_capacity) {
+        uint32_t capacity = channel->forward.written_capacity
+                                ? channel->forward.written_capacity * 2
+                                : 64;
+        void*    p = realloc(
+               channel->forward.written, capacity * sizeof(SignalValue*));
+        if (p == NULL) {
+            /* Not recorded, the channel is resolved as usual. */
+            channel->forward.valid = false;
+            return;
+        }
+        channel->forward.written = p;
+        channel->forward.written_capacity = capacity;
+    }
+    channel->forward.written[channel->forward.written_count++] = sv;
+}
+
+
+/* Record a signal changed (Model, received), the list is walked rather than
+   all signals of the channel when marshalling to the Model Functions (see
+   controller_changed_to_model()). */
+static inline void _signal_value_set_changed(Channel* channel, SignalValue* sv)
+{
+    if (sv->changed) return; /* Already recorded. */
+    sv->changed = true;
+    if (channel->changed.overflow) return;
+    if (channel->changed.count == channel->changed.capacity) {
+        uint32_t capacity =
+            channel->changed.capacity ? channel->changed.capacity * 2 : 64;
+        void* p =
+            realloc(channel->changed.signal, capacity * sizeof(SignalValue*));
+        if (p == NULL) {
+            /* Not recorded, all signals of the channel are evaluated. */
+            channel->changed.overflow = true;
+            return;
+        }
+        channel->changed.signal = p;
+        channel->changed.capacity = capacity;
+    }
+    channel->changed.signal[channel->changed.count++] = sv;
+}
+
+
 #endif  // DSE_MODELC_ADAPTER_PRIVATE_H_
@@ -0,0 +1,59 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_PROBE_H_
+#define DSE_MODELC_ADAPTER_PROBE_H_
+
+
+#include <stdint.h>
+
+
+/*
+Static Tracepoints (USDT)
+-------------------------
+
+Probes (provider "modelc") on the hot paths of ModelC and the SimBus, for use
+with perf, bpftrace (see extra/tools/bpftrace) and similar tools. A probe is
+a single nop instruction until a tracer attaches to it. Times are passed as
+nanoseconds (uint64).
+
+    bus_notify_recv(model_time_ns, signal_vector_count)
+    bus_resolve(bus_time_ns)
+    bus_notify_sent(bus_time_ns)
+    model_step_begin(model_uid, model_time_ns, stop_time_ns)
+    model_step_end(model_uid, model_time_ns, rc)
+    marshal_in_begin(item_count), marshal_in_end(item_count)
+    marshal_out_begin(item_count), marshal_out_end(item_count)
+    wait_block(message_type, token)
+    wait_unblock(length)
+    endpoint_send(model_uid, length)
+    endpoint_recv(length)
+
+The probes are compiled when <sys/sdt.h> is available (Linux, package
+systemtap-sdt-dev), and may be disabled with -DMODELC_NO_PROBES.
+
+    $ bpftrace -l 'usdt:/usr/local/bin/simbus:modelc:*'
+*/
+#if defined(__linux__) && !defined(MODELC_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define MODELC_PROBES_ENABLED 1
+#endif
+#endif
+
+
+#define PROBE_NS(t) ((uint64_t)((t) * 1e9))
+
+#ifdef MODELC_PROBES_ENABLED
+#define PROBE1(name, a)       DTRACE_PROBE1(modelc, name, a)
+#define PROBE2(name, a, b)    DTRACE_PROBE2(modelc, name, a, b)
+#define PROBE3(name, a, b, c) DTRACE_PROBE3(modelc, name, a, b, c)
+#else
+#define PROBE1(name, a)       ((void)0)
+#define PROBE2(name, a, b)    ((void)0)
+#define PROBE3(name, a, b, c) ((void)0)
+#endif
+
+
+#endif  // DSE_MODELC_ADAPTER_PROBE_H_
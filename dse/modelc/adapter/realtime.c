@@ -0,0 +1,448 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/realtime.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#endif
+
+
+#define REALTIME_SPEC_LEN    256
+#define REALTIME_ALIGN       64
+#define REALTIME_STACK_BYTES (256 * 1024)
+#define REALTIME_HUGEPAGE    (2 * 1024 * 1024)
+
+
+typedef struct RealtimeArena {
+    uint8_t* base;
+    size_t   size;
+    size_t   offset;
+} RealtimeArena;
+
+
+static RealtimeProfile __realtime = { .cpu = -1 };
+static RealtimeArena   __arena = { 0 };
+static uint32_t        __thread_count = 0; /* Threads the profile applied. */
+#ifdef __linux__
+static pthread_once_t __process_once = PTHREAD_ONCE_INIT;
+#endif
+
+
+static const char* __policy_names[] = {
+    [REALTIME_POLICY_FIFO] = "fifo",
+    [REALTIME_POLICY_RR] = "rr",
+};
+
+
+DLL_PRIVATE RealtimeProfile* realtime_profile(void)
+{
+    return &__realtime;
+}
+
+
+static int _parse_int(const char* value, long min, long max, long* result)
+{
+    if (value == NULL) return -EINVAL;
+
+    char* end = NULL;
+    errno = 0;
+    long v = strtol(value, &end, 10);
+    if (errno || end == value || *end != '\0') return -EINVAL;
+    if (v < min || v > max) return -EINVAL;
+    *result = v;
+    return 0;
+}
+
+
+static int _parse_policy(const char* value, int32_t* policy)
+{
+    if (value == NULL) return -EINVAL;
+
+    for (uint32_t i = 0; i < sizeof(__policy_names) / sizeof(char*); i++) {
+        if (strcmp(value, __policy_names[i]) == 0) {
+            *policy = i;
+            return 0;
+        }
+    }
+    return -EINVAL;
+}
+
+
+/**
+ *  realtime_configure
+ *
+ *  Parse a Realtime Profile string (e.g. "cpu=2,priority=80,mlock") and
+ *  configure the process wide profile. An empty (or NULL) string leaves the
+ *  profile disabled.
+ *
+ *  Parameters
+ *  ----------
+ *  spec : const char*
+ *      The profile string.
+ *
+ *  Returns
+ *  -------
+ *      0 : The profile was configured.
+ *      -EINVAL : The profile string contained an unknown option, or an option
+ *          with an invalid value (that option is not configured).
+ */
+DLL_PRIVATE int realtime_configure(const char* spec)
+{
+    __realtime = (RealtimeProfile){
+        .cpu = -1,
+        .arena_size = REALTIME_ARENA_DEFAULT_MB * 1024 * 1024,
+    };
+    if (spec == NULL || strlen(spec) == 0) return 0;
+    if (strcmp(spec, "off") == 0) return 0;
+
+    char buffer[REALTIME_SPEC_LEN];
+    strncpy(buffer, spec, REALTIME_SPEC_LEN - 1);
+    buffer[REALTIME_SPEC_LEN - 1] = '\0';
+
+    int   rc = 0;
+    char* _saveptr = NULL;
+    char* _opt = strtok_r(buffer, ",", &_saveptr);
+    while (_opt) {
+        char* _value = strchr(_opt, '=');
+        if (_value) *_value++ = '\0';
+
+        long v;
+        int  _rc = 0;
+        if (strcmp(_opt, "cpu") == 0) {
+            _rc = _parse_int(_value, 0, REALTIME_CPU_MAX, &v);
+            if (_rc == 0) __realtime.cpu = v;
+        } else if (strcmp(_opt, "priority") == 0) {
+            _rc = _parse_int(
+                _value, REALTIME_PRIORITY_MIN, REALTIME_PRIORITY_MAX, &v);
+            if (_rc == 0) __realtime.priority = v;
+        } else if (strcmp(_opt, "policy") == 0) {
+            _rc = _parse_policy(_value, &__realtime.policy);
+        } else if (strcmp(_opt, "mlock") == 0) {
+            __realtime.mlock = true;
+        } else if (strcmp(_opt, "hugepages") == 0) {
+            __realtime.hugepages = true;
+        } else if (strcmp(_opt, "arena") == 0) {
+            _rc = _parse_int(_value, 1, REALTIME_ARENA_MAX_MB, &v);
+            if (_rc == 0) __realtime.arena_size = (size_t)v * 1024 * 1024;
+        } else {
+            log_error("Realtime profile, unknown option: %s", _opt);
+            rc = -EINVAL;
+        }
+        if (_rc) {
+            log_error("Realtime profile, invalid value: %s=%s", _opt,
+                _value ? _value : "");
+            rc = -EINVAL;
+        }
+        _opt = strtok_r(NULL, ",", &_saveptr);
+    }
+    __realtime.enabled = true;
+
+    return rc;
+}
+
+
+#ifdef __linux__
+
+static void _apply_affinity(RealtimeProfile* rt, uint32_t index)
+{
+    if (rt->cpu < 0) return;
+
+    /* Each thread of the process is pinned to a CPU of its own. */
+    int cpu = rt->cpu + (int)index;
+    if (cpu > REALTIME_CPU_MAX) {
+        log_notice("  Affinity: cpu=%d not applied (out of range)", cpu);
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &set) == 0) {
+        rt->affinity_applied = true;
+        log_notice("  Affinity: cpu=%d", cpu);
+    } else {
+        log_notice("  Affinity: cpu=%d not applied (%s)", cpu, strerror(errno));
+    }
+}
+
+
+static void _apply_priority(RealtimeProfile* rt)
+{
+    if (rt->priority <= 0) return;
+
+    int policy = (rt->policy == REALTIME_POLICY_RR) ? SCHED_RR : SCHED_FIFO;
+    const char*        name = __policy_names[rt->policy];
+    struct sched_param param = { .sched_priority = rt->priority };
+    int                max = sched_get_priority_max(policy);
+    if (param.sched_priority > max) param.sched_priority = max;
+    if (sched_setscheduler(0, policy, &param) == 0) {
+        rt->priority_applied = true;
+        log_notice("  Scheduler: policy=%s priority=%d", name,
+            param.sched_priority);
+    } else {
+        log_notice("  Scheduler: policy=%s not applied (%s)", name,
+            strerror(errno));
+    }
+}
+
+
+static void _apply_mlock(RealtimeProfile* rt)
+{
+    if (rt->mlock == false) return;
+
+#ifdef __GLIBC__
+    /* Keep freed memory in the process (no trim, no mmap'ed chunks). */
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        rt->mlock_applied = true;
+        log_notice("  Memory: locked (mlockall)");
+    } else {
+        log_notice("  Memory: mlockall not applied (%s)", strerror(errno));
+    }
+}
+
+
+static void _prefault_stack(RealtimeProfile* rt)
+{
+    if (rt->mlock == false) return;
+
+    /* Pre-fault the stack of the calling thread. */
+    volatile uint8_t stack[REALTIME_STACK_BYTES];
+    memset((void*)stack, 0, sizeof(stack));
+}
+
+
+static void _apply_hugepages(RealtimeProfile* rt)
+{
+    if (rt->hugepages == false || __arena.base) return;
+
+    size_t size = rt->arena_size;
+    size = (size + REALTIME_HUGEPAGE - 1) & ~(size_t)(REALTIME_HUGEPAGE - 1);
+    if (size == 0) return;
+
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+        /* Fallback to transparent hugepages. */
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            log_notice("  Arena: not applied (%s)", strerror(errno));
+            return;
+        }
+        madvise(p, size, MADV_HUGEPAGE);
+        log_notice("  Arena: %zu MB (transparent hugepages)", size >> 20);
+    } else {
+        log_notice("  Arena: %zu MB (hugetlb)", size >> 20);
+    }
+    realtime_prefault(p, size);
+    __arena.size = size;
+    __arena.offset = 0;
+    __atomic_store_n(&__arena.base, p, __ATOMIC_RELEASE);
+    rt->hugepages_applied = true;
+}
+
+
+/* Process options, applied by the first thread. Other threads wait (in
+   pthread_once()) until the arena is set up, i.e. before they allocate signal
+   storage. */
+static void _apply_process(void)
+{
+    _apply_hugepages(&__realtime);
+    _apply_mlock(&__realtime);
+}
+
+
+static void _probe_wakeup_latency(RealtimeProfile* rt)
+{
+    struct timespec next, now;
+    uint64_t        total_ns = 0;
+
+    rt->wakeup_samples = 0;
+    rt->wakeup_min_ns = UINT64_MAX;
+    rt->wakeup_max_ns = 0;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (uint32_t i = 0; i < REALTIME_PROBE_SAMPLES; i++) {
+        next.tv_nsec += REALTIME_PROBE_PERIOD_NS;
+        if (next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL)) {
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t latency_ns = (now.tv_sec - next.tv_sec) * 1000000000 +
+                             (now.tv_nsec - next.tv_nsec);
+        if (latency_ns < 0) latency_ns = 0;
+        if ((uint64_t)latency_ns < rt->wakeup_min_ns) {
+            rt->wakeup_min_ns = latency_ns;
+        }
+        if ((uint64_t)latency_ns > rt->wakeup_max_ns) {
+            rt->wakeup_max_ns = latency_ns;
+        }
+        total_ns += latency_ns;
+        rt->wakeup_samples++;
+    }
+    if (rt->wakeup_samples) {
+        rt->wakeup_mean_ns = (double)total_ns / rt->wakeup_samples;
+    } else {
+        rt->wakeup_min_ns = 0;
+    }
+}
+
+#endif  // __linux__
+
+
+/**
+ *  realtime_apply
+ *
+ *  Apply the configured Realtime Profile to the calling thread (affinity and
+ *  scheduler) and to the process (memory locking and arena). Options which
+ *  can not be applied are logged and skipped.
+ *
+ *  When called from several threads of one process (single-process mode) the
+ *  process options are applied once (the other threads wait until they are
+ *  applied), and each thread is pinned to the next CPU (cpu, cpu+1, ...).
+ *
+ *  Parameters
+ *  ----------
+ *  name : const char*
+ *      Name of the thread/loop the profile is applied to (for logging).
+ *
+ *  Returns
+ *  -------
+ *      0 : The profile was applied (or is not enabled).
+ */
+DLL_PRIVATE int realtime_apply(const char* name)
+{
+    RealtimeProfile* rt = &__realtime;
+    if (rt->enabled == false) return 0;
+
+    uint32_t index = __atomic_fetch_add(&__thread_count, 1, __ATOMIC_SEQ_CST);
+    log_notice("Realtime Profile (%s):", name);
+#ifdef __linux__
+    pthread_once(&__process_once, _apply_process);
+    _prefault_stack(rt);
+    _apply_affinity(rt, index);
+    _apply_priority(rt);
+    if (index == 0) {
+        _probe_wakeup_latency(rt);
+        log_notice("  Wake-up latency: min=%" PRIu64 " ns, mean=%.0f ns, "
+                   "max=%" PRIu64 " ns",
+            rt->wakeup_min_ns, rt->wakeup_mean_ns, rt->wakeup_max_ns);
+    }
+#else
+    (void)index;
+    log_notice("  Realtime Profile not supported on this platform");
+#endif
+
+    return 0;
+}
+
+
+/**
+ *  realtime_prefault
+ *
+ *  Touch each page of a buffer so that page faults do not occur on the
+ *  realtime path (the content of the buffer is not modified).
+ *
+ *  Parameters
+ *  ----------
+ *  ptr : void*
+ *      Pointer to the buffer.
+ *  size : size_t
+ *      Size of the buffer.
+ */
+DLL_PRIVATE void realtime_prefault(void* ptr, size_t size)
+{
+    if (ptr == NULL || size == 0) return;
+
+    volatile uint8_t* p = ptr;
+    for (size_t i = 0; i < size; i += 4096) {
+        p[i] = p[i];
+    }
+    p[size - 1] = p[size - 1];
+}
+
+
+/**
+ *  realtime_calloc
+ *
+ *  Allocate zeroed signal storage, from the hugepage arena if it is active
+ *  and has capacity, otherwise with calloc(). Release with realtime_free().
+ */
+DLL_PRIVATE void* realtime_calloc(size_t nmemb, size_t size)
+{
+    size_t   len = nmemb * size;
+    uint8_t* base = __atomic_load_n(&__arena.base, __ATOMIC_ACQUIRE);
+    if (base && len) {
+        size_t current = __atomic_load_n(&__arena.offset, __ATOMIC_RELAXED);
+        while (1) {
+            size_t offset = (current + REALTIME_ALIGN - 1) &
+                            ~(size_t)(REALTIME_ALIGN - 1);
+            if (offset + len > __arena.size) break;
+            if (__atomic_compare_exchange_n(&__arena.offset, &current,
+                    offset + len, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                return &base[offset];
+            }
+        }
+    }
+    return calloc(nmemb, size);
+}
+
+
+/**
+ *  realtime_free
+ *
+ *  Release storage allocated by realtime_calloc(). Arena storage is released
+ *  when the process exits.
+ */
+DLL_PRIVATE void realtime_free(void* ptr)
+{
+    if (ptr == NULL) return;
+    uint8_t* p = ptr;
+    if (__arena.base && p >= __arena.base && p < __arena.base + __arena.size) {
+        return;
+    }
+    free(ptr);
+}
+
+
+DLL_PRIVATE void realtime_print(const char* name)
+{
+    RealtimeProfile* rt = &__realtime;
+    if (rt->enabled == false) return;
+
+    log_notice("Realtime Profile (%s):", name);
+    log_notice("  Affinity   : %s (cpu=%d)",
+        rt->affinity_applied ? "applied" : "not applied", rt->cpu);
+    log_notice("  Scheduler  : %s (policy=%s, priority=%d)",
+        rt->priority_applied ? "applied" : "not applied",
+        __policy_names[rt->policy], rt->priority);
+    log_notice(
+        "  mlockall   : %s", rt->mlock_applied ? "applied" : "not applied");
+    log_notice("  Arena      : %s (used %zu of %zu bytes)",
+        rt->hugepages_applied ? "applied" : "not applied", __arena.offset,
+        __arena.size);
+    log_notice("  Wake-up latency (%" PRIu64 " samples):", rt->wakeup_samples);
+    log_notice("    min  : %" PRIu64 " ns", rt->wakeup_min_ns);
+    log_notice("    mean : %.0f ns", rt->wakeup_mean_ns);
+    log_notice("    max  : %" PRIu64 " ns", rt->wakeup_max_ns);
+}
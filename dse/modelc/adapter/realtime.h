@@ -0,0 +1,88 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_REALTIME_H_
+#define DSE_MODELC_ADAPTER_REALTIME_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/platform.h>
+
+
+#define REALTIME_ANNOTATION       "realtime"
+#define REALTIME_ARENA_DEFAULT_MB 8
+#define REALTIME_PROBE_SAMPLES    200
+#define REALTIME_PROBE_PERIOD_NS  100000 /* 100 us */
+#define REALTIME_CPU_MAX          1023
+#define REALTIME_PRIORITY_MIN     1
+#define REALTIME_PRIORITY_MAX     99
+#define REALTIME_ARENA_MAX_MB     65536
+
+
+/*
+Realtime Execution Profile
+--------------------------
+
+Configured with a profile string, either from the CLI (--realtime) or from a
+Stack annotation (spec/models[]/annotations/realtime). The string is a comma
+separated list of options:
+
+    cpu=<n>         Pin the calling (bus loop/model step) thread to CPU <n>
+                    (0..1023). In single-process mode the SimBus and each
+                    Model thread are pinned to CPU <n>, <n+1>, ...
+    priority=<n>    Run the calling thread with realtime priority <n> (1..99).
+    policy=<p>      Realtime scheduling policy, fifo (default) or rr.
+    mlock           Lock (and pre-fault) all current and future memory.
+    hugepages       Back signal storage with a hugepage arena.
+    arena=<MB>      Size of the signal storage arena (default 8 MB).
+
+With a profile the signal storage and Adapter buffers are pre-faulted after
+registration. Transport buffers are owned (and grown) by the transport, they
+are only covered by mlock.
+
+Options with an invalid value are rejected (and not configured). Each option
+is applied independently. If an option cannot be applied (e.g. no privileges
+in a CI container) a notice is logged and operation continues.
+*/
+typedef enum RealtimePolicy {
+    REALTIME_POLICY_FIFO = 0, /* SCHED_FIFO */
+    REALTIME_POLICY_RR,       /* SCHED_RR */
+} RealtimePolicy;
+
+
+typedef struct RealtimeProfile {
+    bool     enabled;
+    /* Requested configuration. */
+    int32_t  cpu;      /* -1 : no affinity. */
+    int32_t  priority; /* 0 : no realtime scheduling. */
+    int32_t  policy;   /* RealtimePolicy. */
+    bool     mlock;
+    bool     hugepages;
+    size_t   arena_size;
+    /* Applied state. */
+    bool     affinity_applied;
+    bool     priority_applied;
+    bool     mlock_applied;
+    bool     hugepages_applied;
+    /* Wake-up latency, observed by the probe (ns). */
+    uint64_t wakeup_samples;
+    uint64_t wakeup_min_ns;
+    uint64_t wakeup_max_ns;
+    double   wakeup_mean_ns;
+} RealtimeProfile;
+
+
+/* realtime.c */
+DLL_PRIVATE int              realtime_configure(const char* spec);
+DLL_PRIVATE RealtimeProfile* realtime_profile(void);
+DLL_PRIVATE int              realtime_apply(const char* name);
+DLL_PRIVATE void             realtime_prefault(void* ptr, size_t size);
+DLL_PRIVATE void*            realtime_calloc(size_t nmemb, size_t size);
+DLL_PRIVATE void             realtime_free(void* ptr);
+DLL_PRIVATE void             realtime_print(const char* name);
+
+
+#endif  // DSE_MODELC_ADAPTER_REALTIME_H_
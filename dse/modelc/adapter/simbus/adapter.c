@@ -2,8 +2,11 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <time.h>
 #include <dse/logger.h>
 #include <dse/clib/collections/set.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
@@ -12,6 +15,7 @@
 #include <dse/modelc/adapter/adapter.h>
 #include <dse/modelc/adapter/private.h>
 #include <dse/modelc/adapter/message.h>
+#include <dse/modelc/adapter/realtime.h>
 
 
 #undef ns
@@ -21,6 +25,21 @@
 DLL_PRIVATE bool __simbus_exit_run_loop__;
 
 
+/* Change thresholds (deadband) by signal name, applied as signals are
+   created on the bus. */
+typedef struct SimbusDeadband {
+    double absolute;
+    double relative;
+} SimbusDeadband;
+
+static HashMap __deadband;
+static bool    __deadband_init = false;
+
+/* Multi-writer signals (by configuration), see handler.c (Forwarding). */
+static HashMap __multi_writer;
+static bool    __multi_writer_init = false;
+
+
 Adapter* simbus_adapter_create(Endpoint* endpoint, double bus_step_size)
 {
     /* Force the endpoint to kind SIMBUS. */
@@ -40,6 +59,8 @@ Adapter* simbus_adapter_create(Endpoint* endpoint, double bus_step_size)
     adapter->bus_step_size = bus_step_size;
     v->handle_message = simbus_handle_message;
     v->handle_notify_message = simbus_handle_notify_message;
+    /* SignalVector encoding, may be reduced at ModelRegister. */
+    adapter->sv_encoding = sv_encoding_default();
 
     /* Create the Adapter Model object. */
     adapter->bus_adapter_model = calloc(1, sizeof(AdapterModel));
@@ -96,11 +117,79 @@ void simbus_adapter_init_channel(
     for (uint32_t si = 0; si < ch->index.count; si++) {
         SignalValue* sv = _get_signal_value_byindex(ch, si);
         sv->uid = simbus_generate_uid_hash(sv->name);
+        simbus_deadband_apply(sv);
+        simbus_writer_apply(sv);
         log_simbus("    [%u] uid=%u, name=%s", si, sv->uid, sv->name);
     }
 }
 
 
+void simbus_adapter_set_deadband(
+    const char* signal_name, double absolute, double relative)
+{
+    assert(signal_name);
+    if (absolute == 0.0 && relative == 0.0) return;
+    if (__deadband_init == false) {
+        hashmap_init(&__deadband);
+        __deadband_init = true;
+    }
+    SimbusDeadband* db = malloc(sizeof(SimbusDeadband));
+    *db = (SimbusDeadband){ .absolute = absolute, .relative = relative };
+    hashmap_set_alt(&__deadband, signal_name, db);
+    log_simbus("    Deadband: %s (absolute=%f, relative=%f)", signal_name,
+        absolute, relative);
+}
+
+
+void simbus_deadband_apply(SignalValue* sv)
+{
+    if (__deadband_init == false) return;
+    SimbusDeadband* db = hashmap_get(&__deadband, sv->name);
+    if (db == NULL) return;
+    sv->deadband = db->absolute;
+    sv->deadband_relative = db->relative;
+}
+
+
+void simbus_adapter_set_multi_writer(const char* signal_name)
+{
+    assert(signal_name);
+    if (__multi_writer_init == false) {
+        hashmap_init(&__multi_writer);
+        __multi_writer_init = true;
+    }
+    hashmap_set_long(&__multi_writer, signal_name, 1);
+    log_simbus("    Writer: %s (multi)", signal_name);
+}
+
+
+void simbus_writer_apply(SignalValue* sv)
+{
+    if (__multi_writer_init == false) return;
+    if (hashmap_get(&__multi_writer, sv->name) == NULL) return;
+    sv->multi_writer = true;
+}
+
+
+static void _write_stats(Adapter* adapter, const char* path)
+{
+    /* Write a temporary file and rename, readers always see a complete
+       report. */
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* f = fopen(tmp, "w");
+    if (f == NULL) {
+        log_error("Statistics file could not be written: %s", tmp);
+        return;
+    }
+    fprintf(f, "SimBus Channel Statistics (bus_time=%f)\n", adapter->bus_time);
+    adapter_model_dump_stats(adapter->bus_adapter_model, "SimBus", f);
+    simbus_profile_dump_critical_path(f);
+    fclose(f);
+    rename(tmp, path);
+}
+
+
 void simbus_adapter_run(Adapter* adapter)
 {
     assert(adapter);
@@ -109,8 +198,18 @@ void simbus_adapter_run(Adapter* adapter)
 
     if (endpoint->start) endpoint->start(endpoint);
 
+    /* Realtime Profile (bus loop runs on this thread). */
+    realtime_apply("SimBus");
+
+    /* Memory accounting, on-demand report (SIGUSR1). */
+    memstat_install_handler();
+
     __simbus_exit_run_loop__ = false;
 
+    /* Channel statistics, periodic report (see simbus --stats). */
+    const char* stats_path = getenv(ENV_SIMBUS_STATSFILE);
+    time_t      stats_time = time(NULL);
+
     while (true) {
         const char* _msg_channel_name = NULL;
         bool        found = false; /* Found result is ignored. */
@@ -118,11 +217,38 @@ void simbus_adapter_run(Adapter* adapter)
             adapter, &_msg_channel_name, ns(MessageType_NONE), 0, &found);
 
         if (__simbus_exit_run_loop__) break;
+        if (memstat_dump_requested()) {
+            memstat_print("SimBus");
+            adapter_model_dump_memory(adapter->bus_adapter_model, "SimBus");
+            log_notice("Channel Statistics:");
+            adapter_model_dump_stats(
+                adapter->bus_adapter_model, "SimBus", NULL);
+            simbus_profile_dump_critical_path(NULL);
+        }
+        if (stats_path && time(NULL) - stats_time >= SIMBUS_STATS_PERIOD) {
+            _write_stats(adapter, stats_path);
+            stats_time = time(NULL);
+        }
     }
 
     log_simbus("exit run loop");
 
     /* Benchmarking/Profiling. */
     simbus_profile_print_benchmarks();
+    simbus_lookahead_destroy();
+    memstat_print("SimBus");
+    adapter_model_dump_memory(adapter->bus_adapter_model, "SimBus");
+    log_notice("Channel Statistics:");
+    adapter_model_dump_stats(adapter->bus_adapter_model, "SimBus", NULL);
+    if (stats_path) _write_stats(adapter, stats_path);
     simbus_profile_destroy();
+    if (__deadband_init) {
+        hashmap_destroy(&__deadband);
+        __deadband_init = false;
+    }
+    if (__multi_writer_init) {
+        hashmap_destroy(&__multi_writer);
+        __multi_writer_init = false;
+    }
+    realtime_print("SimBus");
 }
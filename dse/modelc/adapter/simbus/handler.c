@@ -6,8 +6,12 @@
 #include <dse/logger.h>
 #include <dse/clib/util/strings.h>
 #include <dse/modelc/adapter/simbus/simbus_private.h>
+#include <dse/modelc/adapter/encoding.h>
 #include <dse/modelc/adapter/private.h>
+#include <dse/modelc/adapter/probe.h>
+#include <dse/modelc/adapter/timeline.h>
 #include <dse/modelc/adapter/timer.h>
+#include <dse/modelc/adapter/tracelog.h>
 #include <dse/modelc/adapter/message.h>
 
 
@@ -22,7 +26,11 @@ static uint32_t _process_signal_lookup(Channel* ch, const char* signal_name)
 
     /* Search for signal name, if missing will be created. */
     SignalValue* sv = _get_signal_value(ch, signal_name);
-    if (sv->uid == 0) sv->uid = simbus_generate_uid_hash(sv->name);
+    if (sv->uid == 0) {
+        sv->uid = simbus_generate_uid_hash(sv->name);
+        simbus_deadband_apply(sv);
+        simbus_writer_apply(sv);
+    }
     log_simbus("    SignalLookup: %s [UID=%u]", signal_name, sv->uid);
     return sv->uid;
 }
@@ -184,6 +192,7 @@ static void process_signal_read_message(Adapter* adapter, Channel* channel,
     }
     /* 2st Object in root Array, list of Values. */
     msgpack_pack_array(&pk, read_signal_count);
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
     for (uint32_t i = 0; i < read_signal_count; i++) {
         uint32_t _uid = uid_obj.via.array.ptr[i].via.u64;
         if (_uid) {
@@ -202,11 +211,16 @@ static void process_signal_read_message(Adapter* adapter, Channel* channel,
                  * from all connected models (via embedded SignalWrite message).
                  */
                 msgpack_pack_bin_with_body(&pk, sv->bin, 0);
-                log_simbus("    SignalWrite: %u = <binary> (len=%u) [name=%s]",
-                    sv->uid, 0, sv->name);
+                if (trace) {
+                    tracelog_signal(TRACELOG_FMT_SIGNAL_WRITE_BIN, sv->uid, 0,
+                        0, 0, sv->name);
+                }
             } else {
                 msgpack_pack_double(&pk, sv->val);
-                log_simbus("    uid=%u, val=%f", _uid, sv->val);
+                if (trace) {
+                    tracelog_signal(TRACELOG_FMT_SIGNAL_READ, _uid, sv->val, 0,
+                        0, sv->name);
+                }
             }
         }
     }
@@ -230,17 +244,161 @@ error_clean_up:
 }
 
 
-static void process_signalvector(
-    Channel* channel, flatbuffers_uint8_vec_t data_vector)
+/*
+Forwarding (single-writer signals)
+----------------------------------
+
+Most signals have exactly one writer (e.g. ECU to ECU signals). When all
+signals written to a channel in a cycle are scalar single-writer signals
+(without a deadband) the deltas of the writers are held, and forwarded with
+the Notify: the delta of a single writer verbatim (V1 encoding), or the deltas
+merged (V2 encoding). Only the written signals are then resolved, the channel
+is not re-encoded. Otherwise the channel is encoded and resolved as usual.
+
+Signals are classified by the writes observed on the bus, a write by a
+second Model marks a signal as multi-writer, or by configuration (SignalGroup
+annotation `writer: multi`).
+*/
+
+static void forward_reset(Channel* channel)
+{
+    channel->forward.valid = true;
+    channel->forward.length = 0;
+    channel->forward.count = 0;
+    channel->forward.written_count = 0;
+}
+
+
+static void forward_hold(Channel* channel, uint32_t model_uid,
+    uint32_t written, const uint8_t* data, size_t length)
+{
+    /* Classify the signals written by this delta. */
+    bool eligible = true;
+    for (uint32_t i = written; i < channel->forward.written_count; i++) {
+        SignalValue* sv = channel->forward.written[i];
+        if (sv->writer_uid == 0) sv->writer_uid = model_uid;
+        if (sv->writer_uid != model_uid && sv->multi_writer == false) {
+            log_simbus("    multi-writer: %s (model_uid=%u,%u)", sv->name,
+                sv->writer_uid, model_uid);
+            sv->multi_writer = true;
+        }
+        if (sv->multi_writer || sv->bin_size) eligible = false;
+        if (sv->deadband != 0.0 || sv->deadband_relative != 0.0) {
+            eligible = false;
+        }
+    }
+    if (channel->forward.valid == false) return;
+    if (eligible == false || data == NULL) goto invalid;
+    if (written == channel->forward.written_count) return; /* Empty delta. */
+
+    /* Hold the delta. */
+    uint32_t encoding = sv_encoding_is_v2(data, length) ? SV_ENCODING_V2
+                                                        : SV_ENCODING_V1;
+    if (channel->forward.count && channel->forward.encoding != encoding) {
+        goto invalid;
+    }
+    if (channel->forward.count == channel->forward.capacity) {
+        uint32_t capacity =
+            channel->forward.capacity ? channel->forward.capacity * 2 : 8;
+        void* p =
+            realloc(channel->forward.offset, capacity * sizeof(uint32_t));
+        if (p == NULL) goto invalid;
+        channel->forward.offset = p;
+        channel->forward.capacity = capacity;
+    }
+    if (channel->forward.length + length > channel->forward.size) {
+        uint32_t size = channel->forward.size ? channel->forward.size : 1024;
+        while (size < channel->forward.length + length) size *= 2;
+        void* p = realloc(channel->forward.data, size);
+        if (p == NULL) goto invalid;
+        channel->forward.data = p;
+        channel->forward.size = size;
+    }
+    memcpy(channel->forward.data + channel->forward.length, data, length);
+    channel->forward.offset[channel->forward.count++] =
+        channel->forward.length;
+    channel->forward.length += length;
+    channel->forward.encoding = encoding;
+    return;
+
+invalid:
+    channel->forward.valid = false;
+}
+
+
+static bool forward_encode(Adapter* adapter, Channel* channel,
+    msgpack_sbuffer* sbuf, msgpack_packer* pk, uint8_t** data,
+    size_t* length)
+{
+    AdapterMsgVTable* v = (AdapterMsgVTable*)adapter->vtable;
+
+    if (channel->forward.valid == false) return false;
+    if (channel->forward.count &&
+        channel->forward.encoding != adapter->sv_encoding) {
+        return false;
+    }
+
+    if (adapter->sv_encoding == SV_ENCODING_V2) {
+        if (sv_merge_v2(&v->sv_buffer, channel->forward.data,
+                channel->forward.offset, channel->forward.count,
+                channel->forward.length) != 0) {
+            return false;
+        }
+        *data = v->sv_buffer.data;
+        *length = v->sv_buffer.length;
+    } else if (channel->forward.count == 1) {
+        *data = channel->forward.data;
+        *length = channel->forward.length;
+    } else if (channel->forward.count == 0) {
+        /* Empty delta. */
+        msgpack_sbuffer_clear(sbuf);
+        msgpack_pack_array(pk, 2);
+        msgpack_pack_array(pk, 0);
+        msgpack_pack_array(pk, 0);
+        *data = (uint8_t*)sbuf->data;
+        *length = sbuf->size;
+    } else {
+        /* Several writers, V1 deltas are not merged. */
+        return false;
+    }
+    log_simbus("SignalVector --> [%s] (forward, %u deltas)", channel->name,
+        channel->forward.count);
+    channel->stats.signals_changed += channel->forward.written_count;
+
+    return true;
+}
+
+
+static void forward_resolve(Channel* channel)
+{
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
+    for (uint32_t i = 0; i < channel->forward.written_count; i++) {
+        SignalValue* sv = channel->forward.written[i];
+        sv->val = sv->final_val;
+        sv->tx_val = sv->final_val;
+        if (trace) {
+            tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, sv->uid, sv->final_val,
+                0, 0, sv->name);
+        }
+    }
+}
+
+
+static int decode_signalvector(
+    Channel* channel, const uint8_t* data_vector, size_t length)
 {
     /* Decode the MsgPack payload: data:[ubyte] = [[UID:0..N],[Value:0..N]] */
     if (data_vector == NULL) {
         log_simbus(
             "WARNING: data vector could not be obtained SignalWrite message!");
-        return;
+        return -1;
+    }
+    /* Or the V2 encoding (native arrays). */
+    if (sv_encoding_is_v2(data_vector, length)) {
+        return sv_decode_v2(channel, data_vector, length, true);
     }
-    size_t           length = flatbuffers_uint8_vec_len(data_vector);
     /* Unpack. */
+    int              rc = -1;
     bool             result;
     msgpack_unpacker unpacker;
     // 4 is COUNTER_SIZE.
@@ -303,6 +461,7 @@ static void process_signalvector(
 
     /* Update the SignalValue for each included Signal UID:Value pair. */
     uint32_t write_signal_count = uid_obj.via.array.size;
+    bool     trace = tracelog_enabled(TRACELOG_SIGNAL);
     for (uint32_t i = 0; i < write_signal_count; i++) {
         uint32_t    _uid = uid_obj.via.array.ptr[i].via.u64;
         double      _value = 0;
@@ -336,23 +495,48 @@ static void process_signalvector(
         }
         if (_bin_size) {
             /* Binary. */
-            dse_buffer_append(&sv->bin, &sv->bin_size, &sv->bin_buffer_size,
-                _bin_ptr, _bin_size);
-            log_simbus("    SignalValue: %u = <binary> (len=%u) [name=%s]",
-                _uid, sv->bin_size, sv->name);
+            _signal_value_bin_append(channel, sv, _bin_ptr, _bin_size);
+            _signal_value_written(channel, sv);
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, _uid, 0, 0,
+                    sv->bin_size, sv->name);
+            }
         } else {
             /* Double. */
             sv->final_val =
                 _value; /* Reset final_val (changes will trigger SignalWrite) */
-            log_simbus("    SignalWrite: %u = %f [name=%s, prev=%f]", _uid,
-                sv->final_val, sv->name, sv->val);
+            _signal_value_written(channel, sv);
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_WRITE_PREV, _uid,
+                    sv->final_val, sv->val, 0, sv->name);
+            }
         }
     }
+    rc = 0;
 
 error_clean_up:
     /* Unpack: Cleanup. */
     msgpack_unpacked_destroy(&unpacked);
     msgpack_unpacker_destroy(&unpacker);
+    return rc;
+}
+
+
+static void process_signalvector(Channel* channel, uint32_t model_uid,
+    const uint8_t* data_vector, size_t length, bool forward)
+{
+    uint32_t        written = channel->forward.written_count;
+    struct timespec ts = get_timespec_now();
+    int             rc = decode_signalvector(channel, data_vector, length);
+    channel->stats.decode_ns += get_elapsedtime_ns(ts);
+    channel->stats.bytes_decoded += length;
+    if (channel->forward.written_count > written) {
+        channel->stats.writers++;
+        channel->stats.writers_step++;
+    }
+    /* Classify the written signals, hold the delta for forwarding. */
+    forward_hold(channel, model_uid, written,
+        (forward && rc == 0) ? data_vector : NULL, length);
 }
 
 
@@ -360,7 +544,6 @@ static void process_signal_write_message(Adapter* adapter, Channel* channel,
     uint32_t model_uid, ns(SignalWrite_table_t) signal_write_table)
 {
     UNUSED(adapter);
-    UNUSED(model_uid);
 
     if (!ns(SignalWrite_data_is_present(signal_write_table))) {
         log_simbus("WARNING: no data in SignalWrite message!");
@@ -375,7 +558,8 @@ static void process_signal_write_message(Adapter* adapter, Channel* channel,
             "WARNING: data vector could not be obtained SignalWrite message!");
         return;
     }
-    process_signalvector(channel, data_vector);
+    process_signalvector(channel, model_uid, data_vector,
+        flatbuffers_uint8_vec_len(data_vector), false);
 }
 
 
@@ -402,7 +586,6 @@ static void process_notify_signalvector(Adapter* adapter, Channel* channel,
     uint32_t model_uid, notify(SignalVector_table_t) signal_vector)
 {
     UNUSED(adapter);
-    UNUSED(model_uid);
 
     /* Handle SignalVector. */
     if (!notify(SignalVector_data_is_present(signal_vector))) {
@@ -418,7 +601,249 @@ static void process_notify_signalvector(Adapter* adapter, Channel* channel,
             "WARNING: data vector could not be obtained SignalVector table!");
         return;
     }
-    process_signalvector(channel, data_vector);
+    process_signalvector(channel, model_uid, data_vector,
+        flatbuffers_uint8_vec_len(data_vector), true);
+}
+
+
+/*
+Lookahead
+---------
+
+A model with lookahead may step ahead of the bus, its ModelReady (Notify) then
+carries a model_time beyond the next bus cycle. The SignalVector of such a
+message is held (copied) and applied when the bus reaches that model_time,
+the model is marked as ready at that point.
+
+The lookahead (K) of each model is agreed at ModelRegister, bounded by the
+SimBus (bus_lookahead), and limits how far ahead the model may be: a
+ModelReady is expected up to bus_time + (K+1) * step_size (the next cycle plus
+K steps). A ModelReady beyond the agreed bound is an error (the model did not
+honour the agreement), it is still held until its own model_time (and never
+applied at a bus time it was not computed for).
+*/
+
+typedef struct LookaheadFrame {
+    double   model_time;
+    Channel* channel;
+    uint32_t model_uid;
+    uint8_t* data;
+    size_t   length;
+} LookaheadFrame;
+
+
+typedef struct ModelBound {
+    uint32_t model_uid;
+    uint32_t lookahead; /* Agreed at ModelRegister (steps). */
+    uint32_t batch;     /* Agreed at ModelRegister (steps, 0 = disabled). */
+} ModelBound;
+
+
+static struct {
+    LookaheadFrame* frames;
+    uint32_t        count;
+    uint32_t        size;
+    ModelBound*     bound;
+    uint32_t        bound_count;
+} __lookahead = { 0 };
+
+
+static ModelBound* model_bound(uint32_t model_uid)
+{
+    for (uint32_t i = 0; i < __lookahead.bound_count; i++) {
+        if (__lookahead.bound[i].model_uid == model_uid) {
+            return &__lookahead.bound[i];
+        }
+    }
+    return NULL;
+}
+
+
+static void model_bound_set(
+    uint32_t model_uid, uint32_t lookahead, uint32_t batch)
+{
+    ModelBound* b = model_bound(model_uid);
+    if (b == NULL) {
+        void* p = memstat_realloc(MEMSTAT_SIMBUS, __lookahead.bound,
+            (__lookahead.bound_count + 1) * sizeof(ModelBound));
+        if (p == NULL) {
+            log_error("Model bound realloc failed!");
+            return;
+        }
+        __lookahead.bound = p;
+        b = &__lookahead.bound[__lookahead.bound_count++];
+    }
+    *b = (ModelBound){
+        .model_uid = model_uid,
+        .lookahead = lookahead,
+        .batch = batch,
+    };
+}
+
+
+static bool lookahead_hold_frame(double model_time, Channel* channel,
+    uint32_t model_uid, const uint8_t* data, size_t length)
+{
+    if (__lookahead.count == __lookahead.size) {
+        uint32_t size = __lookahead.size ? __lookahead.size * 2 : 16;
+        void* p = memstat_realloc(MEMSTAT_SIMBUS, __lookahead.frames,
+            size * sizeof(LookaheadFrame));
+        if (p == NULL) {
+            log_error("Lookahead frame realloc failed!");
+            return false;
+        }
+        __lookahead.frames = p;
+        __lookahead.size = size;
+    }
+    LookaheadFrame* f = &__lookahead.frames[__lookahead.count++];
+    *f = (LookaheadFrame){
+        .model_time = model_time,
+        .channel = channel,
+        .model_uid = model_uid,
+        .data = memstat_malloc(MEMSTAT_SIMBUS, length ? length : 1),
+        .length = length,
+    };
+    if (length) memcpy(f->data, data, length);
+    log_simbus("    lookahead: held until model_time=%f", model_time);
+
+    return true;
+}
+
+
+static bool lookahead_hold(Adapter* adapter, double model_time,
+    Channel* channel, uint32_t model_uid, notify(SignalVector_table_t) sv)
+{
+    /* The model_time of a ModelReady which is in time for the next cycle. */
+    double ready_time = adapter->bus_time + adapter->bus_step_size;
+    if (model_time <= ready_time + (adapter->bus_step_size / 2)) return false;
+
+    /* The agreed bound, a frame beyond is held (not re-timestamped). */
+    ModelBound* b = model_bound(model_uid);
+    uint32_t    lookahead = b ? b->lookahead : 0;
+    double      bound_time =
+        ready_time + (lookahead * adapter->bus_step_size);
+    if (model_time > bound_time + (adapter->bus_step_size / 2)) {
+        log_error("Model %u exceeds the lookahead bound (%u steps), "
+                  "model_time=%f, bus_time=%f",
+            model_uid, lookahead, model_time, adapter->bus_time);
+    }
+
+    /* Hold a copy of the SignalVector data. */
+    flatbuffers_uint8_vec_t data_vector = notify(SignalVector_data(sv));
+    size_t length = data_vector ? flatbuffers_uint8_vec_len(data_vector) : 0;
+    return lookahead_hold_frame(
+        model_time, channel, model_uid, data_vector, length);
+}
+
+
+/*
+Batch
+-----
+
+A Model with a batch factor runs several steps per Notify, the SignalVector
+then carries the timestamped deltas of each step (see encoding.h). A delta in
+time for the next cycle is applied (and the model is marked as ready), the
+following deltas are held (as lookahead frames) and applied at their
+model_time. The batch factor agreed at ModelRegister (bounded by bus_batch)
+limits how far ahead a delta may be, a delta beyond is an error and is held
+until its own model_time (as for lookahead).
+*/
+
+static bool batch_process(Adapter* adapter, Channel* channel,
+    uint32_t model_uid, notify(SignalVector_table_t) sv)
+{
+    flatbuffers_uint8_vec_t data_vector = notify(SignalVector_data(sv));
+    size_t length = data_vector ? flatbuffers_uint8_vec_len(data_vector) : 0;
+    if (!sv_encoding_is_batch(data_vector, length)) return false;
+
+    ModelBound*    b = model_bound(model_uid);
+    uint32_t       batch = b ? b->batch : 0;
+    double         ready_time = adapter->bus_time + adapter->bus_step_size;
+    double         bound_time = ready_time + (batch * adapter->bus_step_size);
+    bool           ready = false;
+    size_t         offset = 0;
+    double         model_time;
+    const uint8_t* delta;
+    uint32_t       delta_length;
+    while (sv_batch_next(data_vector, length, &offset, &model_time, &delta,
+               &delta_length) > 0) {
+        log_simbus("    batch: model_time=%f", model_time);
+        if (model_time <= ready_time + (adapter->bus_step_size / 2)) {
+            process_signalvector(
+                channel, model_uid, delta, delta_length, true);
+            ready = true;
+            continue;
+        }
+        if (model_time > bound_time + (adapter->bus_step_size / 2)) {
+            log_error("Model %u exceeds the batch bound (%u steps), "
+                      "model_time=%f, bus_time=%f",
+                model_uid, batch, model_time, adapter->bus_time);
+        }
+        lookahead_hold_frame(
+            model_time, channel, model_uid, delta, delta_length);
+    }
+    if (ready) {
+        simbus_model_at_ready(adapter->bus_adapter_model, channel, model_uid);
+    }
+
+    return true;
+}
+
+
+static uint32_t lookahead_release(Adapter* adapter)
+{
+    AdapterModel* am = adapter->bus_adapter_model;
+    double        ready_time = adapter->bus_time + adapter->bus_step_size;
+    uint32_t      released = 0;
+    uint32_t      j = 0;
+
+    for (uint32_t i = 0; i < __lookahead.count; i++) {
+        LookaheadFrame* f = &__lookahead.frames[i];
+        if (f->model_time > ready_time + (adapter->bus_step_size / 2)) {
+            __lookahead.frames[j++] = *f;
+            continue;
+        }
+        log_simbus("SignalVector <-- [%s:%u] (lookahead)", f->channel->name,
+            f->model_uid);
+        log_simbus("    model_time=%f", f->model_time);
+        process_signalvector(
+            f->channel, f->model_uid, f->data, f->length, true);
+        simbus_model_at_ready(am, f->channel, f->model_uid);
+        memstat_free(MEMSTAT_SIMBUS, f->data);
+        released++;
+    }
+    __lookahead.count = j;
+
+    return released;
+}
+
+
+static void lookahead_drop(uint32_t model_uid)
+{
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < __lookahead.count; i++) {
+        LookaheadFrame* f = &__lookahead.frames[i];
+        if (f->model_uid == model_uid) {
+            memstat_free(MEMSTAT_SIMBUS, f->data);
+        } else {
+            __lookahead.frames[j++] = *f;
+        }
+    }
+    __lookahead.count = j;
+}
+
+
+void simbus_lookahead_destroy(void)
+{
+    for (uint32_t i = 0; i < __lookahead.count; i++) {
+        memstat_free(MEMSTAT_SIMBUS, __lookahead.frames[i].data);
+    }
+    memstat_free(MEMSTAT_SIMBUS, __lookahead.frames);
+    memstat_free(MEMSTAT_SIMBUS, __lookahead.bound);
+    __lookahead.frames = NULL;
+    __lookahead.count = __lookahead.size = 0;
+    __lookahead.bound = NULL;
+    __lookahead.bound_count = 0;
 }
 
 
@@ -432,32 +857,40 @@ static void sv_delta_to_msgpack(Channel* channel, msgpack_packer* pk)
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
-        if ((sv->val != sv->final_val) || (sv->bin && sv->bin_size)) {
+        if ((sv->bin && sv->bin_size) || _signal_value_changed(sv)) {
             changed_signal_count++;
         }
     }
+    channel->stats.signals_changed += changed_signal_count;
     /* 1st Object in root Array, list of UID's. */
     msgpack_pack_array(pk, changed_signal_count);
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
-        if ((sv->val != sv->final_val) || (sv->bin && sv->bin_size)) {
+        if ((sv->bin && sv->bin_size) || _signal_value_changed(sv)) {
             msgpack_pack_uint32(pk, sv->uid);
         }
     }
     /* 2st Object in root Array, list of Values. */
     msgpack_pack_array(pk, changed_signal_count);
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
         if (sv->bin && sv->bin_size) {
             msgpack_pack_bin_with_body(pk, sv->bin, sv->bin_size);
-            log_simbus("    SignalValue: %u = <binary> (len=%u) [name=%s]",
-                sv->uid, sv->bin_size, sv->name);
-        } else if (sv->val != sv->final_val) {
+            channel->stats.binary_bytes += sv->bin_size;
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, sv->uid, 0, 0,
+                    sv->bin_size, sv->name);
+            }
+        } else if (_signal_value_changed(sv)) {
             msgpack_pack_double(pk, sv->final_val);
-            log_simbus("    SignalValue: %u = %f [name=%s]", sv->uid,
-                sv->final_val, sv->name);
+            sv->tx_val = sv->final_val;
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, sv->uid,
+                    sv->final_val, 0, 0, sv->name);
+            }
         }
     }
 }
@@ -491,24 +924,51 @@ static void resolve_and_notify(
     log_simbus("    schedule_time=%f", schedule_time);
 
     /* SignalVector vector. */
+    uint64_t timeline_ts = timeline_begin();
     notify(SignalVector_vec_start(builder));
     for (uint32_t i = 0; i < am->channels_length; i++) {
         Channel* ch = _get_channel_byindex(am, i);
         _refresh_index(ch);
 
-        msgpack_sbuffer_clear(&sbuf);
-        sv_delta_to_msgpack(ch, &pk);
-        resolve_channel(ch);
+        uint8_t*        data = NULL;
+        size_t          length = 0;
+        struct timespec ts = get_timespec_now();
+        if (forward_encode(adapter, ch, &sbuf, &pk, &data, &length)) {
+            forward_resolve(ch);
+        } else {
+            if (adapter->sv_encoding == SV_ENCODING_V2) {
+                log_simbus("SignalVector --> [%s]", ch->name);
+                if (sv_encode_v2(ch, &v->sv_buffer, true) == 0) {
+                    data = v->sv_buffer.data;
+                    length = v->sv_buffer.length;
+                }
+            } else {
+                msgpack_sbuffer_clear(&sbuf);
+                sv_delta_to_msgpack(ch, &pk);
+                data = (uint8_t*)sbuf.data;
+                length = sbuf.size;
+            }
+            resolve_channel(ch);
+        }
+        forward_reset(ch);
+
+        /* Statistics. */
+        ch->stats.encode_ns += get_elapsedtime_ns(ts);
+        ch->stats.bytes_encoded += length;
+        ch->stats.cycles++;
+        if (ch->stats.writers_step > ch->stats.writers_max) {
+            ch->stats.writers_max = ch->stats.writers_step;
+        }
+        ch->stats.writers_step = 0;
 
         flatbuffers_string_ref_t sv_name =
             flatbuffers_string_create_str(builder, ch->name);
-        flatbuffers_uint8_vec_ref_t sv_msgpack_data =
-            flatbuffers_uint8_vec_create(
-                builder, (uint8_t*)sbuf.data, sbuf.size);
+        flatbuffers_uint8_vec_ref_t sv_data =
+            flatbuffers_uint8_vec_create(builder, data, length);
         notify(SignalVector_ref_t) sv =
-            notify(SignalVector_create(builder, sv_name, 0, sv_msgpack_data));
+            notify(SignalVector_create(builder, sv_name, 0, sv_data));
         notify(SignalVector_vec_push(builder, sv));
-        log_simbus("    data payload: %lu bytes", sbuf.size);
+        log_simbus("    data payload: %lu bytes", length);
     }
     notify(SignalVector_vec_ref_t) signals =
         notify(SignalVector_vec_end(builder));
@@ -519,7 +979,10 @@ static void resolve_and_notify(
     notify(NotifyMessage_model_time_add(builder, model_time));
     notify(NotifyMessage_schedule_time_add(builder, schedule_time));
     notify(NotifyMessage_ref_t) message = notify(NotifyMessage_end(builder));
+    timeline_end(TIMELINE_ENCODE, 0, model_time, timeline_ts);
+    timeline_ts = timeline_begin();
     send_notify_message(adapter, message);
+    timeline_end(TIMELINE_SEND, 0, model_time, timeline_ts);
     msgpack_sbuffer_destroy(&sbuf);
 }
 
@@ -558,17 +1021,22 @@ static void resolve_channel_and_model_start(
     }
     /* 2st Object in root Array, list of Values. */
     msgpack_pack_array(&pk, changed_signal_count);
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
     for (uint32_t i = 0; i < channel->index.count; i++) {
         SignalValue* sv = channel->index.map[i].signal;
         if (sv->uid == 0) continue;
         if (sv->bin && sv->bin_size) {
             msgpack_pack_bin_with_body(&pk, sv->bin, sv->bin_size);
-            log_simbus("    SignalValue: %u = <binary> (len=%u) [name=%s]",
-                sv->uid, sv->bin_size, sv->name);
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE_BIN, sv->uid, 0, 0,
+                    sv->bin_size, sv->name);
+            }
         } else if (sv->val != sv->final_val) {
             msgpack_pack_double(&pk, sv->final_val);
-            log_simbus("    SignalValue: %u = %f [name=%s]", sv->uid,
-                sv->final_val, sv->name);
+            if (trace) {
+                tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, sv->uid,
+                    sv->final_val, 0, 0, sv->name);
+            }
         }
     }
     log_simbus("    data payload: %lu bytes", sbuf.size);
@@ -579,6 +1047,7 @@ static void resolve_channel_and_model_start(
         sv->val = sv->final_val;
         sv->bin_size = 0;
     }
+    forward_reset(channel);
 
     /* Send ModelStart with SignalValue. */
     for (uint32_t i = 0; i < channel->model_ready_set->number_nodes; i++) {
@@ -612,6 +1081,41 @@ static void resolve_channel_and_model_start(
 }
 
 
+static void resolve_bus(Adapter* adapter)
+{
+    AdapterModel* am = adapter->bus_adapter_model;
+
+    /**
+    Time on the Bus is progressed according to Bus Cycle Time.
+
+    Increment the bus time via Kahan summation.
+    */
+    double y = adapter->bus_step_size - adapter->bus_time_correction;
+    double t = adapter->bus_time + y;
+    adapter->bus_time_correction = (t - adapter->bus_time) - y;
+    adapter->bus_time = t;
+
+    double model_time = adapter->bus_time;
+    double stop_time = model_time + adapter->bus_step_size;
+
+    /* Benchmarking/Profiling. */
+    if (adapter->bus_time > 0.0) {
+        struct timespec ref_ts = get_timespec_now();
+        uint64_t        simbus_cycle_total_ns =
+            get_deltatime_ns(adapter->bench_notifysend_ts, ref_ts);
+        simbus_profile_accumulate_cycle_total(simbus_cycle_total_ns, ref_ts);
+    }
+    adapter->bench_notifysend_ts = get_timespec_now();
+
+    /* Notify/ModelStart. */
+    uint64_t timeline_ts = timeline_begin();
+    PROBE1(bus_resolve, PROBE_NS(model_time));
+    resolve_and_notify(adapter, model_time, stop_time);
+    PROBE1(bus_notify_sent, PROBE_NS(model_time));
+    simbus_models_to_start(am);
+    timeline_end(TIMELINE_RESOLVE, 0, model_time, timeline_ts);
+}
+
 void simbus_handle_notify_message(
     Adapter* adapter, notify(NotifyMessage_table_t) notify_message)
 {
@@ -619,6 +1123,9 @@ void simbus_handle_notify_message(
 
     /* Notify meta information. */
     double model_time = notify(NotifyMessage_model_time(notify_message));
+    PROBE2(bus_notify_recv, PROBE_NS(model_time),
+        notify(SignalVector_vec_len(
+            notify(NotifyMessage_signals(notify_message)))));
     log_simbus("Notify/ModelReady <--");
     log_simbus("    model_time=%f", model_time);
 
@@ -663,7 +1170,16 @@ void simbus_handle_notify_message(
         log_simbus("SignalVector <-- [%s:%u]", channel_name, model_uid);
 
         Channel* channel = hashmap_get(&am->channels, channel_name);
+        if (batch_process(adapter, channel, model_uid, signal_vector)) {
+            continue;
+        }
+        if (lookahead_hold(
+                adapter, model_time, channel, model_uid, signal_vector)) {
+            continue;
+        }
+        uint64_t timeline_ts = timeline_begin();
         process_notify_signalvector(adapter, channel, model_uid, signal_vector);
+        timeline_end(TIMELINE_DECODE, model_uid, model_time, timeline_ts);
         simbus_model_at_ready(am, channel, model_uid);
     }
 
@@ -672,32 +1188,12 @@ void simbus_handle_notify_message(
         /**
         This condition will exist when the last model on the last channel
         sends its ModelReady message. When that happens, resolve the bus.
-
-        Time on the Bus is progressed according to Bus Cycle Time.
-
-        Increment the bus time via Kahan summation.
+        Held (lookahead) frames may complete the following cycles, in which
+        case the bus is resolved again.
         */
-        double y = adapter->bus_step_size - adapter->bus_time_correction;
-        double t = adapter->bus_time + y;
-        adapter->bus_time_correction = (t - adapter->bus_time) - y;
-        adapter->bus_time = t;
-
-        double model_time = adapter->bus_time;
-        double stop_time = model_time + adapter->bus_step_size;
-
-        /* Benchmarking/Profiling. */
-        if (adapter->bus_time > 0.0) {
-            struct timespec ref_ts = get_timespec_now();
-            uint64_t        simbus_cycle_total_ns =
-                get_deltatime_ns(adapter->bench_notifysend_ts, ref_ts);
-            simbus_profile_accumulate_cycle_total(
-                simbus_cycle_total_ns, ref_ts);
-        }
-        adapter->bench_notifysend_ts = get_timespec_now();
-
-        /* Notify/ModelStart. */
-        resolve_and_notify(adapter, model_time, stop_time);
-        simbus_models_to_start(am);
+        do {
+            resolve_bus(adapter);
+        } while (lookahead_release(adapter) && simbus_models_ready(am));
     }
 }
 
@@ -737,6 +1233,44 @@ void simbus_handle_message(Adapter* adapter, const char* channel_name,
         log_simbus("    step_size=%f", ns(ModelRegister_step_size(t)));
         log_simbus("    token=%d", token);
 
+        /* SignalVector encoding, V2 only if all Models support V2. */
+        const char* info = NULL;
+        if (ns(ChannelMessage_response_is_present(channel_message))) {
+            info = ns(ChannelMessage_response(channel_message));
+            log_simbus("    info=%s", info);
+        }
+        if (adapter->sv_encoding == SV_ENCODING_V2 &&
+            sv_info_value(info, SV_INFO_ENCODING) != SV_ENCODING_V2) {
+            log_notice("Model %u does not support SignalVector encoding V2, "
+                       "using V1",
+                model_uid);
+            adapter->sv_encoding = SV_ENCODING_V1;
+        }
+
+        /* Lookahead and batch factor, bounded by the SimBus (the agreed
+           values are the ACK response, no response disables both). */
+        char     sv_response[SV_INFO_LEN] = "";
+        uint32_t lookahead = sv_info_value(info, SV_INFO_LOOKAHEAD);
+        if (lookahead > adapter->bus_lookahead) {
+            lookahead = adapter->bus_lookahead;
+        }
+        uint32_t batch = sv_info_value(info, SV_INFO_BATCH);
+        if (batch > adapter->bus_batch) batch = adapter->bus_batch;
+        if (batch < 2) batch = 0;
+        if (lookahead) {
+            snprintf(sv_response, sizeof(sv_response), "%s=%u",
+                SV_INFO_LOOKAHEAD, lookahead);
+            log_simbus("    lookahead=%u", lookahead);
+        }
+        if (batch) {
+            size_t len = strlen(sv_response);
+            snprintf(sv_response + len, sizeof(sv_response) - len,
+                "%s%s=%u", len ? ";" : "", SV_INFO_BATCH, batch);
+            log_simbus("    batch=%u", batch);
+        }
+        if (sv_response[0]) response = sv_response;
+        model_bound_set(model_uid, lookahead, batch);
+
         /* Count the number of ModelRegisters. Keep in mind that this message
         will be sent from a model on all channels, therefore the number of
         ModelRegister messages may exceed the number of models.
@@ -824,6 +1358,7 @@ void simbus_handle_message(Adapter* adapter, const char* channel_name,
         log_simbus("ModelExit <-- [%s]", channel->name);
         log_simbus("    model_uid=%d", model_uid);
 
+        lookahead_drop(model_uid);
         simbus_model_at_exit(am, channel, model_uid);
     }
     /* Unexpected message? */
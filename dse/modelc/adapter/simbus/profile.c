@@ -2,7 +2,10 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
 #include <dse/logger.h>
 #include <dse/clib/collections/hashmap.h>
 #include <dse/modelc/adapter/timer.h>
@@ -41,11 +44,35 @@ Time(SP) = Total - Model Total - SW
 __Total__ (Total Time)
 : The total time.
 
+
+Critical Path
+-------------
+
+For each bus cycle the Model whose Notify arrived last (the straggler) is
+recorded, the bus could not resolve until that Model was ready. Models which
+share a Notify (e.g. a stacked ModelC) share an arrival time, when that
+Notify arrives last the cycle is attributed to each Model of the group (the
+CP of all Models may then sum to more than 100%).
+
+__CP__ (Critical Path)
+: Percentage of bus cycles where the Model arrived last.
+
+__Gap__ (Critical Gap)
+: Average time (us) between the previous (earlier) arrival and the Model,
+  when it arrived last. This is the (approximate) reduction of the cycle time
+  if the Model (or its group) was faster.
+
+__Slack__ (Slack Histogram)
+: The time (us) between the arrival of the Model and the last arrival, per
+  cycle, as a log2 histogram (bin <N counts cycles with slack less than N us).
+  A Model with a large slack is not on the critical path.
+
 */
 
 
 #define UNUSED(x)          ((void)x)
 #define UINT32_STR_MAX_LEN 11
+#define SLACK_BINS         16 /* log2(us), the last bin is >= 16.384 ms. */
 
 
 typedef struct ModelBenchmarkProfile {
@@ -74,18 +101,27 @@ typedef struct ModelBenchmarkProfile {
     double   ma_simbus_wait;
     double   ma_simbus_proc;
     double   ma_total;
+
+    /* Critical Path. */
+    bool            arrived; /* Notify received in this cycle. */
+    struct timespec arrival_ts;
+    uint64_t        critical_count;
+    uint64_t        critical_gap_ns;
+    uint64_t        slack_hist[SLACK_BINS];
 } ModelBenchmarkProfile;
 
 
 static HashMap  __model_data;
 static uint32_t __accumulate_sample_count;
 static uint32_t __accumulate_on_sample;
+static uint64_t __critical_cycle_count;
 
 
 void simbus_profile_init(double bus_step_size)
 {
     hashmap_init_alt(&__model_data, 64, NULL);
     __accumulate_on_sample = 1.0 / bus_step_size;
+    __critical_cycle_count = 0;
 }
 
 
@@ -189,6 +225,84 @@ void simbus_profile_accumulate_model_part(uint32_t model_uid, uint64_t me,
 
     /* Set reference time for simbus part. */
     mbp->wait_ref_ts = ref_ts;
+
+    /* Arrival (critical path). */
+    mbp->arrived = true;
+    mbp->arrival_ts = ref_ts;
+}
+
+
+typedef struct CriticalPathData {
+    bool            has_last;
+    bool            has_second;
+    struct timespec last_ts;
+    struct timespec second_ts; /* Latest arrival before last_ts. */
+} CriticalPathData;
+
+static inline bool _ts_after(struct timespec a, struct timespec b)
+{
+    if (a.tv_sec != b.tv_sec) return a.tv_sec > b.tv_sec;
+    return a.tv_nsec > b.tv_nsec;
+}
+
+static int _find_critical(void* map_item, void* additional_data)
+{
+    ModelBenchmarkProfile* mbp = map_item;
+    CriticalPathData*      data = additional_data;
+    if (mbp->arrived == false) return 0;
+
+    if (data->has_last == false || _ts_after(mbp->arrival_ts, data->last_ts)) {
+        if (data->has_last) {
+            data->second_ts = data->last_ts;
+            data->has_second = true;
+        }
+        data->has_last = true;
+        data->last_ts = mbp->arrival_ts;
+    } else if (_ts_after(data->last_ts, mbp->arrival_ts)) {
+        if (data->has_second == false ||
+            _ts_after(mbp->arrival_ts, data->second_ts)) {
+            data->second_ts = mbp->arrival_ts;
+            data->has_second = true;
+        }
+    }
+    return 0;
+}
+
+static int _acc_critical(void* map_item, void* additional_data)
+{
+    ModelBenchmarkProfile* mbp = map_item;
+    CriticalPathData*      data = additional_data;
+    if (mbp->arrived == false) return 0;
+
+    /* The last arrival (or group of, sharing a Notify), and its lead over
+       the previous arrival. */
+    if (_ts_after(data->last_ts, mbp->arrival_ts) == false) {
+        mbp->critical_count++;
+        if (data->has_second) {
+            mbp->critical_gap_ns +=
+                get_deltatime_ns(data->second_ts, data->last_ts);
+        }
+    }
+
+    uint64_t slack_us = get_deltatime_ns(mbp->arrival_ts, data->last_ts) / 1000;
+    uint32_t bin = 0;
+    while (slack_us && bin < SLACK_BINS - 1) {
+        slack_us >>= 1;
+        bin++;
+    }
+    mbp->slack_hist[bin]++;
+    mbp->arrived = false;
+    return 0;
+}
+
+static void _accumulate_critical_path(void)
+{
+    CriticalPathData data = { 0 };
+    hashmap_iterator(&__model_data, _find_critical, false, &data);
+    if (data.has_last == false) return;
+
+    __critical_cycle_count++;
+    hashmap_iterator(&__model_data, _acc_critical, false, &data);
 }
 
 
@@ -235,6 +349,7 @@ void simbus_profile_accumulate_cycle_total(
         .ref_ts = ref_ts,
     };
     hashmap_iterator(&__model_data, _acc_simbus_part, false, &data);
+    _accumulate_critical_path();
 }
 
 
@@ -288,6 +403,64 @@ static int _print_benchmark_sam(void* map_item, void* additional_data)
     return 0;
 }
 
+static int _dump_critical_path(void* map_item, void* additional_data)
+{
+    ModelBenchmarkProfile* mbp = map_item;
+    FILE*                  file = additional_data;
+    char                   line[512];
+    double                 n = __critical_cycle_count;
+
+    int len = snprintf(line, sizeof(line), "  %-9u  %-7.2f %-10.1f",
+        mbp->model_uid, mbp->critical_count * 100.0 / n,
+        mbp->critical_count
+            ? mbp->critical_gap_ns / 1000.0 / mbp->critical_count
+            : 0.0);
+    for (uint32_t i = 0; i < SLACK_BINS; i++) {
+        if (mbp->slack_hist[i] == 0) continue;
+        if (len < 0 || (size_t)len >= sizeof(line)) break;
+        if (i == SLACK_BINS - 1) {
+            len += snprintf(line + len, sizeof(line) - len, " >=%u:%" PRIu64,
+                1u << (i - 1), mbp->slack_hist[i]);
+        } else {
+            len += snprintf(line + len, sizeof(line) - len, " <%u:%" PRIu64,
+                1u << i, mbp->slack_hist[i]);
+        }
+    }
+    if (file) {
+        fprintf(file, "%s\n", line);
+    } else {
+        log_notice("%s", line);
+    }
+    return 0;
+}
+
+/**
+ *  simbus_profile_dump_critical_path
+ *
+ *  Print (or write to a file) the critical path attribution of each Model,
+ *  see Critical Path (above).
+ *
+ *  Parameters
+ *  ----------
+ *  file : FILE*
+ *      Write the report to this file, NULL to log the report.
+ */
+void simbus_profile_dump_critical_path(FILE* file)
+{
+    const char* header = "  model_uid  CP(%)   Gap(us)    Slack(us):cycles";
+    if (file) {
+        fprintf(file, " Critical Path: (cycles=%" PRIu64 ")\n%s\n",
+            __critical_cycle_count, header);
+    } else {
+        log_notice(
+            " Critical Path: (cycles=%" PRIu64 ")", __critical_cycle_count);
+        log_notice("%s", header);
+    }
+    if (__critical_cycle_count == 0) return;
+    hashmap_iterator(&__model_data, _dump_critical_path, false, file);
+}
+
+
 void simbus_profile_print_benchmarks(void)
 {
     log_notice("Profile/Benchmark Data:");
@@ -303,4 +476,6 @@ void simbus_profile_print_benchmarks(void)
     log_notice("  model_uid  ME          MP          NET         SW          "
                "SP       Total");
     hashmap_iterator(&__model_data, _print_benchmark_sam, false, NULL);
+    simbus_profile_dump_critical_path(NULL);
 }
+
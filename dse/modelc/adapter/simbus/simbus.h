@@ -15,6 +15,11 @@
 #include <dse/modelc/runtime.h>
 
 
+/* Channel statistics, written periodically by the SimBus (when set). */
+#define ENV_SIMBUS_STATSFILE "SIMBUS_STATSFILE"
+#define SIMBUS_STATS_PERIOD  1 /* Seconds. */
+
+
 typedef struct SimbusVector {
     HashMap   index;  // map{signal:uint32_t} -> index to vectors
     uint32_t  count;
@@ -46,6 +51,9 @@ DLL_PUBLIC Adapter* simbus_adapter_create(Endpoint* endpoint, double bus_step_si
 DLL_PUBLIC void     simbus_adapter_init_channel(
         AdapterModel* am, const char* channel_name, uint32_t expected_model_count);
 DLL_PUBLIC void simbus_adapter_run(Adapter* adapter);
+DLL_PUBLIC void simbus_adapter_set_deadband(
+    const char* signal_name, double absolute, double relative);
+DLL_PUBLIC void simbus_adapter_set_multi_writer(const char* signal_name);
 
 /* adapter_loopb.c (in parent directory) */
 DLL_PUBLIC SimbusVectorIndex simbus_vector_lookup(
@@ -6,6 +6,7 @@
 #define DSE_MODELC_ADAPTER_SIMBUS_SIMBUS_PRIVATE_H_
 
 
+#include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
@@ -26,6 +27,8 @@
 
 /* adapter.c */
 DLL_PRIVATE uint32_t simbus_generate_uid_hash(const char* key);
+DLL_PRIVATE void     simbus_deadband_apply(SignalValue* sv);
+DLL_PRIVATE void     simbus_writer_apply(SignalValue* sv);
 
 
 /* handler.c */
@@ -34,6 +37,7 @@ DLL_PRIVATE void simbus_handle_message(Adapter* adapter,
     int32_t     token);
 DLL_PRIVATE void simbus_handle_notify_message(
     Adapter* adapter, notify(NotifyMessage_table_t) notify_message);
+DLL_PRIVATE void simbus_lookahead_destroy(void);
 
 
 /* profile.c */
@@ -43,6 +47,7 @@ DLL_PRIVATE void simbus_profile_accumulate_model_part(uint32_t model_uid,
 DLL_PRIVATE void simbus_profile_accumulate_cycle_total(
     uint64_t simbus_cycle_total_ns, struct timespec ref_ts);
 DLL_PRIVATE void simbus_profile_print_benchmarks(void);
+DLL_PRIVATE void simbus_profile_dump_critical_path(FILE* file);
 DLL_PRIVATE void simbus_profile_destroy(void);
 
 
@@ -0,0 +1,269 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/timeline.h>
+
+
+#define TIMELINE_PATH_LEN   1024
+#define TIMELINE_NAME_LEN   64
+#define TIMELINE_MAX_TRACKS 256
+#define TIMELINE_WAIT_NS    10000 /* 10 us */
+
+
+DLL_PRIVATE bool __timeline_enabled__ = false;
+
+
+/* Span names, indexed by TimelineSpan. */
+static const char* __spans[__TIMELINE_SPAN_COUNT__] = {
+    [TIMELINE_STEP] = "step",
+    [TIMELINE_MARSHAL_IN] = "marshal_in",
+    [TIMELINE_MARSHAL_OUT] = "marshal_out",
+    [TIMELINE_ENCODE] = "encode",
+    [TIMELINE_SEND] = "send",
+    [TIMELINE_WAIT] = "wait",
+    [TIMELINE_DECODE] = "decode",
+    [TIMELINE_RESOLVE] = "resolve",
+};
+
+
+typedef struct Timeline {
+    TimelineRecord* records;
+    uint32_t        capacity;
+    uint64_t        index; /* Next record, taken atomically. */
+    uint32_t        open_count;
+    char            path[TIMELINE_PATH_LEN];
+    char            name[TIMELINE_NAME_LEN];
+} Timeline;
+
+
+static Timeline        __timeline = { 0 };
+static pthread_mutex_t __open_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Threads in timeline_record() (see timeline_close()), not reset with the
+   timeline. */
+static uint32_t        __writers = 0;
+
+
+/**
+ *  timeline_open
+ *
+ *  Allocate the timeline buffer and enable recording. Only one timeline is
+ *  supported per process, further calls (e.g. the Adapter of an inproc
+ *  SimBus) share the open timeline, which is written by the last call to
+ *  timeline_close().
+ *
+ *  Parameters
+ *  ----------
+ *  path : const char*
+ *      Path prefix of the timeline file.
+ *  name : const char*
+ *      Process name (e.g. "simbus"), included in the file name.
+ *  capacity : uint32_t
+ *      Number of records in the buffer.
+ *
+ *  Returns
+ *  -------
+ *      0 : The timeline is recording.
+ *      -1 : The timeline could not be opened (errno is set).
+ */
+DLL_PRIVATE int timeline_open(
+    const char* path, const char* name, uint32_t capacity)
+{
+    pthread_mutex_lock(&__open_lock);
+    if (__timeline.open_count) {
+        __timeline.open_count++;
+        pthread_mutex_unlock(&__open_lock);
+        return 0;
+    }
+
+    errno = 0;
+    __timeline = (Timeline){ 0 };
+    if (capacity == 0) {
+        log_error("Timeline capacity not valid!");
+        goto error_clean_up;
+    }
+    __timeline.records = calloc(capacity, sizeof(TimelineRecord));
+    if (__timeline.records == NULL) {
+        log_error("Timeline buffer malloc failed!");
+        goto error_clean_up;
+    }
+    __timeline.capacity = capacity;
+    snprintf(__timeline.path, TIMELINE_PATH_LEN, "%s.%s.%d.json", path, name,
+        (int)getpid());
+    snprintf(__timeline.name, TIMELINE_NAME_LEN, "%s", name);
+    __timeline.open_count = 1;
+    __atomic_store_n(&__timeline_enabled__, true, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&__open_lock);
+    log_notice("Timeline: %s (records=%u)", __timeline.path, capacity);
+
+    return 0;
+
+error_clean_up:
+    __timeline = (Timeline){ 0 };
+    pthread_mutex_unlock(&__open_lock);
+    if (errno == 0) errno = EINVAL;
+    return -1;
+}
+
+
+DLL_PRIVATE void timeline_open_env(const char* name)
+{
+    const char* path = getenv(ENV_SIMBUS_TIMELINE);
+    if (path == NULL || strlen(path) == 0) return;
+
+    uint32_t    capacity = TIMELINE_RECORDS;
+    const char* _env = getenv(ENV_SIMBUS_TIMELINE_RECORDS);
+    if (_env) capacity = strtoul(_env, NULL, 0);
+    timeline_open(path, name, capacity);
+}
+
+
+static void _write_metadata(FILE* file, int pid, TimelineRecord* records,
+    uint32_t count, const char* name)
+{
+    uint32_t tracks[TIMELINE_MAX_TRACKS];
+    uint32_t track_count = 0;
+
+    fprintf(file,
+        "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"tid\":0,"
+        "\"args\":{\"name\":\"%s (%d)\"}},\n",
+        pid, name, pid);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t uid = records[i].uid;
+        bool     found = false;
+        for (uint32_t t = 0; t < track_count; t++) {
+            if (tracks[t] == uid) {
+                found = true;
+                break;
+            }
+        }
+        if (found || track_count == TIMELINE_MAX_TRACKS) continue;
+        tracks[track_count++] = uid;
+        if (uid == 0) {
+            fprintf(file,
+                "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+                "\"tid\":0,\"args\":{\"name\":\"simbus\"}},\n",
+                pid);
+        } else {
+            fprintf(file,
+                "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+                "\"tid\":%u,\"args\":{\"name\":\"model:%u\"}},\n",
+                pid, uid, uid);
+        }
+    }
+}
+
+
+static int _write_chrome_json(Timeline* tl, uint32_t count, uint64_t dropped)
+{
+    FILE* file = fopen(tl->path, "w");
+    if (file == NULL) {
+        log_error("Timeline file could not be opened: %s", tl->path);
+        return -1;
+    }
+
+    int pid = (int)getpid();
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{"
+                  "\"name\":\"%s\",\"dropped\":%" PRIu64 "},\n",
+        tl->name, dropped);
+    fprintf(file, "\"traceEvents\":[\n");
+    _write_metadata(file, pid, tl->records, count, tl->name);
+    for (uint32_t i = 0; i < count; i++) {
+        TimelineRecord* r = &tl->records[i];
+        /* Timestamps are microseconds (with ns resolution). */
+        fprintf(file,
+            "{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"modelc\",\"pid\":%d,"
+            "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"time\":%.9g}}"
+            "%s\n",
+            __spans[r->span], pid, r->uid, r->begin_ns / 1000.0,
+            (r->end_ns - r->begin_ns) / 1000.0, r->time,
+            (i + 1 < count) ? "," : "");
+    }
+    /* The metadata entries are each followed by a comma. */
+    if (count == 0) {
+        fprintf(file, "{\"ph\":\"M\",\"name\":\"process_sort_index\","
+                      "\"pid\":%d,\"tid\":0,\"args\":{\"sort_index\":0}}\n",
+            pid);
+    }
+    fprintf(file, "]}\n");
+    fclose(file);
+    return 0;
+}
+
+
+/**
+ *  timeline_close
+ *
+ *  Stop recording and write the timeline file (Chrome Trace Event JSON). The
+ *  file is written by the last call, see timeline_open(). Recording is
+ *  disabled, then the call waits for writers (other threads) which are still
+ *  in timeline_record() before the buffer is written and released.
+ */
+DLL_PRIVATE void timeline_close(void)
+{
+    pthread_mutex_lock(&__open_lock);
+    if (__timeline.open_count == 0 || --__timeline.open_count) {
+        pthread_mutex_unlock(&__open_lock);
+        return;
+    }
+
+    __atomic_store_n(&__timeline_enabled__, false, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&__writers, __ATOMIC_SEQ_CST)) {
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = TIMELINE_WAIT_NS };
+        nanosleep(&ts, NULL);
+    }
+    uint64_t index = __atomic_load_n(&__timeline.index, __ATOMIC_ACQUIRE);
+    uint32_t count = __timeline.capacity;
+    uint64_t dropped = 0;
+    if (index > __timeline.capacity) {
+        dropped = index - __timeline.capacity;
+    } else {
+        count = (uint32_t)index;
+    }
+    if (_write_chrome_json(&__timeline, count, dropped) == 0) {
+        log_notice("Timeline: %s (%u records)", __timeline.path, count);
+    }
+    if (dropped) log_notice("Timeline: %" PRIu64 " records dropped", dropped);
+    free(__timeline.records);
+    __timeline = (Timeline){ 0 };
+    pthread_mutex_unlock(&__open_lock);
+}
+
+
+/**
+ *  timeline_record
+ *
+ *  Record a span. Called via timeline_end(), the record is dropped if the
+ *  buffer is full. The writer is counted (and recording is checked again),
+ *  so that timeline_close() does not release the buffer while it is written.
+ */
+DLL_PRIVATE void timeline_record(TimelineSpan span, uint32_t uid, double time,
+    uint64_t begin_ns, uint64_t end_ns)
+{
+    __atomic_add_fetch(&__writers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&__timeline_enabled__, __ATOMIC_SEQ_CST)) {
+        uint64_t index =
+            __atomic_fetch_add(&__timeline.index, 1, __ATOMIC_RELAXED);
+        if (index < __timeline.capacity) {
+            __timeline.records[index] = (TimelineRecord){
+                .begin_ns = begin_ns,
+                .end_ns = end_ns,
+                .time = time,
+                .uid = uid,
+                .span = span,
+            };
+        }
+    }
+    __atomic_sub_fetch(&__writers, 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,111 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_TIMELINE_H_
+#define DSE_MODELC_ADAPTER_TIMELINE_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/modelc/adapter/timer.h>
+#include <dse/platform.h>
+
+
+#define ENV_SIMBUS_TIMELINE         "SIMBUS_TIMELINE"
+#define ENV_SIMBUS_TIMELINE_RECORDS "SIMBUS_TIMELINE_RECORDS"
+#define TIMELINE_RECORDS            (1 << 18)
+
+
+/*
+Timeline Recorder
+-----------------
+
+Records spans (begin/end on the monotonic clock) of the phases of each bus
+cycle into a preallocated per-process buffer. The buffer is written, when the
+Adapter is destroyed, as a Chrome Trace Event (JSON) file which can be loaded
+by Perfetto (ui.perfetto.dev) or chrome://tracing:
+
+    <SIMBUS_TIMELINE>.<name>.<pid>.json
+
+Each span records the simulation time of the cycle (i.e. the bus cycle
+which the span belongs to) and the model_uid (the track, 0 for the SimBus).
+The files of several processes are combined with:
+
+    $ python3 extra/tools/timeline/merge.py -o sim.json sim.*.json
+
+Spans are recorded from the bus and adapter threads (which may be in the same
+process), the record index (64 bit) is taken atomically. When the buffer is
+full, further records are counted as dropped. The buffer is released by
+timeline_close() after the writers have left timeline_record().
+
+    uint64_t begin = timeline_begin();
+    ...
+    timeline_end(TIMELINE_ENCODE, am->model_uid, am->model_time, begin);
+
+Configuration (environment):
+    SIMBUS_TIMELINE : Path prefix of the timeline file (enables recording).
+    SIMBUS_TIMELINE_RECORDS : Buffer size (records, default 262144).
+*/
+typedef enum TimelineSpan {
+    TIMELINE_STEP = 0,
+    TIMELINE_MARSHAL_IN,
+    TIMELINE_MARSHAL_OUT,
+    TIMELINE_ENCODE,
+    TIMELINE_SEND,
+    TIMELINE_WAIT,
+    TIMELINE_DECODE,
+    TIMELINE_RESOLVE,
+    __TIMELINE_SPAN_COUNT__,
+} TimelineSpan;
+
+
+typedef struct TimelineRecord {
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    double   time;
+    uint32_t uid;
+    uint16_t span;
+} TimelineRecord;
+
+
+DLL_PRIVATE extern bool __timeline_enabled__;
+
+
+/* timeline.c */
+DLL_PRIVATE int  timeline_open(
+    const char* path, const char* name, uint32_t capacity);
+DLL_PRIVATE void timeline_open_env(const char* name);
+DLL_PRIVATE void timeline_close(void);
+DLL_PRIVATE void timeline_record(TimelineSpan span, uint32_t uid, double time,
+    uint64_t begin_ns, uint64_t end_ns);
+
+
+static inline uint64_t timeline_now(void)
+{
+    struct timespec ts = get_timespec_now();
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t timeline_begin(void)
+{
+    if (__atomic_load_n(&__timeline_enabled__, __ATOMIC_RELAXED) == false) {
+        return 0;
+    }
+    return timeline_now();
+}
+
+/* The enabled check is repeated (with the writer counted) by
+   timeline_record(). */
+static inline void timeline_end(
+    TimelineSpan span, uint32_t uid, double time, uint64_t begin_ns)
+{
+    if (__atomic_load_n(&__timeline_enabled__, __ATOMIC_RELAXED) == false ||
+        begin_ns == 0) {
+        return;
+    }
+    timeline_record(span, uid, time, begin_ns, timeline_now());
+}
+
+
+#endif  // DSE_MODELC_ADAPTER_TIMELINE_H_
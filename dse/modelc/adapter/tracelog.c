@@ -0,0 +1,299 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/tracelog.h>
+
+
+#define TRACELOG_IDLE_NS  1000000 /* 1 ms */
+#define TRACELOG_PATH_LEN 1024
+
+
+DLL_PRIVATE uint32_t __tracelog_mask__ = 0;
+DLL_PRIVATE bool     __tracelog_ring__ = false;
+
+
+/* Format table, indexed by TraceLogFormat. */
+static const char* __formats[__TRACELOG_FMT_COUNT__] = {
+    [TRACELOG_FMT_SIGNAL_WRITE] = "    SignalWrite: %u = %f [name=%s]",
+    [TRACELOG_FMT_SIGNAL_WRITE_BIN] =
+        "    SignalWrite: %u = <binary> (len=%u) [name=%s]",
+    [TRACELOG_FMT_SIGNAL_WRITE_PREV] =
+        "    SignalWrite: %u = %f [name=%s, prev=%f]",
+    [TRACELOG_FMT_SIGNAL_VALUE] = "    SignalValue: %u = %f [name=%s]",
+    [TRACELOG_FMT_SIGNAL_VALUE_BIN] =
+        "    SignalValue: %u = <binary> (len=%u) [name=%s]",
+    [TRACELOG_FMT_SIGNAL_READ] = "    uid=%u, val=%f",
+};
+
+
+/* Ring slot, seq indicates the state of the slot (bounded MPSC queue):
+     seq == pos      : free, may be reserved by a producer for position pos.
+     seq == pos + 1  : written, may be consumed.
+   The consumer releases a slot for the next lap (pos + RECORDS). */
+typedef struct TraceLogSlot {
+    uint32_t       seq;
+    TraceLogRecord record;
+} TraceLogSlot;
+
+
+typedef struct TraceLogRing {
+    TraceLogSlot* slots;
+    uint32_t      head; /* Reserved by the producers (CAS). */
+    uint32_t      tail; /* Written by the consumer (background thread). */
+    uint64_t      dropped;
+    FILE*         file;
+    pthread_t     thread;
+    bool          stop_request;
+} TraceLogRing;
+
+
+static TraceLogRing    __ring = { 0 };
+/* Adapters which opened the trace log, the last close releases it. */
+static uint32_t        __open_count = 0;
+static pthread_mutex_t __open_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void _format_record(FILE* file, TraceLogRecord* r)
+{
+    const char* fmt = __formats[r->format];
+    switch (r->format) {
+    case TRACELOG_FMT_SIGNAL_WRITE_BIN:
+    case TRACELOG_FMT_SIGNAL_VALUE_BIN:
+        fprintf(file, fmt, r->uid, r->len, r->name);
+        break;
+    case TRACELOG_FMT_SIGNAL_WRITE_PREV:
+        fprintf(file, fmt, r->uid, r->value, r->name, r->prev);
+        break;
+    case TRACELOG_FMT_SIGNAL_READ:
+        fprintf(file, fmt, r->uid, r->value);
+        break;
+    default:
+        fprintf(file, fmt, r->uid, r->value, r->name);
+        break;
+    }
+    fputc('\n', file);
+}
+
+
+static uint32_t _drain(TraceLogRing* ring)
+{
+    uint32_t tail = ring->tail;
+    uint32_t count = 0;
+    while (1) {
+        TraceLogSlot* s = &ring->slots[tail & (TRACELOG_RING_RECORDS - 1)];
+        uint32_t      seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (seq != tail + 1) break; /* Not (yet) written. */
+        _format_record(ring->file, &s->record);
+        __atomic_store_n(
+            &s->seq, tail + TRACELOG_RING_RECORDS, __ATOMIC_RELEASE);
+        tail++;
+        count++;
+    }
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    return count;
+}
+
+
+static void* _tracelog_thread(void* arg)
+{
+    TraceLogRing*   ring = arg;
+    struct timespec idle = { .tv_sec = 0, .tv_nsec = TRACELOG_IDLE_NS };
+
+    while (__atomic_load_n(&ring->stop_request, __ATOMIC_ACQUIRE) == false) {
+        if (_drain(ring) == 0) {
+            fflush(ring->file);
+            nanosleep(&idle, NULL);
+        }
+    }
+    _drain(ring);
+    fflush(ring->file);
+    return NULL;
+}
+
+
+/**
+ *  tracelog_open
+ *
+ *  Open the trace file and start the background formatting thread. One trace
+ *  log is supported per process, the trace file of each process has the
+ *  process id as suffix (i.e. `<path>.<pid>`). Each Adapter of the process
+ *  opens (and closes) the trace log, the Adapters (bus and model threads)
+ *  are the producers.
+ *
+ *  Parameters
+ *  ----------
+ *  path : const char*
+ *      Path of the trace file (without the process id suffix).
+ *  mask : uint32_t
+ *      Enabled categories (TraceLogCategory).
+ *
+ *  Returns
+ *  -------
+ *      0 : The trace log is running.
+ *      -1 : The trace log could not be started (errno is set).
+ */
+DLL_PRIVATE int tracelog_open(const char* path, uint32_t mask)
+{
+    char _path[TRACELOG_PATH_LEN];
+
+    pthread_mutex_lock(&__open_lock);
+    if (__open_count) {
+        __open_count++;
+        pthread_mutex_unlock(&__open_lock);
+        return 0;
+    }
+
+    errno = 0;
+    __ring = (TraceLogRing){ 0 };
+    snprintf(_path, sizeof(_path), "%s.%d", path, (int)getpid());
+    __ring.file = fopen(_path, "w");
+    if (__ring.file == NULL) {
+        log_error("Trace log file could not be opened: %s", _path);
+        goto error_clean_up;
+    }
+    __ring.slots = calloc(TRACELOG_RING_RECORDS, sizeof(TraceLogSlot));
+    if (__ring.slots == NULL) {
+        log_error("Trace log ring malloc failed!");
+        goto error_clean_up;
+    }
+    for (uint32_t i = 0; i < TRACELOG_RING_RECORDS; i++) {
+        __ring.slots[i].seq = i;
+    }
+    if (pthread_create(&__ring.thread, NULL, _tracelog_thread, &__ring)) {
+        log_error("Trace log thread could not be started!");
+        goto error_clean_up;
+    }
+    __tracelog_mask__ = mask;
+    __atomic_store_n(&__tracelog_ring__, true, __ATOMIC_RELEASE);
+    __open_count = 1;
+    pthread_mutex_unlock(&__open_lock);
+    log_notice("Trace log: %s (mask=0x%04x)", _path, mask);
+
+    return 0;
+
+error_clean_up:
+    if (__ring.file) fclose(__ring.file);
+    if (__ring.slots) free(__ring.slots);
+    __ring = (TraceLogRing){ 0 };
+    pthread_mutex_unlock(&__open_lock);
+    if (errno == 0) errno = EINVAL;
+    return -1;
+}
+
+
+DLL_PRIVATE void tracelog_open_env(void)
+{
+    const char* path = getenv(ENV_SIMBUS_TRACEFILE);
+    if (path == NULL || strlen(path) == 0) return;
+
+    uint32_t    mask = TRACELOG_ALL;
+    const char* _env = getenv(ENV_SIMBUS_TRACEMASK);
+    if (_env) mask = strtoul(_env, NULL, 0);
+    tracelog_open(path, mask);
+}
+
+
+/**
+ *  tracelog_close
+ *
+ *  Close the trace log (opened by an Adapter). The last close stops the
+ *  background thread and releases the ring, it must only be called after all
+ *  producers have stopped (i.e. each Adapter closes the trace log after its
+ *  last tracelog_signal() call, see adapter_destroy()).
+ */
+DLL_PRIVATE void tracelog_close(void)
+{
+    pthread_mutex_lock(&__open_lock);
+    if (__open_count == 0 || --__open_count) {
+        pthread_mutex_unlock(&__open_lock);
+        return;
+    }
+
+    __atomic_store_n(&__tracelog_ring__, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&__ring.stop_request, true, __ATOMIC_RELEASE);
+    pthread_join(__ring.thread, NULL);
+    if (__ring.dropped) {
+        fprintf(__ring.file,
+            "Trace log: %" PRIu64 " records dropped (ring full)\n",
+            __ring.dropped);
+        log_notice("Trace log: %" PRIu64 " records dropped", __ring.dropped);
+    }
+    fclose(__ring.file);
+    free(__ring.slots);
+    __ring = (TraceLogRing){ 0 };
+    pthread_mutex_unlock(&__open_lock);
+}
+
+
+/**
+ *  tracelog_signal
+ *
+ *  Record a signal trace. With a running trace log the record is pushed to
+ *  the ring (dropped if the ring is full), otherwise it is formatted
+ *  immediately with log_simbus(). May be called from several threads.
+ */
+DLL_PRIVATE void tracelog_signal(TraceLogFormat format, uint32_t uid,
+    double value, double prev, uint32_t len, const char* name)
+{
+    if (__atomic_load_n(&__tracelog_ring__, __ATOMIC_ACQUIRE) == false) {
+        switch (format) {
+        case TRACELOG_FMT_SIGNAL_WRITE_BIN:
+        case TRACELOG_FMT_SIGNAL_VALUE_BIN:
+            log_simbus(__formats[format], uid, len, name);
+            break;
+        case TRACELOG_FMT_SIGNAL_WRITE_PREV:
+            log_simbus(__formats[format], uid, value, name, prev);
+            break;
+        case TRACELOG_FMT_SIGNAL_READ:
+            log_simbus(__formats[format], uid, value);
+            break;
+        default:
+            log_simbus(__formats[format], uid, value, name);
+            break;
+        }
+        return;
+    }
+
+    /* Reserve a slot. */
+    TraceLogSlot* s;
+    uint32_t      pos = __atomic_load_n(&__ring.head, __ATOMIC_RELAXED);
+    while (1) {
+        s = &__ring.slots[pos & (TRACELOG_RING_RECORDS - 1)];
+        uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        int32_t  diff = (int32_t)(seq - pos);
+        if (diff < 0) {
+            /* Full, the slot is not consumed (from the previous lap). */
+            __atomic_add_fetch(&__ring.dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        if (diff == 0 && __atomic_compare_exchange_n(&__ring.head, &pos,
+                             pos + 1, true, __ATOMIC_RELAXED,
+                             __ATOMIC_RELAXED)) {
+            break;
+        }
+        if (diff > 0) pos = __atomic_load_n(&__ring.head, __ATOMIC_RELAXED);
+    }
+
+    /* Write the record, then publish the slot. */
+    s->record = (TraceLogRecord){
+        .format = format,
+        .uid = uid,
+        .len = len,
+        .value = value,
+        .prev = prev,
+        .name = name,
+    };
+    __atomic_store_n(&s->seq, pos + 1, __ATOMIC_RELEASE);
+}
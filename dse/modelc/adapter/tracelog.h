@@ -0,0 +1,93 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_TRACELOG_H_
+#define DSE_MODELC_ADAPTER_TRACELOG_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/logger.h>
+#include <dse/platform.h>
+
+
+#define ENV_SIMBUS_TRACEFILE  "SIMBUS_TRACEFILE"
+#define ENV_SIMBUS_TRACEMASK  "SIMBUS_TRACEMASK"
+#define TRACELOG_RING_RECORDS (1 << 16) /* Must be a power of 2. */
+
+
+/*
+Deferred Trace Log
+------------------
+
+Hot paths (per signal loops) record a format id and the raw arguments into a
+ring buffer, a background thread formats the records to the trace file. When
+the trace file is not configured, records are formatted synchronously with
+log_simbus() (i.e. the previous behaviour).
+
+The enable mask is evaluated once per loop:
+
+    bool trace = tracelog_enabled(TRACELOG_SIGNAL);
+    for (...) {
+        if (trace) tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, ...);
+    }
+
+The ring has several producers (the bus and adapter threads of a process),
+and a single consumer (the background thread).
+
+Configuration (environment):
+    SIMBUS_TRACEFILE : Path of the trace file (enables the ring), the process
+                       id is appended (i.e. `<path>.<pid>`).
+    SIMBUS_TRACEMASK : Category mask (default all categories).
+*/
+typedef enum TraceLogCategory {
+    TRACELOG_SIGNAL = 0x0001, /* Per signal value trace. */
+    TRACELOG_ALL = 0xffff,
+} TraceLogCategory;
+
+
+typedef enum TraceLogFormat {
+    TRACELOG_FMT_SIGNAL_WRITE = 0,
+    TRACELOG_FMT_SIGNAL_WRITE_BIN,
+    TRACELOG_FMT_SIGNAL_WRITE_PREV,
+    TRACELOG_FMT_SIGNAL_VALUE,
+    TRACELOG_FMT_SIGNAL_VALUE_BIN,
+    TRACELOG_FMT_SIGNAL_READ,
+    __TRACELOG_FMT_COUNT__,
+} TraceLogFormat;
+
+
+typedef struct TraceLogRecord {
+    uint16_t    format;
+    uint32_t    uid;
+    uint32_t    len;
+    double      value;
+    double      prev;
+    /* Name references SignalValue.name, valid until tracelog_close(). */
+    const char* name;
+} TraceLogRecord;
+
+
+DLL_PRIVATE extern uint32_t __tracelog_mask__;
+DLL_PRIVATE extern bool     __tracelog_ring__;
+
+
+/* tracelog.c */
+DLL_PRIVATE int  tracelog_open(const char* path, uint32_t mask);
+DLL_PRIVATE void tracelog_open_env(void);
+DLL_PRIVATE void tracelog_close(void);
+DLL_PRIVATE void tracelog_signal(TraceLogFormat format, uint32_t uid,
+    double value, double prev, uint32_t len, const char* name);
+
+
+static inline bool tracelog_enabled(uint32_t category)
+{
+    if (__atomic_load_n(&__tracelog_ring__, __ATOMIC_ACQUIRE)) {
+        return (__tracelog_mask__ & category) != 0;
+    }
+    return __log_level__ <= LOG_SIMBUS;
+}
+
+
+#endif  // DSE_MODELC_ADAPTER_TRACELOG_H_
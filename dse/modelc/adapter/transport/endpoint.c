@@ -10,7 +10,10 @@
 #include <dse/modelc/adapter/transport/endpoint.h>
 #include <dse/modelc/adapter/transport/redis.h>
 #include <dse/modelc/adapter/transport/redispubsub.h>
+#include <dse/modelc/adapter/transport/redisstreams.h>
 #include <dse/modelc/adapter/transport/mq.h>
+#include <dse/modelc/adapter/transport/multi.h>
+#include <dse/modelc/adapter/transport/inproc.h>
 
 
 #define REDIS_PORT            6379
@@ -27,9 +30,11 @@
  *  Parameters
  *  ----------
  *  transport : const char*
- *      The type of transport to create.
+ *      The type of transport to create. A SimBus may specify several
+ *      transports, separated by ';' (see multi.h).
  *  uri : const char*
- *      A URI which defines the transport to create.
+ *      A URI which defines the transport to create (or several URIs,
+ *      separated by ';', one for each transport).
  *  uid : uint32
  *      The UID (Unique Identifier) associated with the Model requesting the
  *      new Endpoint object.
@@ -62,9 +67,14 @@ Endpoint* endpoint_create(const char* transport, const char* uri, uint32_t uid,
     Endpoint*   endpoint = NULL;
     static char _uri[MAX_URI_LEN]; /* Other API's may refer to this data. */
 
+    if (multi_is_transport(transport)) {
+        /* Several transports (SimBus only), see multi.h. */
+        return multi_connect(transport, uri, uid, bus_mode, timeout);
+    }
     if ((strcmp(transport, TRANSPORT_REDISPUBSUB) == 0) ||
+        (strcmp(transport, TRANSPORT_REDISSTREAMS) == 0) ||
         (strcmp(transport, TRANSPORT_REDIS) == 0)) {
-        /* Redis and Redis Pub/Sub. */
+        /* Redis, Redis Pub/Sub and Redis Streams. */
         /* Decode the URI. */
         strncpy(_uri, uri, MAX_URI_LEN - 1);
         if (strncmp(_uri, REDIS_URI_SCHEME, strlen(REDIS_URI_SCHEME)) == 0) {
@@ -79,6 +89,9 @@ Endpoint* endpoint_create(const char* transport, const char* uri, uint32_t uid,
             if (strcmp(transport, TRANSPORT_REDISPUBSUB) == 0) {
                 endpoint = redispubsub_connect(
                     NULL, hostname, port, uid, bus_mode, timeout);
+            } else if (strcmp(transport, TRANSPORT_REDISSTREAMS) == 0) {
+                endpoint = redisstreams_connect(
+                    NULL, hostname, port, uid, bus_mode, timeout);
             } else {
                 endpoint = redis_connect(
                     NULL, hostname, port, uid, bus_mode, timeout, false);
@@ -103,6 +116,9 @@ Endpoint* endpoint_create(const char* transport, const char* uri, uint32_t uid,
             if (strcmp(transport, TRANSPORT_REDISPUBSUB) == 0) {
                 endpoint =
                     redispubsub_connect(path, NULL, 0, uid, bus_mode, timeout);
+            } else if (strcmp(transport, TRANSPORT_REDISSTREAMS) == 0) {
+                endpoint =
+                    redisstreams_connect(path, NULL, 0, uid, bus_mode, timeout);
             } else {
                 endpoint =
                     redis_connect(path, NULL, 0, uid, bus_mode, timeout, false);
@@ -115,6 +131,9 @@ Endpoint* endpoint_create(const char* transport, const char* uri, uint32_t uid,
     } else if (strcmp(transport, TRANSPORT_MQ) == 0) {
         /* Message Queue. */
         endpoint = mq_connect(uri, uid, bus_mode, timeout);
+    } else if (strcmp(transport, TRANSPORT_INPROC) == 0) {
+        /* In-process (SimBus hosted by ModelC), the URI is not used. */
+        endpoint = inproc_connect(uid, bus_mode, timeout);
     } else if (strcmp(transport, TRANSPORT_LOOPBACK) == 0) {
         /* Loopback - may also be created outside of this function. */
         endpoint = calloc(1, sizeof(Endpoint));
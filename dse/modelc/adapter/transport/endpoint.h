@@ -11,13 +11,15 @@
 #include <dse/clib/collections/hashmap.h>
 
 
-#define MAX_URI_LEN           2048
-#define URI_SCHEME_DELIM      "://"
+#define MAX_URI_LEN            2048
+#define URI_SCHEME_DELIM       "://"
 
-#define TRANSPORT_REDISPUBSUB "redispubsub"
-#define TRANSPORT_REDIS       "redis"
-#define TRANSPORT_MQ          "mq"
-#define TRANSPORT_LOOPBACK    "loopback"
+#define TRANSPORT_REDISPUBSUB  "redispubsub"
+#define TRANSPORT_REDISSTREAMS "redisstreams"
+#define TRANSPORT_REDIS        "redis"
+#define TRANSPORT_MQ           "mq"
+#define TRANSPORT_LOOPBACK     "loopback"
+#define TRANSPORT_INPROC       "inproc"
 
 
 typedef struct Endpoint        Endpoint;
@@ -62,11 +64,32 @@ typedef struct Endpoint {
     /* Channel storage container. */
     HashMap endpoint_channels;
 
+    /* Model UIDs hosted by this Endpoint (reference, set before start). A
+       transport may use these to subscribe to per Model keys. */
+    const uint32_t* model_uid;
+    uint32_t        model_uid_count;
+
     /* Private object for endpoint specific data. */
     void* private;
+    /* Prefetch queue (see prefetch.h), NULL if not enabled. */
+    void* prefetch;
+
+    /* Bound (ms) of a single receive, 0 for the transport timeout. Set by
+       the Adapter, see endpoint_recv_timeout(). */
+    uint32_t recv_bound_ms;
 } Endpoint;
 
 
+/* The receive timeout (seconds) of a transport, bounded by recv_bound_ms. */
+static inline double endpoint_recv_timeout(Endpoint* endpoint, double timeout)
+{
+    uint32_t bound_ms =
+        __atomic_load_n(&endpoint->recv_bound_ms, __ATOMIC_RELAXED);
+    if (bound_ms && bound_ms / 1000.0 < timeout) return bound_ms / 1000.0;
+    return timeout;
+}
+
+
 /* endpoint.c */
 DLL_PRIVATE Endpoint* endpoint_create(const char* transport, const char* uri,
     uint32_t uid, bool bus_mode, double timeout);
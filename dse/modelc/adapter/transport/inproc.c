@@ -0,0 +1,481 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <assert.h>
+#include <semaphore.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/adapter/transport/inproc.h>
+
+
+#define INPROC_FULL_WAIT_NS 10000 /* 10 us */
+
+
+typedef struct InprocQueue {
+    InprocSlot slot[INPROC_QUEUE_SLOTS];
+    uint32_t   head; /* Written by the producer. */
+    uint32_t   tail; /* Written by the consumer. */
+} InprocQueue;
+
+typedef struct InprocLink {
+    Endpoint*   endpoint;
+    /* Model UIDs of the Endpoint (for unicast messages from the SimBus), a
+       copy which the SimBus may read after the Endpoint has disconnected. */
+    uint32_t    uid;
+    uint32_t*   model_uid;
+    uint32_t    model_uid_count;
+    InprocQueue to_bus;
+    InprocQueue to_model;
+    sem_t       available; /* Messages in to_model. */
+    double      recv_timeout;
+    bool        closed;
+} InprocLink;
+
+typedef struct InprocBus {
+    Endpoint*   endpoint;
+    sem_t       available; /* Messages in to_bus (of all links). */
+    double      recv_timeout;
+    InprocLink* link[INPROC_MAX_LINKS];
+    uint32_t    link_count;
+    uint32_t    next_link;
+    uint32_t    refcount;
+} InprocBus;
+
+
+/* The bus is shared by all Endpoints of this transport. Endpoints are created
+   (connected) from a single thread, the last Endpoint to disconnect releases
+   the bus. */
+static InprocBus* __inproc_bus = NULL;
+static uint32_t   __inproc_uid = 0;
+
+
+static void _sleep_ns(long ns)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = ns };
+    nanosleep(&ts, NULL);
+}
+
+
+static int _queue_push(InprocQueue* q, const char* channel_name, void* buffer,
+    uint32_t length, Endpoint* endpoint)
+{
+    uint32_t head = q->head;
+    while (head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) >=
+           INPROC_QUEUE_SLOTS) {
+        /* Queue full, the receiver is behind. */
+        if (__atomic_load_n(&endpoint->stop_request, __ATOMIC_ACQUIRE)) {
+            errno = ECANCELED;
+            return -1;
+        }
+        _sleep_ns(INPROC_FULL_WAIT_NS);
+    }
+
+    InprocSlot* s = &q->slot[head & (INPROC_QUEUE_SLOTS - 1)];
+    if (length > s->buffer_length) {
+        /* Slot buffers are swapped with receivers, use plain realloc. */
+        uint8_t* _buffer = realloc(s->buffer, length);
+        if (_buffer == NULL) {
+            log_error("Inproc slot realloc failed!");
+            errno = ENOMEM;
+            return -1;
+        }
+        s->buffer = _buffer;
+        s->buffer_length = length;
+    }
+    memcpy(s->buffer, buffer, length);
+    s->length = length;
+    s->channel_name = channel_name;
+
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+
+static int32_t _queue_pop(InprocQueue* q, const char** channel_name,
+    uint8_t** buffer, uint32_t* buffer_length)
+{
+    uint32_t tail = q->tail;
+    if (__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == tail) return 0;
+
+    /* Swap the buffers (both are malloc/realloc managed). */
+    InprocSlot* s = &q->slot[tail & (INPROC_QUEUE_SLOTS - 1)];
+    uint8_t*    _buffer = *buffer;
+    uint32_t    _buffer_length = *buffer_length;
+    *buffer = s->buffer;
+    *buffer_length = s->buffer_length;
+    s->buffer = _buffer;
+    s->buffer_length = _buffer_length;
+    *channel_name = s->channel_name;
+    int32_t length = s->length;
+
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return length;
+}
+
+
+static void _queue_destroy(InprocQueue* q)
+{
+    for (uint32_t i = 0; i < INPROC_QUEUE_SLOTS; i++) {
+        free(q->slot[i].buffer);
+    }
+}
+
+
+/* Returns 0 when the semaphore was taken, otherwise -1 (errno is set). */
+static int _sem_wait(sem_t* sem, double timeout)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)timeout;
+    ts.tv_nsec += (long)((timeout - (time_t)timeout) * 1e9);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(sem, &ts) != 0) {
+        if (errno == EINTR) continue;
+        if (errno == ETIMEDOUT) errno = ETIME;
+        return -1;
+    }
+    return 0;
+}
+
+
+/* Map the channel name of the sender to the channel name of the receiver. */
+static bool _map_channel(Endpoint* endpoint, const char** channel_name)
+{
+    if (*channel_name == NULL) return true; /* Notify message. */
+    *channel_name = hashmap_get(&endpoint->endpoint_channels, *channel_name);
+    return (*channel_name != NULL);
+}
+
+
+static void* inproc_create_channel(Endpoint* endpoint, const char* channel_name)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+
+    /* Maintain a list of channel_names. There is no associated metadata
+       so only store the channel name pointer. */
+    if (hashmap_get(&endpoint->endpoint_channels, channel_name) == NULL) {
+        hashmap_set(
+            &endpoint->endpoint_channels, channel_name, (void*)channel_name);
+        log_notice("    Endpoint Channel : %s", channel_name);
+    }
+
+    /* Return the created object, to the caller (which will be an Adapter). */
+    return (void*)channel_name;
+}
+
+
+static int32_t inproc_start(Endpoint* endpoint)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    if (endpoint->bus_mode || endpoint->model_uid_count == 0) return 0;
+
+    /* Copy the Model UIDs of the Endpoint (set by the Controller), published
+       before the Models register with the SimBus. */
+    InprocLink* link = endpoint->private;
+    if (link->model_uid) return 0;
+    uint32_t* model_uid = calloc(endpoint->model_uid_count, sizeof(uint32_t));
+    if (model_uid == NULL) {
+        log_error("Inproc link malloc failed!");
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(model_uid, endpoint->model_uid,
+        endpoint->model_uid_count * sizeof(uint32_t));
+    link->model_uid = model_uid;
+    __atomic_store_n(&link->model_uid_count, endpoint->model_uid_count,
+        __ATOMIC_RELEASE);
+    return 0;
+}
+
+
+/* Returns TRUE if the link hosts the Model (model_uid 0, all links). */
+static bool _link_has_model(InprocLink* link, uint32_t model_uid)
+{
+    if (model_uid == 0 || link->uid == model_uid) return true;
+    uint32_t count = __atomic_load_n(&link->model_uid_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; i++) {
+        if (link->model_uid[i] == model_uid) return true;
+    }
+    return false;
+}
+
+
+static int32_t inproc_send_fbs(Endpoint* endpoint, void* endpoint_channel,
+    void* buffer, uint32_t buffer_length, uint32_t model_uid)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    const char* channel_name = endpoint_channel;
+
+    if (endpoint->bus_mode == false) {
+        InprocLink* link = endpoint->private;
+        InprocBus*  bus = __inproc_bus;
+        if (_queue_push(&link->to_bus, channel_name, buffer, buffer_length,
+                endpoint)) {
+            return -1;
+        }
+        sem_post(&bus->available);
+        return 0;
+    }
+
+    /* SimBus, deliver to the Model (model_uid) or to all Models (0). */
+    InprocBus* bus = endpoint->private;
+    uint32_t   count = __atomic_load_n(&bus->link_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; i++) {
+        InprocLink* link = bus->link[i];
+        if (__atomic_load_n(&link->closed, __ATOMIC_ACQUIRE)) continue;
+        if (_link_has_model(link, model_uid) == false) continue;
+        if (_queue_push(&link->to_model, channel_name, buffer, buffer_length,
+                endpoint)) {
+            return -1;
+        }
+        sem_post(&link->available);
+        if (model_uid) break;
+    }
+    return 0;
+}
+
+
+static int32_t _bus_pop(InprocBus* bus, const char** channel_name,
+    uint8_t** buffer, uint32_t* buffer_length)
+{
+    uint32_t count = __atomic_load_n(&bus->link_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t idx = (bus->next_link + i) % count;
+        int32_t  length = _queue_pop(
+            &bus->link[idx]->to_bus, channel_name, buffer, buffer_length);
+        if (length > 0) {
+            /* Round robin, the next receive starts at the following link. */
+            bus->next_link = idx + 1;
+            return length;
+        }
+    }
+    return 0;
+}
+
+
+static int32_t inproc_recv_fbs(Endpoint* endpoint, const char** channel_name,
+    uint8_t** buffer, uint32_t* buffer_length)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    assert(channel_name);
+    InprocBus*  bus = (endpoint->bus_mode) ? endpoint->private : NULL;
+    InprocLink* link = (endpoint->bus_mode) ? NULL : endpoint->private;
+    sem_t*      available = (bus) ? &bus->available : &link->available;
+    double      timeout = endpoint_recv_timeout(
+        endpoint, (bus) ? bus->recv_timeout : link->recv_timeout);
+
+    *channel_name = NULL; /* Set the default return condition. */
+    while (true) {
+        /* Wait for a message (the semaphore counts queued messages). */
+        if (_sem_wait(available, timeout)) {
+            if (errno == ETIME) {
+                log_trace("inproc_recv_fbs: no message (timeout)");
+            }
+            return -1; /* Caller must inspect errno to determine cause. */
+        }
+        int32_t length;
+        if (bus) {
+            length = _bus_pop(bus, channel_name, buffer, buffer_length);
+        } else {
+            length = _queue_pop(
+                &link->to_model, channel_name, buffer, buffer_length);
+        }
+        if (length == 0) {
+            /* Woken by an interrupt. */
+            *channel_name = NULL;
+            errno = ECANCELED;
+            return 0;
+        }
+        if (_map_channel(endpoint, channel_name)) return length;
+        /* Not a channel of this Endpoint, wait for the next message. */
+        *channel_name = NULL;
+    }
+}
+
+
+static void inproc_interrupt(Endpoint* endpoint)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    __atomic_store_n(&endpoint->stop_request, true, __ATOMIC_RELEASE);
+    if (endpoint->bus_mode) {
+        sem_post(&((InprocBus*)endpoint->private)->available);
+    } else {
+        sem_post(&((InprocLink*)endpoint->private)->available);
+    }
+}
+
+
+static void _bus_release(void)
+{
+    InprocBus* bus = __inproc_bus;
+    if (bus == NULL) return;
+    if (__atomic_sub_fetch(&bus->refcount, 1, __ATOMIC_ACQ_REL)) return;
+
+    for (uint32_t i = 0; i < bus->link_count; i++) {
+        InprocLink* link = bus->link[i];
+        _queue_destroy(&link->to_bus);
+        _queue_destroy(&link->to_model);
+        sem_destroy(&link->available);
+        free(link->model_uid);
+        free(link);
+    }
+    memstat_add(MEMSTAT_TRANSPORT,
+        -(int64_t)(bus->link_count * sizeof(InprocLink)));
+    sem_destroy(&bus->available);
+    free(bus);
+    __inproc_bus = NULL;
+}
+
+
+static InprocBus* _bus_acquire(void)
+{
+    if (__inproc_bus == NULL) {
+        InprocBus* bus = calloc(1, sizeof(InprocBus));
+        if (bus == NULL) {
+            log_error("Inproc bus malloc failed!");
+            errno = ENOMEM;
+            return NULL;
+        }
+        if (sem_init(&bus->available, 0, 0)) {
+            log_error("Inproc semaphore could not be created!");
+            free(bus);
+            return NULL;
+        }
+        __inproc_bus = bus;
+    }
+    __atomic_add_fetch(&__inproc_bus->refcount, 1, __ATOMIC_ACQ_REL);
+    return __inproc_bus;
+}
+
+
+static void inproc_disconnect(Endpoint* endpoint)
+{
+    if (endpoint == NULL) return;
+    if (endpoint->private) {
+        if (endpoint->bus_mode) {
+            ((InprocBus*)endpoint->private)->endpoint = NULL;
+        } else {
+            /* Links are released with the bus (the SimBus may still be
+               delivering messages). */
+            InprocLink* link = endpoint->private;
+            link->endpoint = NULL;
+            __atomic_store_n(&link->closed, true, __ATOMIC_RELEASE);
+        }
+        _bus_release();
+    }
+    hashmap_destroy(&endpoint->endpoint_channels);
+    free(endpoint);
+}
+
+
+/**
+ *  inproc_connect
+ *
+ *  Create an in-process Endpoint. The SimBus Endpoint (bus_mode) and Model
+ *  Endpoints may be connected in any order, however all Endpoints must be
+ *  connected from the same thread.
+ *
+ *  Parameters
+ *  ----------
+ *  model_uid : uint32_t
+ *      The UID of the Endpoint, if 0 a UID is generated.
+ *  bus_mode : bool
+ *      A TRUE value indicates that the Endpoint is the SimBus Endpoint.
+ *  recv_timeout : double
+ *      The timeout (seconds) when waiting for messages.
+ *
+ *  Returns
+ *  -------
+ *      Endpoint (pointer to) : The created Endpoint object.
+ *      NULL : The Endpoint could not be created (errno is set).
+ */
+Endpoint* inproc_connect(uint32_t model_uid, bool bus_mode, double recv_timeout)
+{
+    int       rc;
+    /* Endpoint. */
+    Endpoint* endpoint = calloc(1, sizeof(Endpoint));
+    if (endpoint == NULL) {
+        log_error("Endpoint malloc failed!");
+        goto error_clean_up;
+    }
+    endpoint->bus_mode = bus_mode;
+    endpoint->create_channel = inproc_create_channel;
+    endpoint->start = inproc_start;
+    endpoint->send_fbs = inproc_send_fbs;
+    endpoint->recv_fbs = inproc_recv_fbs;
+    endpoint->interrupt = inproc_interrupt;
+    endpoint->disconnect = inproc_disconnect;
+    rc = hashmap_init_alt(&endpoint->endpoint_channels, 16, NULL);
+    if (rc) {
+        log_error("Hashmap init failed for endpoint->endpoint_channels!");
+        if (errno == 0) errno = rc;
+        goto error_clean_up;
+    }
+    endpoint->uid = (model_uid) ? model_uid : ++__inproc_uid;
+
+    /* Connect to the bus. */
+    InprocBus* bus = _bus_acquire();
+    if (bus == NULL) goto error_clean_up;
+    if (bus_mode) {
+        if (bus->endpoint) {
+            log_error("Inproc bus already has a SimBus Endpoint!");
+            errno = EEXIST;
+            _bus_release();
+            goto error_clean_up;
+        }
+        bus->endpoint = endpoint;
+        bus->recv_timeout = recv_timeout;
+        endpoint->private = bus;
+    } else {
+        if (bus->link_count >= INPROC_MAX_LINKS) {
+            log_error("Inproc bus link limit reached (%u)!", INPROC_MAX_LINKS);
+            errno = ENOSPC;
+            _bus_release();
+            goto error_clean_up;
+        }
+        InprocLink* link = calloc(1, sizeof(InprocLink));
+        if (link == NULL || sem_init(&link->available, 0, 0)) {
+            log_error("Inproc link could not be created!");
+            free(link);
+            _bus_release();
+            goto error_clean_up;
+        }
+        memstat_add(MEMSTAT_TRANSPORT, sizeof(InprocLink));
+        link->endpoint = endpoint;
+        link->uid = endpoint->uid;
+        link->recv_timeout = recv_timeout;
+        endpoint->private = link;
+        /* Publish the link (the SimBus thread may be receiving). */
+        bus->link[bus->link_count] = link;
+        __atomic_store_n(&bus->link_count, bus->link_count + 1,
+            __ATOMIC_RELEASE);
+    }
+
+    log_notice("  Inproc:");
+    log_notice("    Mode: %s", bus_mode ? "SimBus" : "Model");
+    log_notice("  Endpoint: ");
+    log_notice("    Model UID: %u", endpoint->uid);
+
+    return endpoint;
+
+error_clean_up:
+    if (endpoint) hashmap_destroy(&endpoint->endpoint_channels);
+    free(endpoint);
+    return NULL;
+}
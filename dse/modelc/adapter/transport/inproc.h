@@ -0,0 +1,49 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_TRANSPORT_INPROC_H_
+#define DSE_MODELC_ADAPTER_TRANSPORT_INPROC_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/platform.h>
+
+
+#define INPROC_QUEUE_SLOTS 256 /* Must be a power of 2. */
+#define INPROC_MAX_LINKS   64
+
+
+/*
+In-process Transport
+--------------------
+
+Connects a SimBus Endpoint (bus_mode) with Model Endpoints in the same
+process. Each Model Endpoint is linked to the SimBus with a pair of single
+producer/single consumer queues (one for each direction), a semaphore per
+receiver counts queued messages.
+
+Messages are copied once, into the queue slot, on send (the caller of
+send_fbs() retains its buffer). On receive the slot buffer is swapped with
+the buffer of the caller (handover by pointer, no copy). Messages sent by the
+SimBus to a Model (model_uid) are delivered to the Model Endpoint hosting that
+Model, messages with model_uid 0 are delivered to all linked Model Endpoints.
+Each Model Endpoint only accepts messages for the channels it has created.
+*/
+typedef struct InprocSlot {
+    uint8_t*    buffer;
+    uint32_t    buffer_length;
+    uint32_t    length;
+    /* Channel name of the sender (NULL for Notify messages). */
+    const char* channel_name;
+} InprocSlot;
+
+
+/* inproc.c */
+DLL_PRIVATE Endpoint* inproc_connect(
+    uint32_t model_uid, bool bus_mode, double recv_timeout);
+
+
+#endif  // DSE_MODELC_ADAPTER_TRANSPORT_INPROC_H_
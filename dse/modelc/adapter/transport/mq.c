@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <string.h>
+#include <math.h>
 #include <msgpack.h>
 #include <dse/logger.h>
 #include <dse/modelc/adapter/transport/mq.h>
@@ -385,7 +386,11 @@ int32_t mq_recv_fbs(Endpoint* endpoint, const char** channel_name,
     int             msg_len;
     static char     msg[MQ_MAX_MSGSIZE];
     struct timespec tm;
-    int             timeout_counter = (int32_t)mq_ep->recv_timeout + 1;
+    double          timeout =
+        endpoint_recv_timeout(endpoint, mq_ep->recv_timeout);
+    /* Receive in intervals of 1 second (or the bound, if shorter). */
+    double          interval = (timeout > 0.0 && timeout < 1.0) ? timeout : 1.0;
+    int             timeout_counter = (int32_t)ceil(timeout / interval) + 1;
 
     *channel_name = NULL; /* Set the default return condition. */
 
@@ -398,7 +403,12 @@ int32_t mq_recv_fbs(Endpoint* endpoint, const char** channel_name,
          * in doing this loop as we expect messages on a shorter time frame.
          */
         clock_gettime(CLOCK_REALTIME, &tm);
-        tm.tv_sec += 1;
+        tm.tv_sec += (time_t)interval;
+        tm.tv_nsec += (long)((interval - (time_t)interval) * 1e9);
+        if (tm.tv_nsec >= 1000000000L) {
+            tm.tv_sec++;
+            tm.tv_nsec -= 1000000000L;
+        }
         msg_len = mq_ep->mq_recv(&mq_ep->pull, msg, MQ_MAX_MSGSIZE, &tm);
         if (msg_len < 0) {
             if (errno == 0) errno = ENODATA;
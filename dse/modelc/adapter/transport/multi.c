@@ -0,0 +1,539 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <dse/logger.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/clib/collections/queue.h>
+#include <dse/modelc/adapter/message.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/adapter/transport/multi.h>
+#include <dse/modelc/adapter/transport/prefetch.h>
+
+
+#define MULTI_ERROR_WAIT_NS 1000000 /* 1 ms */
+#define UID_KEY_LEN         12
+
+
+typedef struct MultiEndpoint MultiEndpoint;
+
+typedef struct MultiItem {
+    Endpoint*      endpoint;
+    const char*    transport;
+    bool           interrupt_mt; /* Interrupt from any thread. */
+    uint32_t       index;
+    MultiEndpoint* multi_ep;
+    pthread_t      thread;
+    bool           running;
+    /* Models which send through this Endpoint. */
+    uint32_t       model_count;
+    /* Statistics. */
+    uint64_t       received;
+} MultiItem;
+
+typedef struct MultiMessage {
+    uint8_t*    buffer;
+    uint32_t    buffer_length;
+    int32_t     length;
+    const char* channel_name;
+    uint32_t    index;
+} MultiMessage;
+
+typedef struct MultiEndpoint {
+    double          recv_timeout;
+    MultiItem       item[MULTI_MAX_ENDPOINTS];
+    uint32_t        count;
+    /* Route of each Model, key is model_uid, value is the MultiItem. */
+    HashMap         route;
+    /* Messages received from all Endpoints (guarded by the lock). */
+    queue_list_t    recv_msg_queue;
+    pthread_mutex_t lock;
+    sem_t           available;
+    bool            stop_request;
+} MultiEndpoint;
+
+
+static void _sleep_ns(long ns)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = ns };
+    nanosleep(&ts, NULL);
+}
+
+
+/* Called from the SimBus thread, break a blocking receive of each I/O thread
+   (or let it return at its next timeout, see endpoint_thread_transport). */
+static void _interrupt_items(MultiEndpoint* multi_ep)
+{
+    for (uint32_t i = 0; i < multi_ep->count; i++) {
+        MultiItem* item = &multi_ep->item[i];
+        Endpoint*  ep = item->endpoint;
+        __atomic_store_n(&ep->stop_request, true, __ATOMIC_SEQ_CST);
+        if (ep->interrupt && item->interrupt_mt) ep->interrupt(ep);
+    }
+}
+
+
+static MultiItem* _route_get(MultiEndpoint* multi_ep, uint32_t model_uid)
+{
+    char key[UID_KEY_LEN];
+    snprintf(key, UID_KEY_LEN, "%u", model_uid);
+    return hashmap_get(&multi_ep->route, key);
+}
+
+
+static void _route_set(
+    MultiEndpoint* multi_ep, MultiItem* item, uint32_t model_uid)
+{
+    if (model_uid == 0) return;
+    MultiItem* current = _route_get(multi_ep, model_uid);
+    if (current == item) return;
+
+    char key[UID_KEY_LEN];
+    snprintf(key, UID_KEY_LEN, "%u", model_uid);
+    hashmap_set(&multi_ep->route, key, item);
+    if (current) current->model_count--;
+    item->model_count++;
+    log_notice("Multi Endpoint: model_uid=%u via %s", model_uid,
+        item->transport);
+}
+
+
+/* Record the Endpoint of each Model (from the model_uid of the messages). */
+static void _route_message_stream(
+    MultiEndpoint* multi_ep, MultiItem* item, uint8_t* buffer, size_t length)
+{
+    size_t   msg_len = 0;
+    uint8_t* msg_ptr = buffer;
+
+    /* Messages are in a stream, each with a size prefix. */
+    while (((msg_ptr - buffer) + msg_len) < length) {
+        msg_ptr = flatbuffers_read_size_prefix(msg_ptr, &msg_len);
+        if (msg_len == 0) break;
+        if (flatbuffers_has_identifier(
+                msg_ptr, flatbuffers_channel_identifier)) {
+            ns(ChannelMessage_table_t) cm = ns(ChannelMessage_as_root(msg_ptr));
+            _route_set(multi_ep, item, ns(ChannelMessage_model_uid(cm)));
+        } else if (flatbuffers_has_identifier(
+                       msg_ptr, flatbuffers_notify_identifier)) {
+            notify(NotifyMessage_table_t) nm =
+                notify(NotifyMessage_as_root(msg_ptr));
+            flatbuffers_uint32_vec_t uids = notify(NotifyMessage_model_uid(nm));
+            for (size_t i = 0; i < flatbuffers_uint32_vec_len(uids); i++) {
+                _route_set(multi_ep, item, flatbuffers_uint32_vec_at(uids, i));
+            }
+        } else {
+            break;
+        }
+
+        /* Next. */
+        msg_ptr += msg_len;
+    }
+}
+
+
+static void* _multi_thread(void* arg)
+{
+    MultiItem*     item = arg;
+    MultiEndpoint* multi_ep = item->multi_ep;
+    Endpoint*      endpoint = item->endpoint;
+    uint8_t*       buffer = NULL;
+    uint32_t       buffer_length = 0;
+
+    while (__atomic_load_n(&multi_ep->stop_request, __ATOMIC_ACQUIRE) ==
+           false) {
+        const char* channel_name = NULL;
+        errno = 0;
+        int32_t length = endpoint->recv_fbs(
+            endpoint, &channel_name, &buffer, &buffer_length);
+        if (length <= 0) {
+            /* Timeout (normal while models step), retry. */
+            if (errno != ETIME) _sleep_ns(MULTI_ERROR_WAIT_NS);
+            continue;
+        }
+
+        /* Handover the buffer, the next receive allocates a new buffer. */
+        MultiMessage* msg = calloc(1, sizeof(MultiMessage));
+        msg->buffer = buffer;
+        msg->buffer_length = buffer_length;
+        msg->length = length;
+        msg->channel_name = channel_name;
+        msg->index = item->index;
+        buffer = NULL;
+        buffer_length = 0;
+
+        pthread_mutex_lock(&multi_ep->lock);
+        q_push(multi_ep->recv_msg_queue, msg);
+        pthread_mutex_unlock(&multi_ep->lock);
+        item->received++;
+        sem_post(&multi_ep->available);
+    }
+    free(buffer);
+
+    return NULL;
+}
+
+
+static void* multi_create_channel(Endpoint* endpoint, const char* channel_name)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    MultiEndpoint* multi_ep = (MultiEndpoint*)endpoint->private;
+
+    /* Check if the endpoint channel already exists. */
+    MultiChannel* mc = hashmap_get(&endpoint->endpoint_channels, channel_name);
+    if (mc) return (void*)mc;
+
+    /* Create the channel on each Endpoint. */
+    mc = calloc(1, sizeof(MultiChannel));
+    assert(mc);
+    mc->channel_name = channel_name;
+    for (uint32_t i = 0; i < multi_ep->count; i++) {
+        Endpoint* ep = multi_ep->item[i].endpoint;
+        if (ep->create_channel) {
+            mc->endpoint_channel[i] = ep->create_channel(ep, channel_name);
+        }
+    }
+    if (hashmap_set(&endpoint->endpoint_channels, channel_name, mc) == NULL) {
+        assert(0);
+    }
+
+    /* Return the created object, to the caller (which will be an Adapter). */
+    return (void*)mc;
+}
+
+
+static int32_t multi_start(Endpoint* endpoint)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    MultiEndpoint* multi_ep = (MultiEndpoint*)endpoint->private;
+
+    for (uint32_t i = 0; i < multi_ep->count; i++) {
+        Endpoint* ep = multi_ep->item[i].endpoint;
+        if (ep->start) ep->start(ep);
+    }
+
+    /* Receive each Endpoint on an I/O thread. */
+    for (uint32_t i = 0; i < multi_ep->count; i++) {
+        MultiItem* item = &multi_ep->item[i];
+        if (pthread_create(&item->thread, NULL, _multi_thread, item)) {
+            log_fatal("Multi Endpoint: I/O thread could not be started!");
+        }
+        item->running = true;
+        log_notice("Multi Endpoint: I/O thread started (%s)", item->transport);
+    }
+
+    return 0;
+}
+
+
+static int32_t multi_send_fbs(Endpoint* endpoint, void* endpoint_channel,
+    void* buffer, uint32_t buffer_length, uint32_t model_uid)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    MultiEndpoint* multi_ep = (MultiEndpoint*)endpoint->private;
+    MultiChannel*  mc = (MultiChannel*)endpoint_channel;
+
+    /* Channel Message, send via the Endpoint of the Model. */
+    if (mc && model_uid) {
+        MultiItem* item = _route_get(multi_ep, model_uid);
+        if (item) {
+            Endpoint* ep = item->endpoint;
+            return ep->send_fbs(ep, mc->endpoint_channel[item->index], buffer,
+                buffer_length, model_uid);
+        }
+    }
+
+    /* Notify Message (or a Model without a route), send via each Endpoint
+       which has Models (or all Endpoints when there are no routes). */
+    bool routed = false;
+    for (uint32_t i = 0; i < multi_ep->count; i++) {
+        if (multi_ep->item[i].model_count) routed = true;
+    }
+    int32_t rc = 0;
+    for (uint32_t i = 0; i < multi_ep->count; i++) {
+        MultiItem* item = &multi_ep->item[i];
+        if (routed && item->model_count == 0) continue;
+        Endpoint* ep = item->endpoint;
+        rc |= ep->send_fbs(ep, mc ? mc->endpoint_channel[i] : NULL, buffer,
+            buffer_length, model_uid);
+    }
+
+    return rc;
+}
+
+
+static int32_t multi_recv_fbs(Endpoint* endpoint, const char** channel_name,
+    uint8_t** buffer, uint32_t* buffer_length)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    assert(channel_name);
+    MultiEndpoint* multi_ep = (MultiEndpoint*)endpoint->private;
+
+    /* Wait for a message (the semaphore counts queued messages). */
+    double          timeout =
+        endpoint_recv_timeout(endpoint, multi_ep->recv_timeout);
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)timeout;
+    ts.tv_nsec += (long)((timeout - (time_t)timeout) * 1e9);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(&multi_ep->available, &ts) != 0) {
+        if (errno == EINTR) continue;
+        if (errno == ETIMEDOUT) errno = ETIME;
+        return -1; /* Caller must inspect errno to determine cause. */
+    }
+
+    pthread_mutex_lock(&multi_ep->lock);
+    MultiMessage* msg = q_pop(multi_ep->recv_msg_queue);
+    pthread_mutex_unlock(&multi_ep->lock);
+    if (msg == NULL) {
+        /* Woken by an interrupt. */
+        *channel_name = NULL;
+        errno = ECANCELED;
+        return 0;
+    }
+
+    /* Handover the buffer (both are malloc/realloc managed). */
+    free(*buffer);
+    *buffer = msg->buffer;
+    *buffer_length = msg->buffer_length;
+    *channel_name = msg->channel_name;
+    int32_t length = msg->length;
+    _route_message_stream(
+        multi_ep, &multi_ep->item[msg->index], *buffer, (size_t)length);
+    free(msg);
+
+    /* Return the buffer length (+ve) as indicator of success. */
+    return length;
+}
+
+
+static void multi_interrupt(Endpoint* endpoint)
+{
+    assert(endpoint);
+    endpoint->stop_request = 1;
+    MultiEndpoint* multi_ep = (MultiEndpoint*)endpoint->private;
+    _interrupt_items(multi_ep);
+    sem_post(&multi_ep->available);
+}
+
+
+static void multi_endpoint_destroy(Endpoint* endpoint)
+{
+    if (endpoint && endpoint->private) {
+        MultiEndpoint* multi_ep = (MultiEndpoint*)endpoint->private;
+        /* Stop the I/O threads (break a blocking receive). */
+        __atomic_store_n(&multi_ep->stop_request, true, __ATOMIC_RELEASE);
+        _interrupt_items(multi_ep);
+        for (uint32_t i = 0; i < multi_ep->count; i++) {
+            MultiItem* item = &multi_ep->item[i];
+            if (item->running) pthread_join(item->thread, NULL);
+            log_notice("Multi Endpoint: %s received=%" PRIu64
+                       ", models=%u",
+                item->transport, item->received, item->model_count);
+            if (item->endpoint->disconnect) {
+                item->endpoint->disconnect(item->endpoint);
+            }
+        }
+        /* Free any items in the queue. */
+        queue_node* n;
+        q_traverse(multi_ep->recv_msg_queue, n)
+        {
+            MultiMessage* msg = (MultiMessage*)n->data;
+            free(msg->buffer);
+        }
+        q_free_alt(multi_ep->recv_msg_queue, true);
+        hashmap_destroy(&multi_ep->route);
+        pthread_mutex_destroy(&multi_ep->lock);
+        sem_destroy(&multi_ep->available);
+        free(multi_ep);
+    }
+    if (endpoint) {
+        /* Release the endpoint_channels hashmap. */
+        char**   keys = hashmap_keys(&endpoint->endpoint_channels);
+        uint32_t count = hashmap_number_keys(endpoint->endpoint_channels);
+        for (uint32_t i = 0; i < count; i++) {
+            free(hashmap_get(&endpoint->endpoint_channels, keys[i]));
+        }
+        hashmap_destroy(&endpoint->endpoint_channels);
+        for (uint32_t _ = 0; _ < count; _++)
+            free(keys[_]);
+        free(keys);
+    }
+    free(endpoint);
+}
+
+
+static void multi_disconnect(Endpoint* endpoint)
+{
+    multi_endpoint_destroy(endpoint);
+}
+
+
+/**
+ *  multi_is_transport
+ *
+ *  Indicates if a transport specifies a Multi Endpoint (i.e. a list of
+ *  transports separated by ';').
+ */
+bool multi_is_transport(const char* transport)
+{
+    return (transport && strstr(transport, MULTI_DELIM) != NULL);
+}
+
+
+/**
+ *  multi_connect
+ *
+ *  Create a Multi Endpoint, with an Endpoint for each of the listed
+ *  transport/URI pairs (see multi.h).
+ *
+ *  Parameters
+ *  ----------
+ *  transport : const char*
+ *      List of transports, separated by ';'.
+ *  uri : const char*
+ *      List of URIs, separated by ';' (one for each transport).
+ *  model_uid : uint32
+ *      The UID of the SimBus.
+ *  bus_mode : bool
+ *      Must be TRUE, only a SimBus may use a Multi Endpoint.
+ *  recv_timeout : double
+ *      The timeout (seconds) when waiting for messages.
+ *
+ *  Returns
+ *  -------
+ *      Endpoint (pointer to) : The created Endpoint object.
+ *      NULL : The Endpoint could not be created (errno is set).
+ */
+Endpoint* multi_connect(const char* transport, const char* uri,
+    uint32_t model_uid, bool bus_mode, double recv_timeout)
+{
+    int            rc;
+    Endpoint*      endpoint = NULL;
+    MultiEndpoint* multi_ep = NULL;
+    char*          _transport = NULL;
+    char*          _uri = NULL;
+
+    if (bus_mode == false || uri == NULL) {
+        log_error("Multi Endpoint: only supported by the SimBus (with a URI "
+                  "for each transport)!");
+        errno = EINVAL;
+        return NULL;
+    }
+
+    /* Endpoint. */
+    endpoint = calloc(1, sizeof(Endpoint));
+    if (endpoint == NULL) {
+        log_error("Endpoint malloc failed!");
+        goto error_clean_up;
+    }
+    endpoint->bus_mode = bus_mode;
+    endpoint->create_channel = multi_create_channel;
+    endpoint->start = multi_start;
+    endpoint->send_fbs = multi_send_fbs;
+    endpoint->recv_fbs = multi_recv_fbs;
+    endpoint->interrupt = multi_interrupt;
+    endpoint->disconnect = multi_disconnect;
+    rc = hashmap_init_alt(&endpoint->endpoint_channels, 16, NULL);
+    if (rc) {
+        log_error("Hashmap init failed for endpoint->endpoint_channels!");
+        if (errno == 0) errno = rc;
+        goto error_clean_up;
+    }
+
+    /* Multi Endpoint. */
+    multi_ep = calloc(1, sizeof(MultiEndpoint));
+    if (multi_ep == NULL) {
+        log_error("MultiEndpoint malloc failed!");
+        goto error_clean_up;
+    }
+    endpoint->private = (void*)multi_ep;
+    multi_ep->recv_timeout = recv_timeout;
+    rc = hashmap_init(&multi_ep->route);
+    if (rc) {
+        log_error("Hashmap init failed for multi_ep->route!");
+        if (errno == 0) errno = rc;
+        goto error_clean_up;
+    }
+    multi_ep->recv_msg_queue = q_init();
+    pthread_mutex_init(&multi_ep->lock, NULL);
+    sem_init(&multi_ep->available, 0, 0);
+
+    /* Create an Endpoint for each transport/URI pair. */
+    _transport = strdup(transport);
+    _uri = strdup(uri);
+    char*    t_saveptr = NULL;
+    char*    u_saveptr = NULL;
+    char*    t = strtok_r(_transport, MULTI_DELIM, &t_saveptr);
+    char*    u = strtok_r(_uri, MULTI_DELIM, &u_saveptr);
+    uint32_t redis_count = 0;
+    log_notice("  Multi Endpoint:");
+    for (; t; t = strtok_r(NULL, MULTI_DELIM, &t_saveptr),
+              u = strtok_r(NULL, MULTI_DELIM, &u_saveptr)) {
+        bool        interrupt_mt = false;
+        const char* _t = endpoint_thread_transport(t, &interrupt_mt);
+        if (_t == NULL || u == NULL) {
+            log_error("Multi Endpoint: transport not supported, or URI not "
+                      "provided (%s)",
+                t);
+            errno = EINVAL;
+            goto error_clean_up;
+        }
+        /* Redis Endpoints refer to static URI data (see endpoint_create). */
+        if (strncmp(_t, TRANSPORT_REDIS, strlen(TRANSPORT_REDIS)) == 0 &&
+            redis_count++) {
+            log_error("Multi Endpoint: only one Redis transport supported!");
+            errno = EINVAL;
+            goto error_clean_up;
+        }
+        if (multi_ep->count >= MULTI_MAX_ENDPOINTS) {
+            log_error("Multi Endpoint: too many transports!");
+            errno = EINVAL;
+            goto error_clean_up;
+        }
+        log_notice("    %s: %s", _t, u);
+        Endpoint* ep =
+            endpoint_create(_t, u, model_uid, bus_mode, recv_timeout);
+        if (ep == NULL) goto error_clean_up;
+        MultiItem* item = &multi_ep->item[multi_ep->count];
+        item->endpoint = ep;
+        item->transport = _t;
+        item->interrupt_mt = interrupt_mt;
+        item->index = multi_ep->count;
+        item->multi_ep = multi_ep;
+        multi_ep->count++;
+    }
+    if (multi_ep->count == 0) {
+        errno = EINVAL;
+        goto error_clean_up;
+    }
+    endpoint->uid = multi_ep->item[0].endpoint->uid;
+
+    free(_transport);
+    free(_uri);
+    return endpoint;
+
+error_clean_up:
+    free(_transport);
+    free(_uri);
+    multi_endpoint_destroy(endpoint);
+    return NULL;
+}
@@ -0,0 +1,56 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_TRANSPORT_MULTI_H_
+#define DSE_MODELC_ADAPTER_TRANSPORT_MULTI_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/platform.h>
+
+
+#define MULTI_DELIM         ";"
+#define MULTI_MAX_ENDPOINTS 8
+
+
+/*
+Multi Endpoint
+--------------
+
+A SimBus may serve Models over several transports at once (e.g. MQ for
+Models on the same host and Redis for remote Models). The transports and
+URIs are listed, separated by ';', in the same order:
+
+    simbus --transport "mq;redispubsub" --uri "posix://sim;redis://host:6379"
+
+Each transport Endpoint is received on its own I/O thread, the received
+message streams are pushed to a single queue which is consumed by the SimBus.
+This is not a single reactor (one thread waiting on all transports), the
+transports do not expose a common descriptor to wait on, and each received
+message is a queue item (one allocation per message). The Endpoint which each
+Model sends through is recorded (from the model_uid of received messages) and
+messages for that Model are sent via the same Endpoint. Notify messages are
+sent via each Endpoint which has Models.
+
+Only transports with independent send and receive connections are supported
+(see endpoint_thread_transport), and only one of those may be a Redis
+transport. A transport interrupt which is not safe from another thread (i.e.
+redispubsub) is not called, the I/O thread observes the stop request at the
+next receive timeout instead.
+*/
+typedef struct MultiChannel {
+    const char* channel_name;
+    void*       endpoint_channel[MULTI_MAX_ENDPOINTS];
+} MultiChannel;
+
+
+/* multi.c */
+DLL_PRIVATE bool      multi_is_transport(const char* transport);
+DLL_PRIVATE Endpoint* multi_connect(const char* transport, const char* uri,
+    uint32_t model_uid, bool bus_mode, double recv_timeout);
+
+
+#endif  // DSE_MODELC_ADAPTER_TRANSPORT_MULTI_H_
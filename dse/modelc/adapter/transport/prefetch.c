@@ -0,0 +1,367 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/adapter/transport/prefetch.h>
+
+
+typedef struct PrefetchQueue {
+    Endpoint*              endpoint;
+    double                 timeout;
+    /* Transport functions (the recv_fbs is called from the I/O thread). */
+    EndpointRecvFbsFunc    recv_fbs;
+    EndpointInterruptFunc  interrupt;
+    EndpointDisconnectFunc disconnect;
+    bool                   interrupt_mt; /* Interrupt from any thread. */
+    /* SPSC queue. */
+    PrefetchSlot           slot[PREFETCH_QUEUE_SLOTS];
+    uint32_t               head; /* Written by the I/O thread. */
+    uint32_t               tail; /* Written by the consumer (adapter). */
+    sem_t                  available;
+    pthread_t              thread;
+    bool                   stop_request;
+    /* I/O thread wait (queue full, or no message until the next call). */
+    pthread_mutex_t        lock;
+    pthread_cond_t         cond;
+    bool                   io_waiting;
+    bool                   consumer_waiting;
+    uint32_t               demand; /* Calls to recv_fbs(). */
+    /* Statistics. */
+    uint64_t               received;
+    uint64_t               dropped;
+    uint64_t               full;
+} PrefetchQueue;
+
+
+/* Transports where an I/O thread may receive while another thread sends
+   (i.e. independent send and receive connections), see also multi.c. The
+   interrupt of
+   redispubsub breaks the libevent loop, which is not safe from another
+   thread (libevent is built without evthread support). That receive returns
+   on its 1 s timeout event instead, when the stop request is observed. */
+static const struct {
+    const char* transport;
+    bool        interrupt_mt;
+} __supported_transports[] = {
+    { TRANSPORT_REDISPUBSUB, false },
+    { TRANSPORT_REDISSTREAMS, true },
+    { TRANSPORT_MQ, true },
+    { NULL, false },
+};
+
+
+/**
+ *  endpoint_thread_transport
+ *
+ *  Indicates if a transport may be received on an I/O thread (while another
+ *  thread sends), and if its interrupt may be called from any thread.
+ *
+ *  Parameters
+ *  ----------
+ *  transport : const char*
+ *      The transport of the Endpoint.
+ *  interrupt_mt : bool*
+ *      (out, may be NULL) The interrupt may be called from any thread, when
+ *      false the receive returns at its next timeout (after the Endpoint
+ *      stop_request is set).
+ *
+ *  Returns
+ *  -------
+ *      const char* : The transport (static), NULL if not supported.
+ */
+DLL_PRIVATE const char* endpoint_thread_transport(
+    const char* transport, bool* interrupt_mt)
+{
+    if (transport == NULL) return NULL;
+    for (int i = 0; __supported_transports[i].transport; i++) {
+        if (strcmp(__supported_transports[i].transport, transport) == 0) {
+            if (interrupt_mt) {
+                *interrupt_mt = __supported_transports[i].interrupt_mt;
+            }
+            return __supported_transports[i].transport;
+        }
+    }
+    return NULL;
+}
+
+
+/* Called from the I/O thread, wait until the queue has a free slot (full is
+   true) or until the consumer calls recv_fbs() again (demand has changed). */
+static void _io_wait(PrefetchQueue* q, bool full, uint32_t demand)
+{
+    pthread_mutex_lock(&q->lock);
+    __atomic_store_n(&q->io_waiting, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&q->stop_request, __ATOMIC_SEQ_CST) == false) {
+        if (full) {
+            uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_SEQ_CST);
+            if (q->head - tail < PREFETCH_QUEUE_SLOTS) break;
+        } else {
+            if (__atomic_load_n(&q->demand, __ATOMIC_SEQ_CST) != demand) break;
+        }
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    __atomic_store_n(&q->io_waiting, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&q->lock);
+}
+
+
+/* Wake the I/O thread, the lock is only taken when it is waiting. */
+static void _io_wake(PrefetchQueue* q)
+{
+    if (__atomic_load_n(&q->io_waiting, __ATOMIC_SEQ_CST) == false) return;
+    pthread_mutex_lock(&q->lock);
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+
+static void* _prefetch_thread(void* arg)
+{
+    PrefetchQueue* q = arg;
+
+    while (__atomic_load_n(&q->stop_request, __ATOMIC_ACQUIRE) == false) {
+        uint32_t head = q->head;
+        uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+        if (head - tail >= PREFETCH_QUEUE_SLOTS) {
+            /* Queue full, the adapter is behind. */
+            q->full++;
+            _io_wait(q, true, 0);
+            continue;
+        }
+
+        PrefetchSlot* s = &q->slot[head & (PREFETCH_QUEUE_SLOTS - 1)];
+        const char*   channel_name = NULL;
+        uint32_t      demand = __atomic_load_n(&q->demand, __ATOMIC_SEQ_CST);
+        errno = 0;
+        int32_t length = q->recv_fbs(
+            q->endpoint, &channel_name, &s->buffer, &s->buffer_length);
+        if (length <= 0) {
+            /* Timeout (normal while models step), retry. */
+            if (errno == ETIME) continue;
+            /* No message (e.g. interrupted). Return that to a waiting
+               consumer, and only receive again when it calls again. */
+            if (__atomic_load_n(&q->consumer_waiting, __ATOMIC_SEQ_CST)) {
+                demand = __atomic_load_n(&q->demand, __ATOMIC_SEQ_CST);
+                sem_post(&q->available);
+            }
+            _io_wait(q, false, demand);
+            continue;
+        }
+        if (length < 8) {
+            /* Shorter than a message (size prefix and root offset). */
+            q->dropped++;
+            continue;
+        }
+        s->length = length;
+        s->channel_name = channel_name;
+        q->received++;
+
+        __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+        sem_post(&q->available);
+    }
+
+    return NULL;
+}
+
+
+static int32_t _prefetch_recv_fbs(Endpoint* endpoint,
+    const char** channel_name, uint8_t** buffer, uint32_t* buffer_length)
+{
+    PrefetchQueue* q = endpoint->prefetch;
+
+    /* Waiting is set before demand, see _prefetch_thread(). */
+    __atomic_store_n(&q->consumer_waiting, true, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&q->demand, 1, __ATOMIC_SEQ_CST);
+    _io_wake(q);
+
+    /* Wait for a message (the semaphore counts queued messages). */
+    double          timeout = endpoint_recv_timeout(endpoint, q->timeout);
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)timeout;
+    ts.tv_nsec += (long)((timeout - (time_t)timeout) * 1e9);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(&q->available, &ts) != 0) {
+        if (errno == EINTR) continue;
+        __atomic_store_n(&q->consumer_waiting, false, __ATOMIC_SEQ_CST);
+        if (errno == ETIMEDOUT) errno = ETIME;
+        return -1; /* Caller must inspect errno to determine cause. */
+    }
+    __atomic_store_n(&q->consumer_waiting, false, __ATOMIC_SEQ_CST);
+
+    uint32_t tail = q->tail;
+    if (__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == tail) {
+        /* Woken by an interrupt, or the transport returned no message. */
+        *channel_name = NULL;
+        errno = ECANCELED;
+        return 0;
+    }
+
+    /* Swap the buffers (both are malloc/realloc managed). */
+    PrefetchSlot* s = &q->slot[tail & (PREFETCH_QUEUE_SLOTS - 1)];
+    uint8_t*      _buffer = *buffer;
+    uint32_t      _buffer_length = *buffer_length;
+    *buffer = s->buffer;
+    *buffer_length = s->buffer_length;
+    s->buffer = _buffer;
+    s->buffer_length = _buffer_length;
+    *channel_name = s->channel_name;
+    int32_t length = s->length;
+
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_SEQ_CST);
+    _io_wake(q);
+    return length;
+}
+
+
+/* The I/O thread continues to run (i.e. to receive the exit handshake), only
+   the consumer is woken. */
+static void _prefetch_interrupt(Endpoint* endpoint)
+{
+    PrefetchQueue* q = endpoint->prefetch;
+
+    if (q->interrupt && q->interrupt_mt) {
+        q->interrupt(endpoint);
+    } else {
+        __atomic_store_n(&endpoint->stop_request, true, __ATOMIC_SEQ_CST);
+    }
+    sem_post(&q->available);
+}
+
+
+static void _prefetch_disconnect(Endpoint* endpoint)
+{
+    EndpointDisconnectFunc disconnect =
+        ((PrefetchQueue*)endpoint->prefetch)->disconnect;
+
+    endpoint_prefetch_stop(endpoint);
+    if (disconnect) disconnect(endpoint);
+}
+
+
+/**
+ *  endpoint_prefetch_start
+ *
+ *  Start the I/O thread of an Endpoint. Should be called after the Endpoint
+ *  is started (i.e. all channels are created and subscribed).
+ *
+ *  Parameters
+ *  ----------
+ *  endpoint : Endpoint*
+ *      The Endpoint object.
+ *  transport : const char*
+ *      The transport of the Endpoint (prefetch is only enabled for supported
+ *      transports).
+ *  timeout : double
+ *      The timeout (seconds) when waiting for messages.
+ *
+ *  Returns
+ *  -------
+ *      0 : The I/O thread is running.
+ *      -1 : Prefetch was not enabled (errno is set).
+ */
+DLL_PRIVATE int endpoint_prefetch_start(
+    Endpoint* endpoint, const char* transport, double timeout)
+{
+    if (endpoint == NULL || transport == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (endpoint->prefetch) return 0;
+
+    bool interrupt_mt = false;
+    if (endpoint_thread_transport(transport, &interrupt_mt) == NULL) {
+        log_notice("Prefetch not supported by transport: %s", transport);
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    PrefetchQueue* q = calloc(1, sizeof(PrefetchQueue));
+    if (q == NULL) {
+        log_error("Prefetch queue malloc failed!");
+        errno = ENOMEM;
+        return -1;
+    }
+    q->endpoint = endpoint;
+    q->timeout = timeout;
+    q->recv_fbs = endpoint->recv_fbs;
+    q->interrupt = endpoint->interrupt;
+    q->disconnect = endpoint->disconnect;
+    q->interrupt_mt = interrupt_mt;
+    if (sem_init(&q->available, 0, 0)) {
+        log_error("Prefetch semaphore could not be created!");
+        free(q);
+        return -1;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    endpoint->prefetch = q;
+    if (pthread_create(&q->thread, NULL, _prefetch_thread, q)) {
+        log_error("Prefetch thread could not be started!");
+        pthread_cond_destroy(&q->cond);
+        pthread_mutex_destroy(&q->lock);
+        sem_destroy(&q->available);
+        endpoint->prefetch = NULL;
+        free(q);
+        return -1;
+    }
+    endpoint->recv_fbs = _prefetch_recv_fbs;
+    endpoint->interrupt = _prefetch_interrupt;
+    endpoint->disconnect = _prefetch_disconnect;
+    log_notice("Prefetch: I/O thread started (%s)", transport);
+
+    return 0;
+}
+
+
+/**
+ *  endpoint_prefetch_stop
+ *
+ *  Stop the I/O thread and restore the Endpoint transport functions. Any
+ *  messages remaining in the queue are discarded. Called when the Endpoint
+ *  is disconnected (the Endpoint is also marked as stopped).
+ */
+DLL_PRIVATE void endpoint_prefetch_stop(Endpoint* endpoint)
+{
+    if (endpoint == NULL || endpoint->prefetch == NULL) return;
+    PrefetchQueue* q = endpoint->prefetch;
+
+    /* Wake the I/O thread, and break a blocking receive of the transport
+       (or let it return at its next timeout, see __supported_transports). */
+    __atomic_store_n(&q->stop_request, true, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&q->lock);
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+    __atomic_store_n(&endpoint->stop_request, true, __ATOMIC_SEQ_CST);
+    if (q->interrupt && q->interrupt_mt) q->interrupt(endpoint);
+    pthread_join(q->thread, NULL);
+    endpoint->recv_fbs = q->recv_fbs;
+    endpoint->interrupt = q->interrupt;
+    endpoint->disconnect = q->disconnect;
+    endpoint->prefetch = NULL;
+
+    log_notice("Prefetch: received=%" PRIu64 ", dropped=%" PRIu64
+               ", full=%" PRIu64,
+        q->received, q->dropped, q->full);
+    for (uint32_t i = 0; i < PREFETCH_QUEUE_SLOTS; i++) {
+        free(q->slot[i].buffer);
+    }
+    pthread_cond_destroy(&q->cond);
+    pthread_mutex_destroy(&q->lock);
+    sem_destroy(&q->available);
+    free(q);
+}
@@ -0,0 +1,50 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_TRANSPORT_PREFETCH_H_
+#define DSE_MODELC_ADAPTER_TRANSPORT_PREFETCH_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/platform.h>
+
+
+#define PREFETCH_ANNOTATION  "prefetch"
+#define PREFETCH_QUEUE_SLOTS 64 /* Must be a power of 2. */
+
+
+/*
+Endpoint Prefetch
+-----------------
+
+An I/O thread receives from the Endpoint transport (including the transport
+envelope decode) while the Model is still stepping. Each received message
+stream is pushed to a single producer/single consumer queue. The Endpoint
+recv_fbs() is replaced with a function which consumes from that queue
+(swapping buffers with the caller, no copy). The I/O thread waits on a
+condition variable when the queue is full, or after the transport returned
+no message (e.g. interrupted) until the consumer calls recv_fbs() again.
+
+Enabled with a Stack annotation (spec/models[]/annotations/prefetch: true),
+and only for transports with independent send and receive connections.
+*/
+typedef struct PrefetchSlot {
+    uint8_t*    buffer;
+    uint32_t    buffer_length;
+    int32_t     length;
+    const char* channel_name;
+} PrefetchSlot;
+
+
+/* prefetch.c */
+DLL_PRIVATE const char* endpoint_thread_transport(
+    const char* transport, bool* interrupt_mt);
+DLL_PRIVATE int         endpoint_prefetch_start(
+            Endpoint* endpoint, const char* transport, double timeout);
+DLL_PRIVATE void        endpoint_prefetch_stop(Endpoint* endpoint);
+
+
+#endif  // DSE_MODELC_ADAPTER_TRANSPORT_PREFETCH_H_
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
+#include <math.h>
 #include <msgpack.h>
 #include <hiredis/adapters/libevent.h>
 #include <dse/logger.h>
@@ -373,7 +374,13 @@ int32_t redis_recv_fbs(Endpoint* endpoint, const char** channel_name,
     RedisEndpoint* redis_ep = (RedisEndpoint*)endpoint->private;
     assert(redis_ep->ctx);
 
-    int timeout_counter = (int32_t)redis_ep->recv_timeout + 1;
+    double timeout = endpoint_recv_timeout(endpoint, redis_ep->recv_timeout);
+    /* BRPOP in intervals of 1 second (or the bound, if shorter, Redis 6+). */
+    double interval = 1.0;
+    if (redis_ep->major_ver >= 6 && timeout > 0.0 && timeout < 1.0) {
+        interval = timeout;
+    }
+    int timeout_counter = (int32_t)ceil(timeout / interval) + 1;
 
 
     *channel_name = NULL; /* Set the default return condition. */
@@ -399,7 +406,8 @@ int32_t redis_recv_fbs(Endpoint* endpoint, const char** channel_name,
         if (redis_ep->async_ctx) {
             if (redis_ep->major_ver >= 6) {
                 redisAsyncCommand(redis_ep->async_ctx, _redis_async_brpop,
-                    redis_ep, "BRPOP %s %f", redis_ep->pull.endpoint, 1.0);
+                    redis_ep, "BRPOP %s %f", redis_ep->pull.endpoint,
+                    interval);
             } else {
                 redisAsyncCommand(redis_ep->async_ctx, _redis_async_brpop,
                     redis_ep, "BRPOP %s %d", redis_ep->pull.endpoint, 1);
@@ -407,8 +415,8 @@ int32_t redis_recv_fbs(Endpoint* endpoint, const char** channel_name,
             event_base_dispatch(redis_ep->base);
         } else {
             if (redis_ep->major_ver >= 6) {
-                reply = redisCommand(
-                    redis_ep->ctx, "BRPOP %s %f", redis_ep->pull.endpoint, 1.0);
+                reply = redisCommand(redis_ep->ctx, "BRPOP %s %f",
+                    redis_ep->pull.endpoint, interval);
             } else {
                 reply = redisCommand(
                     redis_ep->ctx, "BRPOP %s %d", redis_ep->pull.endpoint, 1);
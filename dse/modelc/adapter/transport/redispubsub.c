@@ -8,10 +8,12 @@
 #include <unistd.h>
 #include <errno.h>
 #include <assert.h>
+#include <math.h>
 #include <hiredis.h>
 #include <hiredis/async.h>
 #include <hiredis/adapters/libevent.h>
 #include <dse/logger.h>
+#include <dse/modelc/adapter/memstat.h>
 #include <dse/modelc/adapter/transport/redispubsub.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
 
@@ -23,6 +25,22 @@
 #define UNUSED(x)                ((void)x)
 #define NOTIFY_MODEL_KEY         "bus.notify.model"
 #define NOTIFY_SIMBUS_KEY        "bus.notify.simbus"
+#define UID_KEY_LEN              12
+
+
+/*
+Channel Keys
+------------
+
+Models publish Channel Messages on the key `bus.ch.<name>.tx` and the SimBus
+publishes on the key `bus.ch.<name>.rx`. A Channel Message sent by the SimBus
+is always for one Model (the response to a request), so each Model also
+subscribes to a per Model key `bus.ch.<name>.rx.<uid>` (for each Model UID
+hosted by the Endpoint). The SimBus publishes on the per Model key, and only
+when no client receives the message (i.e. a Model which does not subscribe to
+per Model keys) is the message published on the shared key, which all Models
+of the channel receive.
+*/
 
 
 void redispubsub_on_message(
@@ -46,12 +64,15 @@ static void redis_endpoint_destroy(Endpoint* endpoint)
         /* Release the endpoint_channels hashmap, this is only a lookup, so
         there is no need to release the contained objects. */
         hashmap_destroy(&redis_ep->endpoint_lookup);
+        hashmap_destroy(&redis_ep->shared_reply);
         /* Free any items in the queue. */
         queue_node* n;
         q_traverse(redis_ep->recv_msg_queue, n)
         {
             RedisPubSubMessage* msg = (RedisPubSubMessage*)n->data;
-            free(msg->buffer);
+            memstat_free(MEMSTAT_TRANSPORT, msg->buffer);
+            memstat_add(
+                MEMSTAT_TRANSPORT, -(int64_t)sizeof(RedisPubSubMessage));
         }
         q_free_alt(redis_ep->recv_msg_queue, true);
         /* Release the RedisPubSubEndpoint object. */
@@ -66,6 +87,10 @@ static void redis_endpoint_destroy(Endpoint* endpoint)
                 hashmap_get(&endpoint->endpoint_channels, keys[i]);
             if (ch->pub_key) free(ch->pub_key);
             if (ch->sub_key) free(ch->sub_key);
+            for (uint32_t j = 0; j < ch->uid_sub_key_count; j++) {
+                free(ch->uid_sub_key[j]);
+            }
+            free(ch->uid_sub_key);
             free(ch);
         }
         hashmap_destroy(&endpoint->endpoint_channels);
@@ -117,6 +142,12 @@ Endpoint* redispubsub_connect(const char* path, const char* hostname,
         if (errno == 0) errno = rc;
         goto error_clean_up;
     }
+    rc = hashmap_init(&redis_ep->shared_reply);
+    if (rc) {
+        log_error("Hashmap init failed for redis_ep->shared_reply!");
+        if (errno == 0) errno = rc;
+        goto error_clean_up;
+    }
     redis_ep->recv_msg_queue = q_init();
     endpoint->private = (void*)redis_ep;
 
@@ -282,22 +313,44 @@ int32_t redispubsub_start(Endpoint* endpoint)
     redis_ep->sub_event_base = event_base_new();
     redisLibeventAttach(redis_ep->sub_ctx, redis_ep->sub_event_base);
 
-    /* Build the SUB command. */
+    /* Per Model keys (RX direction), Models only. */
     char**   keys = hashmap_keys(&endpoint->endpoint_channels);
     uint32_t count = hashmap_number_keys(endpoint->endpoint_channels);
+    uint32_t uid_count = endpoint->bus_mode ? 0 : endpoint->model_uid_count;
+    for (uint32_t i = 0; i < count; i++) {
+        RedisPubSubChannel* ch =
+            hashmap_get(&endpoint->endpoint_channels, keys[i]);
+        if (uid_count == 0 || ch->uid_sub_key) continue;
+        ch->uid_sub_key = calloc(uid_count, sizeof(char*));
+        ch->uid_sub_key_count = uid_count;
+        for (uint32_t j = 0; j < uid_count; j++) {
+            ch->uid_sub_key[j] = calloc(1, MAX_KEY_SIZE);
+            snprintf(ch->uid_sub_key[j], MAX_KEY_SIZE - 1, "%s.%u",
+                ch->sub_key, endpoint->model_uid[j]);
+            hashmap_set(&redis_ep->endpoint_lookup, ch->uid_sub_key[j], ch);
+            log_notice("  Sub Key: %s", ch->uid_sub_key[j]);
+        }
+    }
+
+    /* Build the SUB command. */
     log_trace("Endpoint channel keys : %u", count);
-    redis_ep->sub__argc = count + 1 + 1;  // + cmd + notify
+    redis_ep->sub__argc = count * (1 + uid_count) + 1 + 1;  // + cmd + notify
     redis_ep->sub__argv = calloc(redis_ep->sub__argc, sizeof(char*));
     redis_ep->sub__argv[0] = calloc(1, MAX_KEY_SIZE);
     snprintf(redis_ep->sub__argv[0], MAX_KEY_SIZE - 1, "SUBSCRIBE");
     redis_ep->sub__argv[1] = calloc(1, MAX_KEY_SIZE);
     snprintf(redis_ep->sub__argv[1], MAX_KEY_SIZE - 1,
         endpoint->bus_mode ? NOTIFY_SIMBUS_KEY : NOTIFY_MODEL_KEY);
+    int argi = 1 + 1;
     for (uint32_t i = 0; i < count; i++) {
         RedisPubSubChannel* ch =
             hashmap_get(&endpoint->endpoint_channels, keys[i]);
-        redis_ep->sub__argv[i + 1 + 1] = ch->sub_key;
+        redis_ep->sub__argv[argi++] = ch->sub_key;
+        for (uint32_t j = 0; j < ch->uid_sub_key_count; j++) {
+            redis_ep->sub__argv[argi++] = ch->uid_sub_key[j];
+        }
     }
+    redis_ep->sub__argc = argi;
     for (uint32_t _ = 0; _ < count; _++)
         free(keys[_]);
     free(keys);
@@ -344,10 +397,32 @@ int32_t redispubsub_start(Endpoint* endpoint)
 }
 
 
+static const char* _reply_key(RedisPubSubEndpoint* redis_ep,
+    RedisPubSubChannel* ch, uint32_t model_uid, char* key)
+{
+    char uid_key[UID_KEY_LEN];
+    snprintf(uid_key, UID_KEY_LEN, "%u", model_uid);
+    if (model_uid == 0 || hashmap_get(&redis_ep->shared_reply, uid_key)) {
+        return ch->pub_key;
+    }
+    snprintf(key, MAX_KEY_SIZE - 1, "%s.%u", ch->pub_key, model_uid);
+    return key;
+}
+
+
+static void _set_shared_reply(RedisPubSubEndpoint* redis_ep, uint32_t model_uid)
+{
+    char uid_key[UID_KEY_LEN];
+    snprintf(uid_key, UID_KEY_LEN, "%u", model_uid);
+    hashmap_set(&redis_ep->shared_reply, uid_key, redis_ep);
+    log_notice("redispubsub: model_uid=%u replied on the shared key",
+        model_uid);
+}
+
+
 int32_t redispubsub_send_fbs(Endpoint* endpoint, void* endpoint_channel,
     void* buffer, uint32_t buffer_length, uint32_t model_uid)
 {
-    UNUSED(model_uid);
     assert(endpoint);
     assert(endpoint->private);
 
@@ -358,6 +433,11 @@ int32_t redispubsub_send_fbs(Endpoint* endpoint, void* endpoint_channel,
     if (endpoint_channel) {
         /* Sending a Channel Message. */
         RedisPubSubChannel* ch = (RedisPubSubChannel*)endpoint_channel;
+        char                key[MAX_KEY_SIZE] = { 0 };
+        const char*         pub_key = ch->pub_key;
+        if (endpoint->bus_mode) {
+            pub_key = _reply_key(redis_ep, ch, model_uid, key);
+        }
 
         /** Models first connecting to a SimBus may send messages before the
          *  SimBus has started. As a result, messages are lost. This is a
@@ -367,15 +447,23 @@ int32_t redispubsub_send_fbs(Endpoint* endpoint, void* endpoint_channel,
         int retry_count = endpoint->bus_mode ? 1 : (int)redis_ep->recv_timeout;
         while (retry_count--) {
             redisReply* reply;
-            reply = redisCommand(redis_ep->ctx, "PUBLISH %s %b", ch->pub_key,
+            reply = redisCommand(redis_ep->ctx, "PUBLISH %s %b", pub_key,
                 buffer, (size_t)buffer_length);
             log_trace("redispubsub_send_fbs: message sent");
-            log_trace("redispubsub_send_fbs:     channel=%s", ch->pub_key);
+            log_trace("redispubsub_send_fbs:     channel=%s", pub_key);
             log_trace("redispubsub_send_fbs:     clients=%lld", reply->integer);
+            if (reply->integer == 0 && pub_key != ch->pub_key) {
+                /* The Model does not subscribe to per Model keys. */
+                freeReplyObject(reply);
+                _set_shared_reply(redis_ep, model_uid);
+                pub_key = ch->pub_key;
+                retry_count++;
+                continue;
+            }
             if (reply->integer == 0) {
                 log_notice("redispubsub_send_fbs: no clients received message!"
                            " channel=%s",
-                    ch->pub_key);
+                    pub_key);
                 freeReplyObject(reply);
 
                 if (endpoint->stop_request) {
@@ -420,14 +508,18 @@ int32_t redispubsub_recv_fbs(Endpoint* endpoint, const char** channel_name,
 
     /* Wait for a message, but only if the queue is empty. */
     if (q_num_elements(redis_ep->recv_msg_queue) == 0) {
-        /* Wait for a message. */
+        /* Wait for a message (the timeout event is every 1 second, a shorter
+           bound is rounded up). */
+        int32_t timeout_count = (int32_t)ceil(
+            endpoint_recv_timeout(endpoint, redis_ep->recv_timeout));
         event_timeout_counter = 0;
-        while (event_timeout_counter++ < (int32_t)redis_ep->recv_timeout) {
+        while (event_timeout_counter++ < timeout_count) {
             event_base_dispatch(redis_ep->sub_event_base);
             if (event_base_got_break(redis_ep->sub_event_base)) {
                 if (__event_timeout_condition__) {
                     /* Event timeout. */
                     __event_timeout_condition__ = 0;
+                    if (endpoint->stop_request) break;
                     continue;
                 } else {
                     /* A message arrived. */
@@ -439,7 +531,7 @@ int32_t redispubsub_recv_fbs(Endpoint* endpoint, const char** channel_name,
             log_error("Unexpected condition; event_base_dispatch() with no "
                       "indicators.");
         }
-        if (event_timeout_counter >= (int32_t)redis_ep->recv_timeout) {
+        if (event_timeout_counter > timeout_count) {
             log_trace("redispubsub_recv_fbs: no message (timeout)");
             errno = ETIME;
             return -1; /* Caller must inspect errno to determine cause. */
@@ -470,7 +562,8 @@ int32_t redispubsub_recv_fbs(Endpoint* endpoint, const char** channel_name,
         *channel_name = NULL;
     }
     int32_t rc = (uint32_t)msg->length;
-    free(msg->buffer);
+    memstat_free(MEMSTAT_TRANSPORT, msg->buffer);
+    memstat_add(MEMSTAT_TRANSPORT, -(int64_t)sizeof(RedisPubSubMessage));
     free(msg);
     /* Return the buffer length (+ve) as indicator of success. */
     return rc;
@@ -519,9 +612,11 @@ void redispubsub_on_message(
         log_trace("redispubsub_on_message:     length=%d",
             (int32_t)reply->element[2]->len);
         /* Copy the FBS Message into the queue. */
+        /* Message object is released by recv, or by the queue on destroy. */
         RedisPubSubMessage* msg = calloc(1, sizeof(RedisPubSubMessage));
+        memstat_add(MEMSTAT_TRANSPORT, sizeof(RedisPubSubMessage));
         msg->length = reply->element[2]->len;
-        msg->buffer = malloc(msg->length);
+        msg->buffer = memstat_malloc(MEMSTAT_TRANSPORT, msg->length);
         memcpy(msg->buffer, reply->element[2]->str, msg->length);
         msg->endpoint_channel =
             hashmap_get(&redis_ep->endpoint_lookup, reply->element[1]->str);
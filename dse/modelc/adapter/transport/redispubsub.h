@@ -17,6 +17,9 @@
 typedef struct RedisPubSubChannel {
     char*       pub_key; /* TX direction. */
     char*       sub_key; /* RX direction. */
+    /* RX direction, per Model keys (sub_key.<uid>, Model only). */
+    char**      uid_sub_key;
+    uint32_t    uid_sub_key_count;
     /* Reference to the Adapter Channel linked to this Endpoint. */
     const char* channel_name;
 } RedisPubSubChannel;
@@ -43,6 +46,8 @@ typedef struct RedisPubSubEndpoint {
     bool               sub_active;
     double             recv_timeout;
     HashMap            endpoint_lookup;
+    /* Model UIDs which are replied on the shared key (SimBus only). */
+    HashMap            shared_reply;
     /* Recv on_message supporting properties. */
     queue_list_t       recv_msg_queue;
 } RedisPubSubEndpoint;
@@ -0,0 +1,607 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+#include <hiredis.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/adapter/transport/redisstreams.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+
+
+#define REDIS_CONNECTION_TIMEOUT 5 /* Double, seconds. */
+#define MAX_KEY_SIZE             REDISSTREAMS_MAX_KEY_SIZE
+#define UNUSED(x)                ((void)x)
+#define NOTIFY_MODEL_KEY         "bus.notify.model"
+#define NOTIFY_SIMBUS_KEY        "bus.notify.simbus"
+#define SIMBUS_PRESENCE_KEY      "bus.streams.simbus"
+#define STREAM_MAXLEN            10000 /* Approximate (MAXLEN ~). */
+#define XREAD_COUNT              "64"  /* Entries per stream, per XREAD. */
+#define XREAD_BLOCK_MS           1000
+#define XREAD_ARGC_FIXED         6 /* XREAD COUNT n BLOCK ms STREAMS */
+
+
+static void redis_endpoint_destroy(Endpoint* endpoint)
+{
+    if (endpoint && endpoint->private) {
+        RedisStreamsEndpoint* redis_ep =
+            (RedisStreamsEndpoint*)endpoint->private;
+        if (redis_ep->ctx) redisFree(redis_ep->ctx);
+        if (redis_ep->rx_ctx) redisFree(redis_ep->rx_ctx);
+        free(redis_ep->rx__argv);
+        free(redis_ep->rx_stream);
+        hashmap_destroy(&redis_ep->sender_seq);
+        /* Free any items in the queue. */
+        queue_node* n;
+        q_traverse(redis_ep->recv_msg_queue, n)
+        {
+            RedisStreamsMessage* msg = (RedisStreamsMessage*)n->data;
+            memstat_free(MEMSTAT_TRANSPORT, msg->buffer);
+            memstat_add(
+                MEMSTAT_TRANSPORT, -(int64_t)sizeof(RedisStreamsMessage));
+        }
+        q_free_alt(redis_ep->recv_msg_queue, true);
+        /* Release the RedisStreamsEndpoint object. */
+        free(endpoint->private);
+    }
+    if (endpoint) {
+        /* Release the endpoint_channels hashmap. */
+        char**   keys = hashmap_keys(&endpoint->endpoint_channels);
+        uint32_t count = hashmap_number_keys(endpoint->endpoint_channels);
+        for (uint32_t i = 0; i < count; i++) {
+            free(hashmap_get(&endpoint->endpoint_channels, keys[i]));
+        }
+        hashmap_destroy(&endpoint->endpoint_channels);
+        for (uint32_t _ = 0; _ < count; _++)
+            free(keys[_]);
+        free(keys);
+    }
+    free(endpoint);
+}
+
+
+static redisContext* _connect(RedisStreamsEndpoint* redis_ep)
+{
+    struct timeval timeout = { REDIS_CONNECTION_TIMEOUT, 0 };
+    redisContext*  ctx = NULL;
+
+    if (redis_ep->hostname) {
+        ctx = redisConnectWithTimeout(
+            redis_ep->hostname, redis_ep->port, timeout);
+    } else if (redis_ep->path) {
+        ctx = redisConnectUnixWithTimeout(redis_ep->path, timeout);
+    } else {
+        log_fatal("Redis Streams connect parameters not complete.");
+    }
+    if (ctx == NULL || ctx->err) {
+        if (ctx) {
+            log_notice("Connection error: %s", ctx->errstr);
+            redisFree(ctx);
+        } else {
+            log_error("Connection error: can't allocate Redis context");
+        }
+        return NULL;
+    }
+
+    return ctx;
+}
+
+
+Endpoint* redisstreams_connect(const char* path, const char* hostname,
+    int32_t port, uint32_t model_uid, bool bus_mode, double recv_timeout)
+{
+    int       rc;
+    /* Endpoint. */
+    Endpoint* endpoint = calloc(1, sizeof(Endpoint));
+    if (endpoint == NULL) {
+        log_error("Endpoint malloc failed!");
+        goto error_clean_up;
+    }
+    endpoint->bus_mode = bus_mode;
+    endpoint->create_channel = redisstreams_create_channel;
+    endpoint->start = redisstreams_start;
+    endpoint->send_fbs = redisstreams_send_fbs;
+    endpoint->recv_fbs = redisstreams_recv_fbs;
+    endpoint->interrupt = redisstreams_interrupt;
+    endpoint->disconnect = redisstreams_disconnect;
+    rc = hashmap_init_alt(&endpoint->endpoint_channels, 16, NULL);
+    if (rc) {
+        log_error("Hashmap init failed for endpoint->endpoint_channels!");
+        if (errno == 0) errno = rc;
+        goto error_clean_up;
+    }
+
+    /* Redis Endpoint. */
+    RedisStreamsEndpoint* redis_ep = calloc(1, sizeof(RedisStreamsEndpoint));
+    if (redis_ep == NULL) {
+        log_error("Redis_ep malloc failed!");
+        goto error_clean_up;
+    }
+    redis_ep->path = path;
+    redis_ep->hostname = hostname;
+    redis_ep->port = port;
+    redis_ep->recv_timeout = recv_timeout;
+    rc = hashmap_init_alt(&redis_ep->sender_seq, 32, NULL);
+    if (rc) {
+        log_error("Hashmap init failed for redis_ep->sender_seq!");
+        if (errno == 0) errno = rc;
+        goto error_clean_up;
+    }
+    redis_ep->recv_msg_queue = q_init();
+    endpoint->private = (void*)redis_ep;
+
+    /* Redis connection - TX direction (XADD) all channels. */
+    log_notice("  Redis Streams:");
+    log_notice("    path: %s", redis_ep->path);
+    log_notice("    hostname: %s", redis_ep->hostname);
+    log_notice("    port: %d", redis_ep->port);
+    redis_ep->ctx = _connect(redis_ep);
+    if (redis_ep->ctx == NULL) goto error_clean_up;
+
+    /* Model UID. */
+    redisReply* reply;
+    reply = redisCommand(redis_ep->ctx, "CLIENT ID");
+    if (reply == NULL || reply->type != REDIS_REPLY_INTEGER) {
+        const char* err = ((redisContext*)redis_ep->ctx)->errstr;
+        if (reply && reply->type == REDIS_REPLY_ERROR) err = reply->str;
+        log_error("redis command CLIENT ID failed (%s)", err);
+        if (reply) freeReplyObject(reply);
+        errno = EIO;
+        goto error_clean_up;
+    }
+    redis_ep->client_id = reply->integer;
+    freeReplyObject(reply);
+    if (model_uid) {
+        endpoint->uid = model_uid;
+    } else {
+        endpoint->uid = redis_ep->client_id;
+    }
+
+    /* Log the Endpoint information. */
+    log_notice("  Endpoint: ");
+    log_notice("    Model UID: %i", endpoint->uid);
+    log_notice("    Client ID: %i", redis_ep->client_id);
+
+    return endpoint;
+
+error_clean_up:
+    redis_endpoint_destroy(endpoint);
+    return NULL;
+}
+
+
+void redisstreams_disconnect(Endpoint* endpoint)
+{
+    if (endpoint && endpoint->private) {
+        RedisStreamsEndpoint* redis_ep =
+            (RedisStreamsEndpoint*)endpoint->private;
+        if (endpoint->bus_mode && redis_ep->ctx) {
+            redisReply* _ = redisCommand(redis_ep->ctx, "DEL %s",
+                SIMBUS_PRESENCE_KEY);
+            if (_) freeReplyObject(_);
+        }
+        log_notice("Redis Streams: reads=%" PRIu64 ", received=%" PRIu64
+                   ", lost=%" PRIu64,
+            redis_ep->reads, redis_ep->received, redis_ep->lost);
+    }
+    redis_endpoint_destroy(endpoint);
+}
+
+
+void* redisstreams_create_channel(Endpoint* endpoint, const char* channel_name)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+
+    /* Check if the endpoint channel already exists. */
+    RedisStreamsChannel* endpoint_channel =
+        hashmap_get(&endpoint->endpoint_channels, channel_name);
+    if (endpoint_channel) {
+        assert(strcmp(endpoint_channel->channel_name, channel_name) == 0);
+        return (void*)endpoint_channel;
+    }
+
+    /* Create the RedisStreamsChannel object. */
+    endpoint_channel = calloc(1, sizeof(RedisStreamsChannel));
+    assert(endpoint_channel);
+    endpoint_channel->channel_name = channel_name;
+    if (endpoint->bus_mode) {
+        /* BUS Mode == reversed, send on RX (Model reads)... */
+        snprintf(endpoint_channel->tx_key, MAX_KEY_SIZE - 1, "bus.ch.%s.rx",
+            channel_name);
+        snprintf(endpoint_channel->rx_key, MAX_KEY_SIZE - 1, "bus.ch.%s.tx",
+            channel_name);
+    } else {
+        snprintf(endpoint_channel->tx_key, MAX_KEY_SIZE - 1, "bus.ch.%s.tx",
+            channel_name);
+        snprintf(endpoint_channel->rx_key, MAX_KEY_SIZE - 1, "bus.ch.%s.rx",
+            channel_name);
+    }
+
+    /* Add to Endpoint->endpoint_channels. */
+    if (hashmap_set(&endpoint->endpoint_channels, channel_name,
+            endpoint_channel) == NULL) {
+        assert(0);
+    }
+
+    log_notice("  TX Stream: %s", endpoint_channel->tx_key);
+    log_notice("  RX Stream: %s", endpoint_channel->rx_key);
+
+    /* Return the created object, to the caller (which will be an Adapter). */
+    return (void*)endpoint_channel;
+}
+
+
+static void _stream_set_last_id(RedisStreamsStream* s, const char* id)
+{
+    strncpy(s->last_id, id, REDISSTREAMS_ID_SIZE - 1);
+    char* p = NULL;
+    s->last_ms = strtoull(id, &p, 10);
+    s->last_seq = (p && *p == '-') ? strtoull(p + 1, NULL, 10) : 0;
+}
+
+
+static void _wait_for_simbus(Endpoint* endpoint)
+{
+    RedisStreamsEndpoint* redis_ep = (RedisStreamsEndpoint*)endpoint->private;
+
+    /** Messages sent before the SimBus has started are removed (when the
+     *  SimBus starts). Wait for the SimBus, according to the general receive
+     *  timeout.
+     */
+    int retry_count = (int)redis_ep->recv_timeout;
+    while (retry_count--) {
+        redisReply* reply =
+            redisCommand(redis_ep->ctx, "EXISTS %s", SIMBUS_PRESENCE_KEY);
+        long long exists = reply ? reply->integer : 0;
+        if (reply) freeReplyObject(reply);
+        if (exists) return;
+        if (endpoint->stop_request) return;
+        log_notice("redisstreams_start: waiting for SimBus ...");
+        sleep(1);
+    }
+    log_error("redisstreams_start: SimBus not present!");
+}
+
+
+int32_t redisstreams_start(Endpoint* endpoint)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    RedisStreamsEndpoint* redis_ep = (RedisStreamsEndpoint*)endpoint->private;
+
+    /* Redis connection - RX direction (XREAD) all channels. */
+    for (int i = 0; i < 60; i++) {
+        redis_ep->rx_ctx = _connect(redis_ep);
+        if (redis_ep->rx_ctx) break;
+        /* Otherwise retry. */
+        log_error("Redis connect failed!");
+        sleep(1);
+    }
+    if (redis_ep->rx_ctx == NULL) {
+        log_fatal("redisConnect() failed!");
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Build the RX streams (Notify stream first). */
+    char**   keys = hashmap_keys(&endpoint->endpoint_channels);
+    uint32_t count = hashmap_number_keys(endpoint->endpoint_channels);
+    redis_ep->rx_stream_count = count + 1;
+    redis_ep->rx_stream =
+        calloc(redis_ep->rx_stream_count, sizeof(RedisStreamsStream));
+    redis_ep->rx_stream[0].key =
+        endpoint->bus_mode ? NOTIFY_SIMBUS_KEY : NOTIFY_MODEL_KEY;
+    for (uint32_t i = 0; i < count; i++) {
+        RedisStreamsChannel* ch =
+            hashmap_get(&endpoint->endpoint_channels, keys[i]);
+        redis_ep->rx_stream[i + 1].key = ch->rx_key;
+        redis_ep->rx_stream[i + 1].endpoint_channel = ch;
+    }
+
+    if (endpoint->bus_mode) {
+        /* SimBus: remove previous state, then indicate presence. */
+        redisReply* _;
+        _ = redisCommand(redis_ep->ctx, "DEL %s %s", NOTIFY_MODEL_KEY,
+            NOTIFY_SIMBUS_KEY);
+        freeReplyObject(_);
+        for (uint32_t i = 0; i < count; i++) {
+            RedisStreamsChannel* ch =
+                hashmap_get(&endpoint->endpoint_channels, keys[i]);
+            _ = redisCommand(
+                redis_ep->ctx, "DEL %s %s", ch->tx_key, ch->rx_key);
+            freeReplyObject(_);
+        }
+        for (uint32_t i = 0; i < redis_ep->rx_stream_count; i++) {
+            _stream_set_last_id(&redis_ep->rx_stream[i], "0-0");
+        }
+        _ = redisCommand(redis_ep->ctx, "SET %s %u", SIMBUS_PRESENCE_KEY,
+            redis_ep->client_id);
+        freeReplyObject(_);
+    } else {
+        /* Model: read from the last entry of each stream. */
+        _wait_for_simbus(endpoint);
+        for (uint32_t i = 0; i < redis_ep->rx_stream_count; i++) {
+            RedisStreamsStream* s = &redis_ep->rx_stream[i];
+            redisReply*         reply = redisCommand(
+                redis_ep->ctx, "XREVRANGE %s + - COUNT 1", s->key);
+            if (reply && reply->type == REDIS_REPLY_ARRAY &&
+                reply->elements == 1) {
+                _stream_set_last_id(s, reply->element[0]->element[0]->str);
+            } else {
+                _stream_set_last_id(s, "0-0");
+            }
+            if (reply) freeReplyObject(reply);
+        }
+    }
+    for (uint32_t _ = 0; _ < count; _++)
+        free(keys[_]);
+    free(keys);
+
+    /* Build the XREAD command, the stream IDs are updated in place. */
+    redis_ep->rx__argc = XREAD_ARGC_FIXED + (redis_ep->rx_stream_count * 2);
+    redis_ep->rx__argv = calloc(redis_ep->rx__argc, sizeof(char*));
+    redis_ep->rx__argv[0] = "XREAD";
+    redis_ep->rx__argv[1] = "COUNT";
+    redis_ep->rx__argv[2] = XREAD_COUNT;
+    redis_ep->rx__argv[3] = "BLOCK";
+    redis_ep->rx__argv[4] = redis_ep->rx_block_ms;
+    redis_ep->rx__argv[5] = "STREAMS";
+    for (uint32_t i = 0; i < redis_ep->rx_stream_count; i++) {
+        RedisStreamsStream* s = &redis_ep->rx_stream[i];
+        redis_ep->rx__argv[XREAD_ARGC_FIXED + i] = s->key;
+        redis_ep->rx__argv[XREAD_ARGC_FIXED + redis_ep->rx_stream_count + i] =
+            s->last_id;
+        log_debug("Redis Streams: RX: %s (from %s)", s->key, s->last_id);
+    }
+
+    return 0;
+}
+
+
+int32_t redisstreams_send_fbs(Endpoint* endpoint, void* endpoint_channel,
+    void* buffer, uint32_t buffer_length, uint32_t model_uid)
+{
+    UNUSED(model_uid);
+    assert(endpoint);
+    assert(endpoint->private);
+    RedisStreamsEndpoint* redis_ep = (RedisStreamsEndpoint*)endpoint->private;
+    assert(redis_ep->ctx);
+
+    const char* key;
+    uint64_t    seq;
+    if (endpoint_channel) {
+        /* Sending a Channel Message. */
+        RedisStreamsChannel* ch = (RedisStreamsChannel*)endpoint_channel;
+        key = ch->tx_key;
+        seq = ++ch->tx_seq;
+    } else {
+        /* Sending a Notify Message. */
+        key = endpoint->bus_mode ? NOTIFY_MODEL_KEY : NOTIFY_SIMBUS_KEY;
+        seq = ++redis_ep->notify_seq;
+    }
+
+    redisReply* reply = redisCommand(redis_ep->ctx,
+        "XADD %s MAXLEN ~ %d * u %u n %llu d %b", key, STREAM_MAXLEN,
+        endpoint->uid, (unsigned long long)seq, buffer, (size_t)buffer_length);
+    if (reply == NULL || reply->type == REDIS_REPLY_ERROR) {
+        log_error("redisstreams_send_fbs: XADD failed (%s)",
+            reply ? reply->str : ((redisContext*)redis_ep->ctx)->errstr);
+        if (reply) freeReplyObject(reply);
+        errno = EIO;
+        return -1;
+    }
+    log_trace("redisstreams_send_fbs: message sent");
+    log_trace("redisstreams_send_fbs:     stream=%s, id=%s", key, reply->str);
+    freeReplyObject(reply);
+
+    return 0;
+}
+
+
+static RedisStreamsStream* _find_stream(
+    RedisStreamsEndpoint* redis_ep, const char* key)
+{
+    for (uint32_t i = 0; i < redis_ep->rx_stream_count; i++) {
+        if (strcmp(redis_ep->rx_stream[i].key, key) == 0) {
+            return &redis_ep->rx_stream[i];
+        }
+    }
+    return NULL;
+}
+
+
+static void _check_sender_seq(RedisStreamsEndpoint* redis_ep,
+    RedisStreamsStream* s, const char* uid, const char* n)
+{
+    if (uid == NULL || n == NULL) return;
+
+    char hash_key[MAX_KEY_SIZE + 16];
+    snprintf(hash_key, sizeof(hash_key), "%s:%s", s->key, uid);
+    int64_t  seq = strtoll(n, NULL, 10);
+    int64_t* last = hashmap_get(&redis_ep->sender_seq, hash_key);
+    if (last == NULL) {
+        hashmap_set_long(&redis_ep->sender_seq, hash_key, seq);
+        return;
+    }
+    if (seq > *last + 1) {
+        log_error("Redis Streams: %s lost %" PRId64
+                  " messages from sender %s (stream trimmed?)",
+            s->key, seq - *last - 1, uid);
+        redis_ep->lost += seq - *last - 1;
+    }
+    *last = seq;
+}
+
+
+static void _stream_entry(RedisStreamsEndpoint* redis_ep,
+    RedisStreamsStream* s, redisReply* entry)
+{
+    /* Entry: [ id, [ field, value, ... ] ] */
+    if (entry->type != REDIS_REPLY_ARRAY || entry->elements != 2) return;
+    const char* id = entry->element[0]->str;
+    redisReply* fields = entry->element[1];
+
+    /* Ordering check (IDs of a stream are strictly increasing). */
+    char*    p = NULL;
+    uint64_t ms = strtoull(id, &p, 10);
+    uint64_t seq = (p && *p == '-') ? strtoull(p + 1, NULL, 10) : 0;
+    if (ms < s->last_ms || (ms == s->last_ms && seq <= s->last_seq)) {
+        log_error("Redis Streams: %s entry out of order (%s after %s)", s->key,
+            id, s->last_id);
+        return;
+    }
+    _stream_set_last_id(s, id);
+
+    const char* uid = NULL;
+    const char* n = NULL;
+    redisReply* data = NULL;
+    for (size_t i = 0; i + 1 < fields->elements; i += 2) {
+        const char* f = fields->element[i]->str;
+        if (strcmp(f, "u") == 0) uid = fields->element[i + 1]->str;
+        if (strcmp(f, "n") == 0) n = fields->element[i + 1]->str;
+        if (strcmp(f, "d") == 0) data = fields->element[i + 1];
+    }
+    _check_sender_seq(redis_ep, s, uid, n);
+    if (data == NULL) return;
+
+    /* Copy the FBS Message into the queue. */
+    /* Message object is released by recv, or by the queue on destroy. */
+    RedisStreamsMessage* msg = calloc(1, sizeof(RedisStreamsMessage));
+    memstat_add(MEMSTAT_TRANSPORT, sizeof(RedisStreamsMessage));
+    msg->length = data->len;
+    msg->buffer = memstat_malloc(MEMSTAT_TRANSPORT, msg->length);
+    memcpy(msg->buffer, data->str, msg->length);
+    msg->endpoint_channel = s->endpoint_channel;
+    q_push(redis_ep->recv_msg_queue, msg);
+    redis_ep->received++;
+}
+
+
+/* Returns the number of queued messages, 0 on timeout, or -1 on error. */
+static int _xread(RedisStreamsEndpoint* redis_ep)
+{
+    redisReply* reply = redisCommandArgv(
+        redis_ep->rx_ctx, redis_ep->rx__argc, redis_ep->rx__argv, NULL);
+    if (reply == NULL) {
+        log_error("redis command XREAD failed (%s)",
+            ((redisContext*)redis_ep->rx_ctx)->errstr);
+        errno = EIO;
+        return -1;
+    }
+    redis_ep->reads++;
+    if (reply->type == REDIS_REPLY_NIL) {
+        /* Timeout. */
+        freeReplyObject(reply);
+        return 0;
+    }
+    if (reply->type != REDIS_REPLY_ARRAY) {
+        log_error("redis command XREAD failed (%s)",
+            reply->type == REDIS_REPLY_ERROR ? reply->str : "reply type");
+        freeReplyObject(reply);
+        errno = EIO;
+        return -1;
+    }
+
+    /* Reply: [ [ stream, [ entry, ... ] ], ... ] */
+    for (size_t i = 0; i < reply->elements; i++) {
+        redisReply* r = reply->element[i];
+        if (r->type != REDIS_REPLY_ARRAY || r->elements != 2) continue;
+        RedisStreamsStream* s = _find_stream(redis_ep, r->element[0]->str);
+        if (s == NULL) continue;
+        log_trace("redisstreams_recv_fbs: stream=%s, entries=%zu", s->key,
+            r->element[1]->elements);
+        for (size_t j = 0; j < r->element[1]->elements; j++) {
+            _stream_entry(redis_ep, s, r->element[1]->element[j]);
+        }
+    }
+    freeReplyObject(reply);
+
+    return q_num_elements(redis_ep->recv_msg_queue);
+}
+
+
+int32_t redisstreams_recv_fbs(Endpoint* endpoint, const char** channel_name,
+    uint8_t** buffer, uint32_t* buffer_length)
+{
+    assert(endpoint);
+    assert(endpoint->private);
+    assert(channel_name);
+    RedisStreamsEndpoint* redis_ep = (RedisStreamsEndpoint*)endpoint->private;
+    assert(redis_ep->rx_ctx);
+
+    /* Read a batch of messages, but only if the queue is empty. */
+    if (q_num_elements(redis_ep->recv_msg_queue) == 0) {
+        /* Blocking read for 1 second (or the bound, if shorter) at a time. */
+        double   timeout =
+            endpoint_recv_timeout(endpoint, redis_ep->recv_timeout);
+        uint32_t block_ms = XREAD_BLOCK_MS;
+        if (timeout > 0.0 && timeout * 1000 < block_ms) {
+            block_ms = (uint32_t)(timeout * 1000);
+            if (block_ms == 0) block_ms = 1; /* BLOCK 0 is indefinite. */
+        }
+        snprintf(redis_ep->rx_block_ms, sizeof(redis_ep->rx_block_ms), "%u",
+            block_ms);
+        int timeout_counter = 0;
+        int timeout_count = (int)ceil(timeout * 1000 / block_ms);
+        while (timeout_counter++ < timeout_count) {
+            if (endpoint->stop_request) break;
+            int rc = _xread(redis_ep);
+            if (rc < 0) return -1; /* errno is set. */
+            if (rc > 0) break;
+        }
+        if (q_num_elements(redis_ep->recv_msg_queue) == 0 &&
+            endpoint->stop_request == false) {
+            log_trace("redisstreams_recv_fbs: no message (timeout)");
+            errno = ETIME;
+            return -1; /* Caller must inspect errno to determine cause. */
+        }
+    }
+    /* Take the message and return to caller. */
+    RedisStreamsMessage* msg = q_pop(redis_ep->recv_msg_queue);
+    if (msg == NULL) {
+        /* No message, queue is empty. */
+        *channel_name = NULL;
+        return 0; /* Indicate that no message was received. */
+    }
+    /* Marshal data to caller. */
+    if (msg->length > *buffer_length) {
+        /* Prepare the buffer, resize if necessary. */
+        *buffer = realloc(*buffer, msg->length);
+        if (*buffer == NULL) {
+            log_error("Malloc failed!");
+        }
+        *buffer_length = (size_t)msg->length;
+    }
+    memset(*buffer, 0, *buffer_length);
+    memcpy(*buffer, msg->buffer, msg->length);
+    if (msg->endpoint_channel) {
+        *channel_name = msg->endpoint_channel->channel_name;
+    } else {
+        /* Notify message. */
+        *channel_name = NULL;
+    }
+    int32_t rc = (uint32_t)msg->length;
+    memstat_free(MEMSTAT_TRANSPORT, msg->buffer);
+    memstat_add(MEMSTAT_TRANSPORT, -(int64_t)sizeof(RedisStreamsMessage));
+    free(msg);
+    /* Return the buffer length (+ve) as indicator of success. */
+    return rc;
+}
+
+
+/* A blocked XREAD returns within XREAD_BLOCK_MS, then the stop request is
+   observed. */
+void redisstreams_interrupt(Endpoint* endpoint)
+{
+    assert(endpoint);
+    endpoint->stop_request = 1;
+}
@@ -0,0 +1,100 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_MODELC_ADAPTER_TRANSPORT_REDISSTREAMS_H_
+#define DSE_MODELC_ADAPTER_TRANSPORT_REDISSTREAMS_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/clib/collections/queue.h>
+#include <dse/platform.h>
+
+
+#define REDISSTREAMS_MAX_KEY_SIZE 64
+#define REDISSTREAMS_ID_SIZE      48 /* <ms>-<seq> */
+
+
+/*
+Redis Streams Transport
+-----------------------
+
+Each channel direction is a Redis Stream (same key names as the Redis Pub/Sub
+transport). Messages are appended with XADD (approximate MAXLEN trimming) and
+received with XREAD BLOCK COUNT, which returns all queued messages of all
+streams in one round-trip. The received batch is held in a local queue and
+consumed by subsequent calls to recv_fbs().
+
+Stream entries are ordered by their ID (<ms>-<seq>), each reader keeps the
+last ID of each stream. Entries also carry the sender UID and a per sender
+sequence number which is used to detect lost (i.e. trimmed) messages.
+*/
+typedef struct RedisStreamsChannel {
+    char        tx_key[REDISSTREAMS_MAX_KEY_SIZE];
+    char        rx_key[REDISSTREAMS_MAX_KEY_SIZE];
+    uint64_t    tx_seq;
+    /* Reference to the Adapter Channel linked to this Endpoint. */
+    const char* channel_name;
+} RedisStreamsChannel;
+
+typedef struct RedisStreamsStream {
+    const char*          key;
+    char                 last_id[REDISSTREAMS_ID_SIZE];
+    uint64_t             last_ms;
+    uint64_t             last_seq;
+    /* NULL for the Notify stream. */
+    RedisStreamsChannel* endpoint_channel;
+} RedisStreamsStream;
+
+typedef struct RedisStreamsMessage {
+    uint8_t*             buffer;
+    uint32_t             length;
+    RedisStreamsChannel* endpoint_channel;
+} RedisStreamsMessage;
+
+typedef struct RedisStreamsEndpoint {
+    /* Redis properties. */
+    const char*         path;     /* Unix Pipe. */
+    const char*         hostname; /* TCP */
+    int32_t             port;
+    void*               ctx;      /* TX direction. */
+    uint32_t            client_id;
+    uint64_t            notify_seq;
+    /* RX properties (blocking XREAD on a separate connection). */
+    void*               rx_ctx;
+    RedisStreamsStream* rx_stream;
+    uint32_t            rx_stream_count;
+    int                 rx__argc;
+    const char**        rx__argv;
+    char                rx_block_ms[16]; /* BLOCK argument of XREAD. */
+    double              recv_timeout;
+    HashMap             sender_seq; /* <stream>:<uid> -> int64_t */
+    /* Received batch. */
+    queue_list_t        recv_msg_queue;
+    /* Statistics. */
+    uint64_t            reads;
+    uint64_t            received;
+    uint64_t            lost;
+} RedisStreamsEndpoint;
+
+
+/* redisstreams.c */
+DLL_PRIVATE Endpoint* redisstreams_connect(const char* path,
+    const char* hostname, int32_t port, uint32_t model_uid, bool bus_mode,
+    double recv_timeout);
+DLL_PRIVATE void      redisstreams_disconnect(Endpoint* endpoint);
+DLL_PRIVATE int32_t   redisstreams_start(Endpoint* endpoint);
+DLL_PRIVATE void*     redisstreams_create_channel(
+        Endpoint* endpoint, const char* channel_name);
+DLL_PRIVATE int32_t redisstreams_send_fbs(Endpoint* endpoint,
+    void* endpoint_channel, void* buffer, uint32_t buffer_length,
+    uint32_t model_uid);
+DLL_PRIVATE int32_t redisstreams_recv_fbs(Endpoint* endpoint,
+    const char** channel_name, uint8_t** buffer, uint32_t* buffer_length);
+DLL_PRIVATE void    redisstreams_interrupt(Endpoint* endpoint);
+
+
+#endif  // DSE_MODELC_ADAPTER_TRANSPORT_REDISSTREAMS_H_
@@ -12,7 +12,12 @@
 #include <dse/clib/collections/hashmap.h>
 #include <dse/clib/util/strings.h>
 #include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/adapter/private.h>
+#include <dse/modelc/adapter/probe.h>
+#include <dse/modelc/adapter/timeline.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/adapter/transport/prefetch.h>
 #include <dse/modelc/controller/controller.h>
 #include <dse/modelc/controller/model_private.h>
 
@@ -20,7 +25,9 @@
 #define UNUSED(x) ((void)x)
 
 
-static Controller* __controller = NULL;
+/* One Controller per thread, in single-process mode each Model Instance runs
+   on a thread of its own (see modelc_run()). */
+static __thread Controller* __controller = NULL;
 
 
 DLL_PRIVATE Controller* controller_object_ref(void)
@@ -35,6 +42,8 @@ void controller_destroy(void)
     if (controller == NULL) return;
 
     if (controller->adapter) adapter_destroy(controller->adapter);
+    memstat_free(MEMSTAT_CONTROLLER, controller->marshal_plan);
+    free(controller->model_uid);
 
     free(__controller);
     __controller = NULL;
@@ -72,135 +81,247 @@ error_clean_up:
 
 
 int controller_init_channel(ModelInstanceSpec* model_instance,
-    const char* channel_name, const char** signal_name, uint32_t signal_count)
+    const char* channel_name, const char** signal_name, uint32_t signal_count,
+    SignalDeadband* signal_deadband)
 {
     assert(model_instance);
     ModelInstancePrivate* mip = model_instance->private;
     AdapterModel*         am = mip->adapter_model;
 
     log_notice("Init Controller channel: %s", channel_name);
-    adapter_init_channel(am, channel_name, signal_name, signal_count);
+    Channel* ch =
+        adapter_init_channel(am, channel_name, signal_name, signal_count);
+
+    /* Configure the change thresholds (deadband) of the signals. */
+    if (signal_deadband) {
+        for (uint32_t i = 0; i < signal_count; i++) {
+            adapter_set_signal_deadband(ch, signal_name[i],
+                signal_deadband[i].absolute, signal_deadband[i].relative);
+        }
+    }
 
     return 0;
 }
 
 
-typedef enum marshal_dir {
-    MARSHAL_ADAPTER2MODEL,
-    MARSHAL_MODEL2ADAPTER,
-} marshal_dir;
 typedef struct marshal_spec {
-    marshal_dir        dir;
     ModelInstanceSpec* mi;
+    MarshalItem*       plan;
+    uint32_t           count;
 } marshal_spec;
 
 
-static int __marshal__adapter2model(void* _mfc, void* _spec)
+static void __marshal__plan_append(marshal_spec* spec, MarshalItem item)
 {
-    ModelFunctionChannel* mfc = _mfc;
-    marshal_spec*         spec = _spec;
-    ModelInstancePrivate* mip = spec->mi->private;
-    AdapterModel*         am = mip->adapter_model;
-
-    if (mfc->signal_map == NULL) {
-        mfc->signal_map = adapter_get_signal_map(
-            am, mfc->channel_name, mfc->signal_names, mfc->signal_count);
-    }
-    SignalMap* sm = mfc->signal_map;
-
-    if (mfc->signal_value_double) {
-        controller_transform_to_model(mfc, sm);
-    }
-    if (mfc->signal_value_binary) {
-        for (uint32_t si = 0; si < mfc->signal_count; si++) {
-            dse_buffer_append(&mfc->signal_value_binary[si],
-                &mfc->signal_value_binary_size[si],
-                &mfc->signal_value_binary_buffer_size[si], sm[si].signal->bin,
-                sm[si].signal->bin_size);
-            /* Indicate the binary object was consumed. */
-            sm[si].signal->bin_size = 0;
-            /* Set the trigger to detect if the binary object is correctly
-               operated by the Model (i.e. calls reset()).*/
-            mfc->signal_value_binary_reset_called[si] = false;
-        }
-    }
-    return 0;
+    spec->plan = memstat_realloc(MEMSTAT_CONTROLLER, spec->plan,
+        (spec->count + 1) * sizeof(MarshalItem));
+    spec->plan[spec->count++] = item;
 }
-static int __marshal__model2adapter(void* _mfc, void* _spec)
+static int __marshal__plan_channel(void* _mfc, void* _spec)
 {
     ModelFunctionChannel* mfc = _mfc;
     marshal_spec*         spec = _spec;
     ModelInstancePrivate* mip = spec->mi->private;
     AdapterModel*         am = mip->adapter_model;
 
+    if (mfc->signal_count == 0) return 0;
     if (mfc->signal_map == NULL) {
         mfc->signal_map = adapter_get_signal_map(
             am, mfc->channel_name, mfc->signal_names, mfc->signal_count);
     }
-    SignalMap* sm = mfc->signal_map;
-
+    if (mfc->signal_map == NULL) return 0;
+
+    MarshalItem item = {
+        .count = mfc->signal_count,
+        .channel = adapter_get_channel(am, mfc->channel_name),
+        .signal_map = mfc->signal_map,
+        .mfc = mfc,
+    };
     if (mfc->signal_value_double) {
-        controller_transform_from_model(mfc, sm);
+        item.kind = (mfc->signal_transform) ? MARSHAL_KIND_DOUBLE_TRANSFORM
+                                            : MARSHAL_KIND_DOUBLE;
+        __marshal__plan_append(spec, item);
     }
     if (mfc->signal_value_binary) {
-        for (uint32_t si = 0; si < mfc->signal_count; si++) {
-            if (mfc->signal_value_binary_reset_called[si] == false) {
-                /* Force size to 0.
-                   Expected operation is: read, reset, write (append).
-                   If reset is not called, i.e. the Model does not consume
-                   _this_ signal, then data will be echo'ed back. If more than
-                   one model echoes data back, the SimBus may also echo back
-                   and ever increasing about of data. */
-                mfc->signal_value_binary_size[si] = 0;
-            }
-            dse_buffer_append(&sm[si].signal->bin, &sm[si].signal->bin_size,
-                &sm[si].signal->bin_buffer_size, mfc->signal_value_binary[si],
-                mfc->signal_value_binary_size[si]);
-            /* Indicate the binary object was consumed. */
-            mfc->signal_value_binary_size[si] = 0;
-        }
+        item.kind = MARSHAL_KIND_BINARY;
+        __marshal__plan_append(spec, item);
     }
     return 0;
 }
-static int __marshal__model_function(void* _mf, void* _spec)
+static int __marshal__plan_model_function(void* _mf, void* _spec)
 {
     ModelFunction* mf = _mf;
-    marshal_spec*  spec = _spec;
-    int            rc = 0;
-    switch (spec->dir) {
-    case MARSHAL_ADAPTER2MODEL:
-        rc = hashmap_iterator(
-            &mf->channels, __marshal__adapter2model, false, spec);
-        break;
-    case MARSHAL_MODEL2ADAPTER:
-        rc = hashmap_iterator(
-            &mf->channels, __marshal__model2adapter, false, spec);
-        break;
-    default:
-        break;
-    }
-    return rc;
-}
-static int __marshal__model(ControllerModel* cm, void* spec)
-{
-    int rc = 0;
-    rc = hashmap_iterator(
-        &cm->model_functions, __marshal__model_function, false, spec);
-    return rc;
+    return hashmap_iterator(
+        &mf->channels, __marshal__plan_channel, false, _spec);
 }
 
-static void marshal(SimulationSpec* sim, marshal_dir dir)
+
+/**
+ *  marshal_compile_plan
+ *
+ *  Compile the marshal operations of all Model Function Channels into a flat
+ *  array. The signal maps are resolved here (once) so that the per-step
+ *  marshal loops can operate without hash iteration or lazy checks.
+ *
+ *  Parameters
+ *  ----------
+ *  controller : Controller*
+ *      The controller object, the compiled plan is stored here.
+ *  sim : SimulationSpec*
+ *      The simulation, all Model Instances are included in the plan.
+ */
+static void marshal_compile_plan(Controller* controller, SimulationSpec* sim)
 {
     assert(sim);
+    marshal_spec spec = { 0 };
+
     ModelInstanceSpec* _instptr = sim->instance_list;
     while (_instptr && _instptr->name) {
-        marshal_spec          md = { dir, _instptr };
         ModelInstancePrivate* mip = _instptr->private;
         ControllerModel*      cm = mip->controller_model;
-        __marshal__model(cm, &md);
+        spec.mi = _instptr;
+        hashmap_iterator(&cm->model_functions, __marshal__plan_model_function,
+            false, &spec);
         /* Next instance? */
         _instptr++;
     }
+
+    memstat_free(MEMSTAT_CONTROLLER, controller->marshal_plan);
+    controller->marshal_plan = spec.plan;
+    controller->marshal_plan_count = spec.count;
+    log_debug("Marshal plan: %u operations", spec.count);
+}
+
+
+/* The timeline track (and time) of marshalling, the first Model Instance. */
+static AdapterModel* _timeline_model(SimulationSpec* sim)
+{
+    if (sim->instance_list == NULL || sim->instance_list->name == NULL) {
+        return NULL;
+    }
+    ModelInstancePrivate* mip = sim->instance_list->private;
+    return mip->adapter_model;
+}
+
+
+/* Clear the changed flags of the signals received on a channel (the changed
+   list, or all signals if that list is incomplete). */
+static void _clear_changed(Channel* ch)
+{
+    if (ch->changed.overflow) {
+        for (uint32_t i = 0; i < ch->index.count; i++) {
+            ch->index.map[i].signal->changed = false;
+        }
+        ch->changed.overflow = false;
+    } else {
+        for (uint32_t i = 0; i < ch->changed.count; i++) {
+            ch->changed.signal[i]->changed = false;
+        }
+    }
+    ch->changed.count = 0;
+}
+
+
+static void marshal_adapter2model(Controller* controller, SimulationSpec* sim)
+{
+    MarshalItem* plan = controller->marshal_plan;
+    uint32_t     count = controller->marshal_plan_count;
+    uint64_t     timeline_ts = timeline_begin();
+
+    PROBE1(marshal_in_begin, count);
+    for (uint32_t i = 0; i < count; i++) {
+        ModelFunctionChannel* mfc = plan[i].mfc;
+        SignalMap*            sm = plan[i].signal_map;
+        controller_changed_to_model(mfc, sm, plan[i].channel);
+        switch (plan[i].kind) {
+        case MARSHAL_KIND_DOUBLE:
+            for (uint32_t si = 0; si < plan[i].count; si++) {
+                mfc->signal_value_double[si] = sm[si].signal->val;
+            }
+            break;
+        case MARSHAL_KIND_DOUBLE_TRANSFORM:
+            controller_transform_to_model(mfc, sm);
+            break;
+        case MARSHAL_KIND_BINARY:
+            mfc->signal_value_binary_seq++;
+            for (uint32_t si = 0; si < plan[i].count; si++) {
+                dse_buffer_append(&mfc->signal_value_binary[si],
+                    &mfc->signal_value_binary_size[si],
+                    &mfc->signal_value_binary_buffer_size[si],
+                    sm[si].signal->bin, sm[si].signal->bin_size);
+                /* Indicate the binary object was consumed. */
+                sm[si].signal->bin_size = 0;
+                /* Set the trigger to detect if the binary object is correctly
+                   operated by the Model (i.e. calls reset()).*/
+                mfc->signal_value_binary_reset_called[si] = false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* Clear the changed flags, only after all items are marshalled (a signal
+       may be mapped to more than one Model Function Channel). */
+    for (uint32_t i = 0; i < count; i++) {
+        _clear_changed(plan[i].channel);
+    }
+    PROBE1(marshal_in_end, count);
+    AdapterModel* am = _timeline_model(sim);
+    if (am) {
+        timeline_end(TIMELINE_MARSHAL_IN, am->model_uid, am->model_time,
+            timeline_ts);
+    }
+}
+
+
+static void marshal_model2adapter(Controller* controller, SimulationSpec* sim)
+{
+    MarshalItem* plan = controller->marshal_plan;
+    uint32_t     count = controller->marshal_plan_count;
+    uint64_t     timeline_ts = timeline_begin();
+
+    PROBE1(marshal_out_begin, count);
+    for (uint32_t i = 0; i < count; i++) {
+        ModelFunctionChannel* mfc = plan[i].mfc;
+        SignalMap*            sm = plan[i].signal_map;
+        switch (plan[i].kind) {
+        case MARSHAL_KIND_DOUBLE:
+            for (uint32_t si = 0; si < plan[i].count; si++) {
+                sm[si].signal->final_val = mfc->signal_value_double[si];
+            }
+            break;
+        case MARSHAL_KIND_DOUBLE_TRANSFORM:
+            controller_transform_from_model(mfc, sm);
+            break;
+        case MARSHAL_KIND_BINARY:
+            for (uint32_t si = 0; si < plan[i].count; si++) {
+                if (mfc->signal_value_binary_reset_called[si] == false) {
+                    /* Force size to 0.
+                       Expected operation is: read, reset, write (append).
+                       If reset is not called, i.e. the Model does not consume
+                       _this_ signal, then data will be echo'ed back. If more
+                       than one model echoes data back, the SimBus may also
+                       echo back and ever increasing about of data. */
+                    mfc->signal_value_binary_size[si] = 0;
+                }
+                _signal_value_bin_append(plan[i].channel, sm[si].signal,
+                    mfc->signal_value_binary[si],
+                    mfc->signal_value_binary_size[si]);
+                /* Indicate the binary object was consumed. */
+                mfc->signal_value_binary_size[si] = 0;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    PROBE1(marshal_out_end, count);
+    AdapterModel* am = _timeline_model(sim);
+    if (am) {
+        timeline_end(TIMELINE_MARSHAL_OUT, am->model_uid, am->model_time,
+            timeline_ts);
+    }
 }
 
 
@@ -214,14 +335,32 @@ void controller_bus_ready(SimulationSpec* sim)
     Adapter* adapter = controller->adapter;
     assert(adapter->endpoint);
     Endpoint* endpoint = adapter->endpoint;
+    uint32_t  count = 0;
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        count++;
+    }
+    controller->model_uid = calloc(count + 1, sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        controller->model_uid[i] = sim->instance_list[i].uid;
+    }
+    endpoint->model_uid = controller->model_uid;
+    endpoint->model_uid_count = count;
     if (endpoint->start) endpoint->start(endpoint);
 
+    /* Receive on an I/O thread (the endpoint channels are now created). */
+    if (sim->prefetch) {
+        endpoint_prefetch_start(endpoint, sim->transport, sim->timeout);
+    }
+
     /* Connect with the bus. */
     adapter_connect(adapter, sim, 5);
     if (controller->stop_request) return;
 
     /* Register the signals with the bus. */
     adapter_register(adapter, sim);
+
+    /* Compile the marshal plan (signal maps are now stable). */
+    marshal_compile_plan(controller, sim);
 }
 
 
@@ -234,8 +373,15 @@ int controller_step(SimulationSpec* sim)
 
     int rc;
 
+    /* Reload the Models (requested, done between steps). */
+    if (controller_reload_requested()) {
+        rc = controller_reload_models(sim);
+        if (rc) return rc;
+    }
+
     /* Marshal data from Model Functions to Adapter Channels. */
-    marshal(sim, MARSHAL_MODEL2ADAPTER);
+    if (controller->marshal_plan == NULL) marshal_compile_plan(controller, sim);
+    marshal_model2adapter(controller, sim);
 
     /* ModelReady and wait on ModelStart.
 
@@ -251,7 +397,7 @@ int controller_step(SimulationSpec* sim)
     if (rc) return rc;
 
     /* Marshal data from Adapter Channels to Model Functions. */
-    marshal(sim, MARSHAL_ADAPTER2MODEL);
+    marshal_adapter2model(controller, sim);
 
 
     /* Model callbacks.
@@ -279,10 +425,17 @@ int controller_step_phased(SimulationSpec* sim)
     Adapter* adapter = controller->adapter;
     int rc;
 
+    /* Reload the Models (requested, done between steps). */
+    if (controller_reload_requested()) {
+        rc = controller_reload_models(sim);
+        if (rc) return rc;
+    }
+
     /* Pull data from SimBus. */
     rc = adapter_model_start(adapter, sim);  /* Causes time to progress. */
     if (rc) return rc;
-    marshal(sim, MARSHAL_ADAPTER2MODEL);
+    if (controller->marshal_plan == NULL) marshal_compile_plan(controller, sim);
+    marshal_adapter2model(controller, sim);
 
     /* Model callbacks.
      * These notify the model of the _next_ start and stop time, which the
@@ -298,7 +451,7 @@ int controller_step_phased(SimulationSpec* sim)
     if (end_time > 0 && end_time < model_time) return 1;
 
     /* Push data to SimBus. */
-    marshal(sim, MARSHAL_MODEL2ADAPTER);
+    marshal_model2adapter(controller, sim);
     rc = adapter_model_ready(adapter, sim);
     if (rc) return rc;
 
@@ -323,6 +476,10 @@ void controller_run(SimulationSpec* sim)
             errno = ECANCELED;
             break;
         }
+        if (memstat_dump_requested()) {
+            controller_dump_memory();
+            controller_dump_stats();
+        }
         int rc = controller_step(sim);
         if (rc != 0) break;
     }
@@ -332,7 +489,13 @@ void controller_run(SimulationSpec* sim)
 /* Called from an interrupt. Indicate that controller_run() should exit. */
 void controller_stop(void)
 {
-    Controller* controller = __controller;
+    controller_interrupt(__controller);
+}
+
+
+/* As controller_stop(), for the Controller of another thread. */
+void controller_interrupt(Controller* controller)
+{
     if (controller == NULL) return;
 
     controller->stop_request = true;
@@ -350,6 +513,27 @@ void controller_dump_debug(void)
 }
 
 
+void controller_dump_memory(void)
+{
+    Controller* controller = __controller;
+
+    memstat_print("ModelC");
+    if (controller && controller->adapter) {
+        adapter_dump_memory(controller->adapter, controller->simulation);
+    }
+}
+
+
+void controller_dump_stats(void)
+{
+    Controller* controller = __controller;
+
+    if (controller && controller->adapter) {
+        adapter_dump_stats(controller->adapter, controller->simulation);
+    }
+}
+
+
 void controller_exit(SimulationSpec* sim)
 {
     Controller* controller = __controller;
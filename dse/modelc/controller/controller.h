@@ -24,6 +24,13 @@ typedef struct SignalTransform {
 } SignalTransform;
 
 
+typedef struct SignalDeadband {
+    /* Change thresholds, a threshold is disabled when 0 (default). */
+    double absolute;
+    double relative; /* Relative to the last transmitted value. */
+} SignalDeadband;
+
+
 typedef struct ModelFunctionChannel {
     const char*  channel_name;
     const char** signal_names;
@@ -40,9 +47,24 @@ typedef struct ModelFunctionChannel {
     uint32_t* signal_value_binary_size;
     uint32_t* signal_value_binary_buffer_size;
     bool*     signal_value_binary_reset_called;
+    /* Incremented when binary data is marshalled (from the Adapter), the
+       frame index of a binary signal stream is then rebuilt. */
+    uint32_t  signal_value_binary_seq;
+
+    /* Indexes of the signals changed by the most recent marshal (from the
+       Adapter), see signal_changed(). */
+    uint32_t* signal_changed;
+    uint32_t  signal_changed_count;
+    /* Channel index position to signal index (+1, 0 = not mapped), built
+       for the channel index identified by the hash code. */
+    uint32_t* signal_changed_map;
+    uint32_t  signal_changed_map_count;
+    uint32_t  signal_changed_map_hash_code;
 
     /* Signal Transform; only allocated if transforms are present. */
     SignalTransform* signal_transform;
+    /* Signal Deadband; only allocated if deadbands are present. */
+    SignalDeadband*  signal_deadband;
 } ModelFunctionChannel;
 
 
@@ -58,6 +80,7 @@ typedef struct ModelFunction {
 typedef struct ControllerModel {
     /* Controller specific objects (placed in Model instance). */
     const char* model_dynlib_filename;
+    void*       handle; /* Handle of the dynamic library (dlopen). */
 
     /* Collection of ModelFunction, Key is Model Function name. */
     HashMap model_functions;
@@ -67,6 +90,23 @@ typedef struct ControllerModel {
 } ControllerModel;
 
 
+typedef enum MarshalKind {
+    MARSHAL_KIND_DOUBLE,
+    MARSHAL_KIND_DOUBLE_TRANSFORM,
+    MARSHAL_KIND_BINARY,
+} MarshalKind;
+
+
+typedef struct MarshalItem {
+    MarshalKind           kind;
+    uint32_t              count;
+    /* Adapter side (channel, signal map) and Model side (channel storage). */
+    Channel*              channel;
+    SignalMap*            signal_map;
+    ModelFunctionChannel* mfc;
+} MarshalItem;
+
+
 typedef struct Controller {
     bool            stop_request;
     /* Adapter/Endpoint objects. */
@@ -74,6 +114,13 @@ typedef struct Controller {
     /* Model configuration info: specific to a simulation. */
     SimulationSpec* simulation;
     HashMap         controller_models;  // index by model instance name.
+    /* Marshal plan, compiled when the bus is ready. */
+    MarshalItem*    marshal_plan;
+    uint32_t        marshal_plan_count;
+    /* Model UIDs hosted by the Endpoint. */
+    uint32_t*       model_uid;
+    /* Last reload request handled (see controller_reload_requested()). */
+    uint32_t        reload_request;
 } Controller;
 
 
@@ -82,7 +129,8 @@ typedef struct Controller {
 /* These initialise the controller and load the Model lib. */
 DLL_PRIVATE int controller_init(Endpoint* endpoint);
 DLL_PRIVATE int controller_init_channel(ModelInstanceSpec* model_instance,
-    const char* channel_name, const char** signal_name, uint32_t signal_count);
+    const char* channel_name, const char** signal_name, uint32_t signal_count,
+    SignalDeadband* signal_deadband);
 
 /* These are called indirectly from the Model, via _model_function_register()
    and model_configure_channel_*(). */
@@ -98,12 +146,26 @@ DLL_PRIVATE int  controller_step(SimulationSpec* sim);
 DLL_PRIVATE int  controller_step_phased(SimulationSpec* sim);
 
 DLL_PRIVATE void controller_stop(void);
+DLL_PRIVATE void controller_interrupt(Controller* controller);
 DLL_PRIVATE void controller_dump_debug(void);
+DLL_PRIVATE void controller_dump_memory(void);
+DLL_PRIVATE void controller_dump_stats(void);
 DLL_PRIVATE void controller_exit(SimulationSpec* sim);
 
 
 /* loader.c */
-DLL_PRIVATE int controller_load_models(SimulationSpec* sim);
+DLL_PRIVATE int  controller_load_models(SimulationSpec* sim);
+DLL_PRIVATE int  controller_reload_models(SimulationSpec* sim);
+DLL_PRIVATE void controller_install_reload_handler(void);
+DLL_PRIVATE void controller_request_reload(void);
+DLL_PRIVATE bool controller_reload_requested(void);
+
+
+/* simbus_host.c */
+DLL_PRIVATE void simbus_host_configure(
+    Adapter* adapter, void* doc_list, const char* name);
+DLL_PRIVATE int  simbus_host_start(SimulationSpec* sim);
+DLL_PRIVATE void simbus_host_stop(void);
 
 
 /* step.c */
@@ -116,6 +178,8 @@ DLL_PUBLIC void model_function_destroy(ModelFunction* model_function);
 
 
 /* transform.c */
+DLL_PRIVATE void controller_changed_to_model(
+    ModelFunctionChannel* mfc, SignalMap* sm, Channel* ch);
 DLL_PRIVATE void controller_transform_to_model(
     ModelFunctionChannel* mfc, SignalMap* sm);
 DLL_PRIVATE void controller_transform_from_model(
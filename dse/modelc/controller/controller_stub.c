@@ -70,10 +70,33 @@ void controller_stop(void)
     return;
 }
 
+void controller_interrupt(Controller* controller)
+{
+    UNUSED(controller);
+}
+
 void controller_dump_debug(void)
 {
 }
 
+void controller_dump_memory(void)
+{
+}
+
+void controller_dump_stats(void)
+{
+}
+
+int simbus_host_start(SimulationSpec* sim)
+{
+    UNUSED(sim);
+    return 0;
+}
+
+void simbus_host_stop(void)
+{
+}
+
 void controller_exit(SimulationSpec* sim)
 {
     ModelInstanceSpec* _instptr = sim->instance_list;
@@ -104,12 +127,14 @@ int controller_init(Endpoint* endpoint)
 }
 
 int controller_init_channel(ModelInstanceSpec* model_instance,
-    const char* channel_name, const char** signal_name, uint32_t signal_count)
+    const char* channel_name, const char** signal_name, uint32_t signal_count,
+    SignalDeadband* signal_deadband)
 {
     UNUSED(model_instance);
     UNUSED(channel_name);
     UNUSED(signal_name);
     UNUSED(signal_count);
+    UNUSED(signal_deadband);
 
     return 0;
 }
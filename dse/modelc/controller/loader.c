@@ -4,19 +4,34 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <string.h>
 #include <assert.h>
+#include <signal.h>
+#include <pthread.h>
 #include <dlfcn.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/util/strings.h>
+#include <dse/modelc/adapter/memstat.h>
 #include <dse/modelc/controller/controller.h>
 #include <dse/modelc/controller/model_private.h>
 #include <dse/modelc/model.h>
+#include <dse/modelc/runtime.h>
+
+
+#define UNUSED(x) ((void)x)
 
 
 extern Controller* controller_object_ref(void);
 
 
+static volatile sig_atomic_t __reload_request = 0; /* Request count. */
+
+/* Models are loaded (and reloaded) one at a time, the model configuration
+   (see model.c) uses process wide tables. */
+static pthread_mutex_t __load_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
 extern ModelDesc* __model_gw_create__(ModelDesc* m);
 extern int        __model_gw_step__(
            ModelDesc* m, double* model_time, double stop_time);
@@ -42,6 +57,7 @@ static int controller_load_model(ModelInstanceSpec* mi, SimulationSpec* sim)
             log_notice("ERROR: dlopen call: %s", dlerror());
             goto error_dl;
         }
+        controller_model->handle = handle;
         /* Load the model interface.*/
         controller_model->vtable.create = dlsym(handle, MODEL_CREATE_FUNC_NAME);
         log_notice("Loading symbol: %s ... %s", MODEL_CREATE_FUNC_NAME,
@@ -84,6 +100,7 @@ int controller_load_models(SimulationSpec* sim)
     Adapter* adapter = controller->adapter;
     assert(adapter);
 
+    pthread_mutex_lock(&__load_lock);
     ModelInstanceSpec* _instptr = sim->instance_list;
     while (_instptr && _instptr->name) {
         ModelInstancePrivate* mip = _instptr->private;
@@ -121,6 +138,191 @@ int controller_load_models(SimulationSpec* sim)
         /* Next instance? */
         _instptr++;
     }
+    pthread_mutex_unlock(&__load_lock);
+
+    return rc;
+}
+
+
+/* Model Reload
+   ------------ */
+
+static void _reload_signal_handler(int signum)
+{
+    UNUSED(signum);
+    __reload_request++;
+}
+
+
+/**
+ *  controller_install_reload_handler
+ *
+ *  Install a SIGUSR2 handler which requests a reload of the Models. The reload
+ *  is done between steps (see controller_reload_requested()) rather than from
+ *  the signal handler.
+ */
+void controller_install_reload_handler(void)
+{
+#ifndef _WIN32
+    signal(SIGUSR2, _reload_signal_handler);
+#endif
+}
+
+
+/**
+ *  controller_request_reload
+ *
+ *  Request a reload of the Models (e.g. from a debugger or an importer which
+ *  does not use signals).
+ */
+void controller_request_reload(void)
+{
+    __reload_request++;
+}
+
+
+/* Each Controller (i.e. each Model thread) handles a request once. */
+bool controller_reload_requested(void)
+{
+    Controller* controller = controller_object_ref();
+    uint32_t    request = (uint32_t)__reload_request;
+    if (controller == NULL || controller->reload_request == request) {
+        return false;
+    }
+    controller->reload_request = request;
+    return true;
+}
+
+
+static int _unregistered_signal(void* _sv, void* _count)
+{
+    SignalValue* sv = _sv;
+    uint32_t*    count = _count;
+    if (sv->uid == 0) {
+        log_error("  Signal not registered with the SimBus: %s", sv->name);
+        *count += 1;
+    }
+    return 0;
+}
+
+static int _unregistered_channel(void* _ch, void* _count)
+{
+    Channel* ch = _ch;
+    return hashmap_iterator(
+        &ch->signal_values, _unregistered_signal, false, _count);
+}
+
+
+static int controller_reload_model(ModelInstanceSpec* mi, SimulationSpec* sim)
+{
+    ModelInstancePrivate* mip = mi->private;
+    ControllerModel*      cm = mip->controller_model;
+
+    /* Only dynamic models (with a library) can be reloaded. */
+    if (cm->handle == NULL) return 0;
+    log_notice("Reload model: %s ...", mi->name);
+
+    /* Destroy the Model, the Model Function Channel storage (and the
+       registration with the SimBus) are retained. */
+    ModelDesc* model_desc = mi->model_desc;
+    if (model_desc) {
+        if (model_desc->vtable.destroy) {
+            log_notice("Call symbol: %s ...", MODEL_DESTROY_FUNC_NAME);
+            errno = 0;
+            model_desc->vtable.destroy(model_desc);
+            if (errno) log_error(MODEL_DESTROY_FUNC_NAME "() failed");
+        }
+        if (model_desc->sv) model_sv_destroy(model_desc->sv);
+        free(model_desc);
+        mi->model_desc = NULL;
+    }
+    if (dlclose(cm->handle)) {
+        log_error("dlclose call: %s", dlerror());
+    }
+    cm->handle = NULL;
+    memset(&cm->vtable, 0, sizeof(ModelVTable));
+
+    /* Load the (new) library and create the Model. */
+    errno = 0;
+    int rc = controller_load_model(mi, sim);
+    if (rc) return rc;
+    if (cm->vtable.step == NULL) {
+        errno = EINVAL;
+        log_error("Model has no " MODEL_STEP_FUNC_NAME "() function");
+        return errno;
+    }
+    rc = modelc_model_create(sim, mi, &cm->vtable);
+    if (rc) {
+        if (errno == 0) errno = EINVAL;
+        log_error("modelc_model_create() failed!");
+        return errno;
+    }
+
+    /* Signals added by the Model are not registered with the SimBus (no UID,
+       they would never be exchanged), a reload can not add signals. */
+    uint32_t count = 0;
+    hashmap_iterator(&mip->adapter_model->channels, _unregistered_channel,
+        false, &count);
+    if (count) {
+        log_error("Reload added %u signal(s) to the Model!", count);
+        errno = EINVAL;
+        return errno;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  controller_reload_models
+ *
+ *  Reload the dynamic libraries of all Models of a simulation. Each Model is
+ *  destroyed (model_destroy()), its library is closed and the library (i.e. a
+ *  new build) is loaded again. The Model is then created (model_create())
+ *  with the existing signal storage (a Channel with a changed signal set is
+ *  configured again) and the marshal plan is compiled again. The connection
+ *  with the SimBus is kept alive (no registration is necessary), therefore a
+ *  reload which adds signals (not registered with the SimBus) fails.
+ *
+ *  Call only between steps of the simulation.
+ *
+ *  Parameters
+ *  ----------
+ *  sim : SimulationSpec (pointer to)
+ *      Simulation specification.
+ *
+ *  Returns
+ *  -------
+ *      0 : The Models were reloaded.
+ *      +ve : An error occurred while reloading a Model (errno is set), the
+ *          Model can not continue.
+ */
+int controller_reload_models(SimulationSpec* sim)
+{
+    assert(sim);
+    int rc = 0;
+
+    pthread_mutex_lock(&__load_lock);
+    ModelInstanceSpec* _instptr = sim->instance_list;
+    while (_instptr && _instptr->name) {
+        rc = controller_reload_model(_instptr, sim);
+        if (rc) {
+            log_error("Reload of model %s failed!", _instptr->name);
+            break;
+        }
+        /* Next instance? */
+        _instptr++;
+    }
+    pthread_mutex_unlock(&__load_lock);
+
+    /* The Model Function Channels may have changed (signal set), the marshal
+       plan is compiled again by the next step (see controller_step()). */
+    Controller* controller = controller_object_ref();
+    if (controller) {
+        memstat_free(MEMSTAT_CONTROLLER, controller->marshal_plan);
+        controller->marshal_plan = NULL;
+        controller->marshal_plan_count = 0;
+    }
 
     return rc;
 }
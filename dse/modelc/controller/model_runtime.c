@@ -5,11 +5,13 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <dlfcn.h>
 #include <time.h>
 #include <dse/clib/util/strings.h>
 #include <dse/clib/util/yaml.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/controller/controller.h>
 #include <dse/modelc/runtime.h>
 #include <dse/platform.h>
 #include <dse/logger.h>
@@ -18,6 +20,7 @@
 #define GENERAL_BUFFER_LEN 255
 #define STEP_SIZE          MODEL_DEFAULT_STEP_SIZE
 #define END_TIME           3600
+#define UNUSED(x)          ((void)x)
 
 
 static void __log(const char* format, ...)
@@ -197,3 +200,23 @@ void model_runtime_destroy(RuntimeModelDesc* rm)
     free(rm->model.sim->uri);
     rm->model.sim->uri = NULL;
 }
+
+
+/*
+ *  simbus_host_start, simbus_host_stop
+ *
+ *  ** Special version for the ModelC Runtime (loopback operation). **
+ *
+ *  The Model Runtime does not host a SimBus.
+ */
+int simbus_host_start(SimulationSpec* sim)
+{
+    UNUSED(sim);
+    errno = EINVAL;
+    return -1;
+}
+
+
+void simbus_host_stop(void)
+{
+}
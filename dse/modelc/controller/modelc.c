@@ -8,13 +8,19 @@
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/platform.h>
 #include <dse/clib/collections/hashmap.h>
 #include <dse/clib/util/strings.h>
 #include <dse/clib/util/yaml.h>
+#include <dse/modelc/adapter/intern.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/adapter/realtime.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/adapter/transport/prefetch.h>
 #include <dse/modelc/controller/controller.h>
 #include <dse/modelc/controller/model_private.h>
 #include <dse/modelc/model.h>
@@ -25,11 +31,34 @@
 /* CLI related defaults. */
 #define MODEL_TIMEOUT 60
 
+/* Endpoint creation, retry with exponential backoff. */
+#define ENDPOINT_RETRY_TIMEOUT_MS 60000
+#define ENDPOINT_BACKOFF_MIN_MS   10
+#define ENDPOINT_BACKOFF_MAX_MS   1000
+
 
 static double __stop_request = 0; /* Very private, indicate stop request. */
 
 extern ModelSignalIndex __model_index__(ModelDesc* m, const char* vname,
     const char* sname);
+extern Controller*      controller_object_ref(void);
+
+
+/* Single-process mode, each Model Instance runs on a thread of its own (with
+   its own Controller, Adapter and Endpoint). */
+typedef struct ModelThread {
+    SimulationSpec    sim;
+    ModelInstanceSpec instance[2]; /* The Model Instance, and EOL. */
+    Endpoint*         endpoint;
+    Controller*       controller; /* Set while the Controller exists. */
+    pthread_t         thread;
+    int               rc;
+} ModelThread;
+
+static ModelThread*    __model_thread = NULL;
+static uint32_t        __model_thread_count = 0;
+/* Controllers are created and destroyed one thread at a time. */
+static pthread_mutex_t __model_thread_lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 static int _destroy_model_function(void* mf, void* additional_data)
@@ -231,6 +260,7 @@ int modelc_configure(ModelCArguments* args, SimulationSpec* sim)
     sim->step_size = args->step_size;
     sim->end_time = args->end_time;
     sim->sim_path = args->sim_path;
+    sim->realtime = args->realtime;
 
     log_notice("Simulation Parameters:");
     log_notice("  Step Size: %f", sim->step_size);
@@ -288,6 +318,68 @@ int modelc_configure(ModelCArguments* args, SimulationSpec* sim)
         free(model_names);
     }
 
+    /* Realtime Profile, CLI or Stack annotation (of the first instance). */
+    if (sim->realtime == NULL && sim->instance_list->spec) {
+        YamlNode* a_node =
+            dse_yaml_find_node(sim->instance_list->spec, "annotations");
+        if (a_node) {
+            sim->realtime = dse_yaml_get_scalar(a_node, REALTIME_ANNOTATION);
+        }
+    }
+    if (sim->realtime) log_notice("  Realtime Profile: %s", sim->realtime);
+
+    /* Prefetch, Stack annotation (of the first instance). */
+    if (sim->instance_list->spec) {
+        YamlNode* a_node =
+            dse_yaml_find_node(sim->instance_list->spec, "annotations");
+        const char* prefetch =
+            a_node ? dse_yaml_get_scalar(a_node, PREFETCH_ANNOTATION) : NULL;
+        if (prefetch && strcmp(prefetch, "true") == 0) sim->prefetch = true;
+    }
+    if (sim->prefetch) log_notice("  Prefetch: enabled");
+
+    /* Lookahead, Stack annotation of each instance. All instances share a
+       single Notify exchange, so the smallest lookahead is used. The
+       lookahead is agreed with the SimBus at ModelRegister. */
+    uint32_t lookahead = UINT32_MAX;
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        uint32_t  _lookahead = 0;
+        YamlNode* a_node = NULL;
+        if (mi->spec) a_node = dse_yaml_find_node(mi->spec, "annotations");
+        if (a_node) {
+            const char* _value =
+                dse_yaml_get_scalar(a_node, LOOKAHEAD_ANNOTATION);
+            if (_value) _lookahead = strtoul(_value, NULL, 10);
+        }
+        if (_lookahead < lookahead) lookahead = _lookahead;
+    }
+    if (lookahead == UINT32_MAX) lookahead = 0;
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        ModelInstancePrivate* mip = mi->private;
+        mip->adapter_model->lookahead = lookahead;
+    }
+    if (lookahead) log_notice("  Lookahead: %u steps (requested)", lookahead);
+
+    /* Batch, Stack annotation of each instance (smallest is used, as for
+       lookahead). The factor is agreed with the SimBus at ModelRegister. */
+    uint32_t batch = UINT32_MAX;
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        uint32_t  _batch = 0;
+        YamlNode* a_node = NULL;
+        if (mi->spec) a_node = dse_yaml_find_node(mi->spec, "annotations");
+        if (a_node) {
+            const char* _value = dse_yaml_get_scalar(a_node, BATCH_ANNOTATION);
+            if (_value) _batch = strtoul(_value, NULL, 10);
+        }
+        if (_batch < batch) batch = _batch;
+    }
+    if (batch == UINT32_MAX || batch < 2) batch = 0;
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        ModelInstancePrivate* mip = mi->private;
+        mip->adapter_model->batch = batch;
+    }
+    if (batch) log_notice("  Batch: %u steps (requested)", batch);
+
     return 0;
 }
 
@@ -363,7 +455,11 @@ int modelc_model_create(
         log_error("Model has no " MODEL_STEP_FUNC_NAME "() function");
         return -errno;
     }
-    int rc = _model_function_register(mi, MODEL_STEP_FUNC_NAME, sim->step_size);
+    int rc = 0;
+    if (controller_get_model_function(mi, MODEL_STEP_FUNC_NAME) == NULL) {
+        /* Not registered (i.e. not a reload of the Model). */
+        rc = _model_function_register(mi, MODEL_STEP_FUNC_NAME, sim->step_size);
+    }
     if (rc != 0) {
         if (errno == 0) errno = rc;
         log_error("Model function registration failed!");
@@ -459,10 +555,11 @@ ModelInstanceSpec* modelc_get_model_instance(
 
 static Endpoint* _create_endpoint(SimulationSpec* sim)
 {
-    int       retry_count = 60;
+    uint32_t  elapsed_ms = 0;
+    uint32_t  backoff_ms = ENDPOINT_BACKOFF_MIN_MS;
     Endpoint* endpoint = NULL;
 
-    while (--retry_count) {
+    while (elapsed_ms < ENDPOINT_RETRY_TIMEOUT_MS) {
         endpoint = endpoint_create(
             sim->transport, sim->uri, sim->uid, false, sim->timeout);
         if (endpoint) break;
@@ -472,7 +569,17 @@ static Endpoint* _create_endpoint(SimulationSpec* sim)
             errno = ECANCELED;
             log_fatal("Signaled!");
         }
-        sleep(1);
+        /* Exponential backoff, the SimBus may become available quickly. */
+        struct timespec ts = {
+            .tv_sec = backoff_ms / 1000,
+            .tv_nsec = (backoff_ms % 1000) * 1000000L,
+        };
+        nanosleep(&ts, NULL);
+        elapsed_ms += backoff_ms;
+        backoff_ms *= 2;
+        if (backoff_ms > ENDPOINT_BACKOFF_MAX_MS) {
+            backoff_ms = ENDPOINT_BACKOFF_MAX_MS;
+        }
         log_notice("Retry endpoint creation ...");
     }
 
@@ -480,6 +587,82 @@ static Endpoint* _create_endpoint(SimulationSpec* sim)
 }
 
 
+static void* _model_thread(void* arg)
+{
+    ModelThread*    t = arg;
+    SimulationSpec* sim = &t->sim;
+    const char*     name = t->instance[0].name;
+
+    pthread_mutex_lock(&__model_thread_lock);
+    controller_init(t->endpoint);
+    __atomic_store_n(&t->controller, controller_object_ref(), __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&__model_thread_lock);
+
+    /* Apply the Realtime Profile (before the signal storage is allocated). */
+    realtime_apply(name);
+
+    log_notice("Load and configure the Simulation Model (%s) ...", name);
+    int rc = controller_load_models(sim);
+    if (rc) log_fatal("Error loading Simulation Model (%s)!", name);
+
+    log_notice("Run the Simulation (%s) ...", name);
+    errno = 0;
+    controller_run(sim);
+    t->rc = errno;
+
+    /* The Controller is specific to this thread. */
+    controller_dump_debug();
+    controller_dump_stats();
+    pthread_mutex_lock(&__model_thread_lock);
+    __atomic_store_n(&t->controller, NULL, __ATOMIC_RELEASE);
+    controller_exit(sim);
+    pthread_mutex_unlock(&__model_thread_lock);
+
+    return NULL;
+}
+
+
+static int _run_model_threads(
+    SimulationSpec* sim, Endpoint* endpoint, uint32_t count)
+{
+    ModelThread* model_thread = calloc(count, sizeof(ModelThread));
+    if (model_thread == NULL) log_fatal("Model thread malloc failed!");
+
+    /* Endpoints are connected from this thread (see inproc_connect()). */
+    for (uint32_t i = 0; i < count; i++) {
+        ModelThread* t = &model_thread[i];
+        t->instance[0] = sim->instance_list[i];
+        t->sim = *sim;
+        t->sim.uid = t->instance[0].uid;
+        t->sim.instance_list = t->instance;
+        t->endpoint = (i == 0) ? endpoint : _create_endpoint(&t->sim);
+        if (t->endpoint == NULL) log_fatal("Could not create endpoint!");
+    }
+    __model_thread = model_thread;
+    __atomic_store_n(&__model_thread_count, count, __ATOMIC_RELEASE);
+
+    log_notice("Run the Simulation (%u model threads) ...", count);
+    for (uint32_t i = 0; i < count; i++) {
+        ModelThread* t = &model_thread[i];
+        if (pthread_create(&t->thread, NULL, _model_thread, t)) {
+            log_fatal("Model thread could not be started!");
+        }
+        log_notice("  Model thread: %s", t->instance[0].name);
+    }
+    int rc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        ModelThread* t = &model_thread[i];
+        pthread_join(t->thread, NULL);
+        if (t->rc == ECANCELED) rc = ECANCELED;
+        /* Model Instance objects are released by modelc_exit(). */
+        sim->instance_list[i] = t->instance[0];
+    }
+
+    errno = rc;
+    return rc;
+}
+
+
 int modelc_run(SimulationSpec* sim, bool run_async)
 {
     assert(sim);
@@ -509,9 +692,32 @@ int modelc_run(SimulationSpec* sim, bool run_async)
         inst_counter++;
     }
 
+    /* Single-process mode, Model Instances run on threads of their own. */
+    bool threaded = (run_async == false && inst_counter > 1 &&
+                     strcmp(sim->transport, TRANSPORT_INPROC) == 0);
+
     /* Create Controller object. */
-    log_notice("Create the Controller object ...");
-    controller_init(endpoint);
+    if (threaded == false) {
+        log_notice("Create the Controller object ...");
+        controller_init(endpoint);
+    }
+
+    /* Apply the Realtime Profile (before the signal storage is allocated). */
+    if (realtime_configure(sim->realtime)) {
+        log_error("Realtime profile not correctly specified: %s", sim->realtime);
+    }
+    if (threaded == false) realtime_apply("ModelC");
+
+    /* Memory accounting, on-demand report (SIGUSR1). */
+    memstat_install_handler();
+    /* Model reload, on-demand (SIGUSR2). */
+    controller_install_reload_handler();
+
+    /* Single-process mode, the SimBus runs on a thread of this process. */
+    if (strcmp(sim->transport, TRANSPORT_INPROC) == 0) {
+        if (simbus_host_start(sim)) log_fatal("Could not start the SimBus!");
+    }
+    if (threaded) return _run_model_threads(sim, endpoint, inst_counter);
 
     /* Load all Simulation Models. */
     log_notice("Load and configure the Simulation Models ...");
@@ -561,12 +767,25 @@ void modelc_shutdown(void)
     */
     __stop_request = 1;
     controller_stop();
+    uint32_t count = __atomic_load_n(&__model_thread_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; i++) {
+        controller_interrupt(
+            __atomic_load_n(&__model_thread[i].controller, __ATOMIC_ACQUIRE));
+    }
 }
 
 
 void modelc_exit(SimulationSpec* sim)
 {
     controller_dump_debug();
+    controller_dump_memory();
+    controller_dump_stats();
+    realtime_print("ModelC");
     controller_exit(sim);
+    simbus_host_stop();
     _destroy_model_instances(sim);
+    __atomic_store_n(&__model_thread_count, 0, __ATOMIC_RELEASE);
+    free(__model_thread);
+    __model_thread = NULL;
+    intern_destroy();
 }
@@ -13,7 +13,7 @@
 #include <dse/modelc/adapter/transport/endpoint.h>
 
 
-#define OPT_LIST             "ht:U:H:P:s:X:e:u:n:T:l:f:p:"
+#define OPT_LIST             "ht:U:H:P:s:X:e:u:n:T:l:f:p:R:"
 #define REDIS_HOST           "localhost"
 #define REDIS_PORT           6379
 #define TRANSPORT            TRANSPORT_REDISPUBSUB
@@ -43,6 +43,7 @@ static struct option long_options[] = {
     { "logger", required_argument, NULL, 'l' },
     { "file", required_argument, NULL, 'f' },
     { "path", required_argument, NULL, 'p' },
+    { "realtime", required_argument, NULL, 'R' },
     { 0, 0, 0, 0 },
 };
 
@@ -64,6 +65,7 @@ static void print_usage(const char* doc_string)
     log_notice("       [--file <model file>]");
     log_notice("       [--path <path to model>] *** relative path to Model "
                "Package ***");
+    log_notice("       [--realtime <profile>] (i.e. cpu=2,priority=80,mlock)");
     log_notice("       [YAML FILE [,YAML FILE] ...]");
 }
 
@@ -72,7 +74,8 @@ static void print_usage(const char* doc_string)
  *  _args_extract_environment
  *
  *  Extract arguments from environment variables.
- *      SIMBUS_TRANSPORT = "redispubsub" | "mq"  (see endpoint.h)
+ *      SIMBUS_TRANSPORT = "redispubsub" | "redisstreams" | "mq" | "inproc"
+ *          (see endpoint.h)
  *      SIMBUS_URI = "redis://localhost:6379"
  *      SIMBUS_LOGLEVEL = 0 .. 6
  *
@@ -248,6 +251,9 @@ void modelc_parse_arguments(
         case 'X':
             args->steps = atol(optarg);
             break;
+        case 'R':
+            args->realtime = optarg;
+            break;
         default:
             log_error("unexpected option");
             print_usage(doc_string);
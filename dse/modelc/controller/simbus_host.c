@@ -0,0 +1,258 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+#include <dse/logger.h>
+#include <dse/clib/util/yaml.h>
+#include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/simbus/simbus.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/controller/controller.h>
+#include <dse/modelc/runtime.h>
+
+
+#define SIMBUS_HOST_NAME      "simbus"
+#define SIMBUS_HOST_UID       8000008
+#define SIMBUS_HOST_TIMEOUT   1   /* This is the wait_message timeout. */
+#define SIMBUS_HOST_EXIT_WAIT 500 /* x 10 ms, for the SimBus to exit. */
+
+
+extern bool __simbus_exit_run_loop__;
+
+
+static struct {
+    Adapter*  adapter;
+    pthread_t thread;
+    bool      done;
+} __host = { 0 };
+
+
+static void _configure_signals(YamlDocList* doc_list)
+{
+    if (doc_list == NULL) return;
+
+    for (uint32_t i = 0; i < hashlist_length(doc_list); i++) {
+        YamlNode*   doc = hashlist_at(doc_list, i);
+        const char* kind = dse_yaml_get_scalar(doc, "kind");
+        if (kind == NULL || strcmp(kind, "SignalGroup") != 0) continue;
+
+        /* Group annotations apply to all signals, signal annotations take
+           precedence. A signal annotated with `writer: multi` is never
+           forwarded (see handler.c). */
+        double      g_absolute = 0.0;
+        double      g_relative = 0.0;
+        const char* g_writer = NULL;
+        YamlNode*   ga_node = dse_yaml_find_node(doc, "metadata/annotations");
+        if (ga_node) {
+            dse_yaml_get_double(ga_node, "deadband", &g_absolute);
+            dse_yaml_get_double(ga_node, "deadband_relative", &g_relative);
+            g_writer = dse_yaml_get_scalar(ga_node, "writer");
+        }
+        YamlNode* s_node = dse_yaml_find_node(doc, "spec/signals");
+        if (s_node == NULL) continue;
+        for (uint32_t j = 0; j < hashlist_length(&s_node->sequence); j++) {
+            YamlNode*   sig_node = hashlist_at(&s_node->sequence, j);
+            const char* signal = dse_yaml_get_scalar(sig_node, "signal");
+            if (signal == NULL) continue;
+            double      absolute = g_absolute;
+            double      relative = g_relative;
+            const char* writer = g_writer;
+            YamlNode*   a_node = dse_yaml_find_node(sig_node, "annotations");
+            if (a_node) {
+                dse_yaml_get_double(a_node, "deadband", &absolute);
+                dse_yaml_get_double(a_node, "deadband_relative", &relative);
+                const char* w = dse_yaml_get_scalar(a_node, "writer");
+                if (w) writer = w;
+            }
+            simbus_adapter_set_deadband(signal, absolute, relative);
+            if (writer && strcmp(writer, "multi") == 0) {
+                simbus_adapter_set_multi_writer(signal);
+            }
+        }
+    }
+}
+
+
+/**
+ *  simbus_host_configure
+ *
+ *  Configure a Bus Adapter from the Stack: channels (and expected model
+ *  counts) of the SimBus model instance, change thresholds (deadband) and
+ *  multi-writer signals from SignalGroup annotations and the lookahead and
+ *  batch bounds.
+ *
+ *  Parameters
+ *  ----------
+ *  adapter : Adapter*
+ *      The Bus Adapter (see simbus_adapter_create()).
+ *  doc_list : void*
+ *      The parsed YAML Doc List (YamlDocList*).
+ *  name : const char*
+ *      Name of the SimBus model instance in the Stack.
+ */
+void simbus_host_configure(Adapter* adapter, void* doc_list, const char* name)
+{
+    assert(adapter);
+
+    /* Configure all specified channels. */
+    YamlNode* model_node;
+    model_node = dse_yaml_find_node_in_seq_in_doclist(
+        doc_list, "Stack", "spec/models", "name", name);
+    YamlNode* ch_seq_node;
+    ch_seq_node = dse_yaml_find_node(model_node, "channels");
+    if (ch_seq_node) {
+        for (uint32_t i = 0; i < hashlist_length(&ch_seq_node->sequence); i++) {
+            YamlNode* ch_node = hashlist_at(&ch_seq_node->sequence, i);
+            YamlNode* n_node = dse_yaml_find_node(ch_node, "name");
+            YamlNode* emc_node =
+                dse_yaml_find_node(ch_node, "expectedModelCount");
+            uint32_t _model_count = (emc_node) ? atol(emc_node->scalar) : 0;
+
+            log_notice("  Channel: %s (expected models=%u)", n_node->scalar,
+                _model_count);
+            adapter_init_channel(
+                adapter->bus_adapter_model, n_node->scalar, NULL, 0);
+            simbus_adapter_init_channel(
+                adapter->bus_adapter_model, n_node->scalar, _model_count);
+        }
+    } else {
+        /* Fallback if missing configuration. */
+        log_error("No channel configuration found, fallback ...");
+        log_error(
+            "  Channel: %s (expected models=%u)", ADAPTER_FALLBACK_CHANNEL, 1);
+        adapter_init_channel(
+            adapter->bus_adapter_model, ADAPTER_FALLBACK_CHANNEL, NULL, 0);
+        simbus_adapter_init_channel(
+            adapter->bus_adapter_model, ADAPTER_FALLBACK_CHANNEL, 1);
+    }
+
+    /* Change thresholds (deadband) and writers, SignalGroup annotations. */
+    _configure_signals(doc_list);
+
+    /* Lookahead and batch bounds, Stack annotations. */
+    if (model_node) {
+        YamlNode* a_node = dse_yaml_find_node(model_node, "annotations");
+        const char* lookahead =
+            a_node ? dse_yaml_get_scalar(a_node, LOOKAHEAD_ANNOTATION) : NULL;
+        if (lookahead) adapter->bus_lookahead = strtoul(lookahead, NULL, 10);
+        const char* batch =
+            a_node ? dse_yaml_get_scalar(a_node, BATCH_ANNOTATION) : NULL;
+        if (batch) adapter->bus_batch = strtoul(batch, NULL, 10);
+    }
+    log_notice("  Lookahead bound: %u steps", adapter->bus_lookahead);
+    log_notice("  Batch bound: %u steps", adapter->bus_batch);
+}
+
+
+static void* _simbus_host_thread(void* arg)
+{
+    Adapter* adapter = arg;
+
+    simbus_adapter_run(adapter);
+    {
+        log_simbus("========================================");
+        log_simbus("Adapter Dump");
+        log_simbus("========================================");
+        adapter_model_dump_debug(adapter->bus_adapter_model, "SimBus");
+        log_simbus("----------------------------------------");
+        log_simbus("bus_mode       : %u", adapter->bus_mode);
+        log_simbus("bus_time       : %f", adapter->bus_time);
+        log_simbus("bus_step_size : %f", adapter->bus_step_size);
+        log_simbus("========================================");
+    }
+    __atomic_store_n(&__host.done, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+
+/**
+ *  simbus_host_start
+ *
+ *  Start a SimBus on a thread of this (ModelC) process. The SimBus is
+ *  configured from the SimBus model instance of the Stack and connected to
+ *  the Models with the in-process transport.
+ *
+ *  Parameters
+ *  ----------
+ *  sim : SimulationSpec*
+ *      The simulation (transport must be TRANSPORT_INPROC).
+ *
+ *  Returns
+ *  -------
+ *      0 : The SimBus is running.
+ *      -1 : The SimBus could not be started (errno is set).
+ */
+int simbus_host_start(SimulationSpec* sim)
+{
+    assert(sim);
+    if (__host.adapter) return 0;
+    if (sim->transport == NULL || strcmp(sim->transport, TRANSPORT_INPROC)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    log_notice("Create the in-process SimBus ...");
+    Endpoint* endpoint = endpoint_create(TRANSPORT_INPROC, sim->uri,
+        SIMBUS_HOST_UID, true, SIMBUS_HOST_TIMEOUT);
+    if (endpoint == NULL) {
+        log_error("Could not create SimBus endpoint!");
+        if (errno == 0) errno = EINVAL;
+        return -1;
+    }
+    Adapter* adapter = simbus_adapter_create(endpoint, sim->step_size);
+    log_notice("  Model UID: %d", adapter->bus_adapter_model->model_uid);
+    void* doc_list =
+        (sim->instance_list) ? sim->instance_list->yaml_doc_list : NULL;
+    simbus_host_configure(adapter, doc_list, SIMBUS_HOST_NAME);
+
+    __host.adapter = adapter;
+    __host.done = false;
+    if (pthread_create(&__host.thread, NULL, _simbus_host_thread, adapter)) {
+        log_error("SimBus thread could not be started!");
+        adapter_destroy(adapter);
+        __host.adapter = NULL;
+        if (errno == 0) errno = EAGAIN;
+        return -1;
+    }
+    log_notice("Start the Bus (thread) ...");
+
+    return 0;
+}
+
+
+/**
+ *  simbus_host_stop
+ *
+ *  Wait for the in-process SimBus to exit (after all Models have exited),
+ *  then release the SimBus. If the SimBus does not exit by itself (e.g. a
+ *  Model failed) the run loop is interrupted.
+ */
+void simbus_host_stop(void)
+{
+    if (__host.adapter == NULL) return;
+    Adapter* adapter = __host.adapter;
+
+    struct timespec wait = { .tv_sec = 0, .tv_nsec = 10000000 };
+    for (int i = 0; i < SIMBUS_HOST_EXIT_WAIT; i++) {
+        if (__atomic_load_n(&__host.done, __ATOMIC_ACQUIRE)) break;
+        nanosleep(&wait, NULL);
+    }
+    if (__atomic_load_n(&__host.done, __ATOMIC_ACQUIRE) == false) {
+        log_error("SimBus did not exit, interrupt ...");
+        __simbus_exit_run_loop__ = true;
+        adapter->endpoint->interrupt(adapter->endpoint);
+    }
+    pthread_join(__host.thread, NULL);
+
+    adapter_destroy(adapter);
+    __host.adapter = NULL;
+}
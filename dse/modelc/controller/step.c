@@ -8,6 +8,8 @@
 #include <dse/logger.h>
 #include <dse/clib/collections/hashmap.h>
 #include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/probe.h>
+#include <dse/modelc/adapter/timeline.h>
 #include <dse/modelc/adapter/timer.h>
 #include <dse/modelc/controller/controller.h>
 #include <dse/modelc/controller/model_private.h>
@@ -58,8 +60,13 @@ int step_model(ModelInstanceSpec* mi, double* model_time)
     mf_step_data    step_data = { mi, am->model_time, am->stop_time };
     HashMap*        mf_map = &cm->model_functions;
     struct timespec stepcall_ts = get_timespec_now();
+    uint64_t        timeline_ts = timeline_begin();
+    PROBE3(model_step_begin, am->model_uid, PROBE_NS(am->model_time),
+        PROBE_NS(am->stop_time));
     int rc = hashmap_iterator(mf_map, _do_step_func, false, &step_data);
     am->bench_steptime_ns = get_elapsedtime_ns(stepcall_ts);
+    timeline_end(TIMELINE_STEP, am->model_uid, am->model_time, timeline_ts);
+    PROBE3(model_step_end, am->model_uid, PROBE_NS(am->stop_time), rc);
 
     /* Update the Model times. */
     am->model_time = am->stop_time;
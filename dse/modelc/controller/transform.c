@@ -3,12 +3,79 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/modelc/adapter/adapter.h>
 #include <dse/modelc/controller/controller.h>
 
 
+/* Map the channel index to the signal index of the MFC, rebuilt when the
+   channel index has changed. Returns FALSE if no map is available. */
+static bool _changed_map(ModelFunctionChannel* mfc, SignalMap* sm, Channel* ch)
+{
+    if (ch->index.valid == false) return false;
+    if (mfc->signal_changed_map &&
+        mfc->signal_changed_map_hash_code == ch->index.hash_code) {
+        return true;
+    }
+
+    free(mfc->signal_changed_map);
+    mfc->signal_changed_map_count = 0;
+    mfc->signal_changed_map = calloc(ch->index.count + 1, sizeof(uint32_t));
+    if (mfc->signal_changed_map == NULL) return false;
+    for (uint32_t si = 0; si < mfc->signal_count; si++) {
+        uint32_t index = sm[si].signal->index;
+        if (index >= ch->index.count) continue;
+        if (ch->index.map[index].signal != sm[si].signal) continue;
+        mfc->signal_changed_map[index] = si + 1;
+    }
+    mfc->signal_changed_map_count = ch->index.count;
+    mfc->signal_changed_map_hash_code = ch->index.hash_code;
+    return true;
+}
+
+
+static int _index_compar(const void* a, const void* b)
+{
+    uint32_t _a = *(const uint32_t*)a;
+    uint32_t _b = *(const uint32_t*)b;
+    return (_a > _b) - (_a < _b);
+}
+
+
+/* Index list of changed signals (see signal_changed()). The changed list of
+   the channel (collected when decoding) is walked, rather than all signals,
+   unless that list is incomplete. */
+DLL_PRIVATE void controller_changed_to_model(
+    ModelFunctionChannel* mfc, SignalMap* sm, Channel* ch)
+{
+    if (mfc->signal_changed == NULL) return;
+
+    mfc->signal_changed_count = 0;
+    if (ch == NULL || ch->changed.overflow || !_changed_map(mfc, sm, ch)) {
+        for (uint32_t si = 0; si < mfc->signal_count; si++) {
+            if (sm[si].signal->changed) {
+                mfc->signal_changed[mfc->signal_changed_count++] = si;
+            }
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < ch->changed.count; i++) {
+        uint32_t index = ch->changed.signal[i]->index;
+        if (index >= mfc->signal_changed_map_count) continue;
+        uint32_t si = mfc->signal_changed_map[index];
+        if (si) mfc->signal_changed[mfc->signal_changed_count++] = si - 1;
+    }
+    /* Ascending order (the list is in order of reception). */
+    if (mfc->signal_changed_count > 1) {
+        qsort(mfc->signal_changed, mfc->signal_changed_count, sizeof(uint32_t),
+            _index_compar);
+    }
+}
+
+
 DLL_PRIVATE void controller_transform_to_model(
     ModelFunctionChannel* mfc, SignalMap* sm)
 {
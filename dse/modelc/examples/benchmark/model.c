@@ -4,13 +4,87 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include <time.h>
+#include <sys/time.h>
 #include <dse/modelc/model.h>
+#include <dse/ncodec/codec.h>
 #include <dse/logger.h>
 
 
+#define FRAME_ID_BASE  0x100
+#define FRAME_SIZE_MAX 64 /* CAN FD. */
+#define PAGE_SIZE      4096
+#define TWO_PI         6.283185307179586
+
+
+/*
+Benchmark Model (Load Generator)
+--------------------------------
+
+The load generated by the model is configured with annotations of the Model
+Instance (see simulation.yaml):
+
+    benchmark_compute_us : double (default 0)
+        Compute time of each step (mean), in microseconds.
+    benchmark_compute_mode : busy|arith (default busy)
+        busy : busy-wait on the clock.
+        arith : arithmetic over the memory footprint until the compute time
+            has elapsed.
+    benchmark_compute_dist : fixed|uniform|normal (default fixed)
+        Distribution of the compute time.
+    benchmark_jitter_us : double (default 0)
+        Jitter of the compute time, the range (uniform, +/- jitter) or
+        standard deviation (normal).
+    benchmark_signal_change : int (default 1)
+        Number of scalar signals changed per step, each step changes a random
+        number (1 .. signal_change) of signals of each scalar Signal Vector.
+        The env SIGNAL_CHANGE, when set, takes precedence.
+    benchmark_frame_count : int (default 0)
+        Number of frames written to each binary signal (with an NCodec) per
+        step. Received frames are read (and discarded).
+    benchmark_frame_size : int (default 8, max 64)
+        Payload size of the frames.
+    benchmark_memory_kb : int (default 0)
+        Memory footprint, allocated (and touched) when the model is created.
+    benchmark_seed : int (default time based)
+        Seed of the random generator (for reproducible loads).
+*/
+typedef enum {
+    COMPUTE_BUSY = 0,
+    COMPUTE_ARITH,
+} ComputeMode;
+
+typedef enum {
+    DIST_FIXED = 0,
+    DIST_UNIFORM,
+    DIST_NORMAL,
+} ComputeDist;
+
+
+typedef struct {
+    ModelDesc   model;
+    /* Benchmark parameters. */
+    uint32_t    signal_change;
+    uint32_t    change_seed;
+    double      compute_us;
+    double      jitter_us;
+    ComputeMode compute_mode;
+    ComputeDist compute_dist;
+    uint32_t    frame_count;
+    uint32_t    frame_size;
+    /* Benchmark state. */
+    uint8_t*    memory;
+    size_t      memory_size;
+    size_t      memory_pos;
+    double      accumulator;
+    uint32_t    frame_counter;
+} ExtendedModelDesc;
+
+
 static inline uint64_t _get_seed()
 {
     struct timeval tv;
@@ -19,6 +93,21 @@ static inline uint64_t _get_seed()
 }
 
 
+static inline double _now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+
+static inline double _rand_unit(uint32_t* seed)
+{
+    /* 0 < x <= 1 */
+    return ((double)rand_r(seed) + 1.0) / ((double)RAND_MAX + 1.0);
+}
+
+
 static inline uint32_t _get_signal_change(
     SignalVector* sv, uint32_t limit, uint32_t* seed)
 {
@@ -31,12 +120,107 @@ static inline uint32_t _get_signal_change(
 }
 
 
-typedef struct {
-    ModelDesc model;
-    /* Benchmark parameters. */
-    uint32_t  signal_change;
-    uint32_t  change_seed;
-} ExtendedModelDesc;
+static double _get_compute_time(ExtendedModelDesc* m)
+{
+    double t = m->compute_us;
+    switch (m->compute_dist) {
+    case DIST_UNIFORM:
+        t += (2.0 * _rand_unit(&m->change_seed) - 1.0) * m->jitter_us;
+        break;
+    case DIST_NORMAL: {
+        /* Box-Muller transform. */
+        double u1 = _rand_unit(&m->change_seed);
+        double u2 = _rand_unit(&m->change_seed);
+        t += sqrt(-2.0 * log(u1)) * cos(TWO_PI * u2) * m->jitter_us;
+        break;
+    }
+    default:
+        break;
+    }
+    return (t > 0.0) ? t : 0.0;
+}
+
+
+static void _compute(ExtendedModelDesc* m)
+{
+    double duration = _get_compute_time(m);
+    if (duration <= 0.0) return;
+
+    double end = _now_us() + duration;
+    if (m->compute_mode == COMPUTE_ARITH) {
+        /* Arithmetic over the memory footprint (one cache line at a time),
+           check the clock periodically. */
+        do {
+            for (uint32_t i = 0; i < 1000; i++) {
+                double v = m->accumulator;
+                if (m->memory_size) {
+                    v += m->memory[m->memory_pos];
+                    m->memory[m->memory_pos] = (uint8_t)v;
+                    m->memory_pos = (m->memory_pos + 64) % m->memory_size;
+                }
+                m->accumulator = sqrt(v * v + 1.0) * 0.5;
+            }
+        } while (_now_us() < end);
+    } else {
+        while (_now_us() < end) {
+        }
+    }
+}
+
+
+static void _change_signals(ExtendedModelDesc* m, SignalVector* sv)
+{
+    uint32_t count = _get_signal_change(sv, m->signal_change, &m->change_seed);
+    log_info("Signal count is : %d", count);
+    for (size_t i = 0; i < count; i++) {
+        sv->scalar[i] += 1.2;
+    }
+}
+
+
+static void _exchange_frames(ExtendedModelDesc* m, SignalVector* sv)
+{
+    uint8_t payload[FRAME_SIZE_MAX];
+
+    for (uint32_t i = 0; i < sv->count; i++) {
+        NCODEC* nc = sv->codec(sv, i);
+        if (nc == NULL) continue;
+
+        /* Frame RX. */
+        while (1) {
+            NCodecCanMessage msg = {};
+            if (ncodec_read(nc, &msg) < 0) break;
+        }
+
+        /* Frame TX. */
+        ncodec_truncate(nc);
+        for (uint32_t f = 0; f < m->frame_count; f++) {
+            memset(payload, (uint8_t)m->frame_counter, m->frame_size);
+            ncodec_write(nc, &(struct NCodecCanMessage){
+                                 .frame_id = FRAME_ID_BASE + f,
+                                 .frame_type = CAN_FD_BASE_FRAME,
+                                 .buffer = payload,
+                                 .len = m->frame_size,
+                             });
+            m->frame_counter++;
+        }
+        ncodec_flush(nc);
+    }
+}
+
+
+static double _annotation_double(ModelDesc* m, const char* name, double value)
+{
+    const char* a = model_instance_annotation(m, name);
+    return (a) ? atof(a) : value;
+}
+
+
+static int _annotation_int(ModelDesc* m, const char* name, int value)
+{
+    const char* a = model_instance_annotation(m, name);
+    return (a) ? atoi(a) : value;
+}
 
 
 ModelDesc* model_create(ModelDesc* model)
@@ -46,13 +230,63 @@ ModelDesc* model_create(ModelDesc* model)
     memcpy(m, model, sizeof(ModelDesc));
 
     /* Setup the benchmark parameters. */
-    m->signal_change = 1;
+    m->signal_change =
+        _annotation_int((ModelDesc*)m, "benchmark_signal_change", 1);
     if (getenv("SIGNAL_CHANGE")) {
+        /* The environment takes precedence (benchmark scripts). */
         m->signal_change = atoi(getenv("SIGNAL_CHANGE"));
     }
-    m->change_seed = _get_seed();
+    m->change_seed = _annotation_int(
+        (ModelDesc*)m, "benchmark_seed", (uint32_t)_get_seed());
     log_notice("seed value: %d", m->change_seed);
 
+    m->compute_us =
+        _annotation_double((ModelDesc*)m, "benchmark_compute_us", 0);
+    m->jitter_us = _annotation_double((ModelDesc*)m, "benchmark_jitter_us", 0);
+    const char* mode =
+        model_instance_annotation((ModelDesc*)m, "benchmark_compute_mode");
+    if (mode && strcmp(mode, "arith") == 0) m->compute_mode = COMPUTE_ARITH;
+    const char* dist =
+        model_instance_annotation((ModelDesc*)m, "benchmark_compute_dist");
+    if (dist && strcmp(dist, "uniform") == 0) m->compute_dist = DIST_UNIFORM;
+    if (dist && strcmp(dist, "normal") == 0) m->compute_dist = DIST_NORMAL;
+    log_notice("compute: %.1f us (jitter %.1f us, mode=%s, dist=%s)",
+        m->compute_us, m->jitter_us, mode ? mode : "busy",
+        dist ? dist : "fixed");
+
+    m->frame_count =
+        _annotation_int((ModelDesc*)m, "benchmark_frame_count", 0);
+    m->frame_size = _annotation_int((ModelDesc*)m, "benchmark_frame_size", 8);
+    if (m->frame_size > FRAME_SIZE_MAX) m->frame_size = FRAME_SIZE_MAX;
+    log_notice("frames: %u per step (%u bytes)", m->frame_count,
+        m->frame_size);
+
+    /* Memory footprint (touch each page so that it is resident). */
+    m->memory_size =
+        (size_t)_annotation_int((ModelDesc*)m, "benchmark_memory_kb", 0) * 1024;
+    if (m->memory_size) {
+        m->memory = malloc(m->memory_size);
+        if (m->memory == NULL) log_fatal("Memory footprint allocation failed!");
+        for (size_t i = 0; i < m->memory_size; i += PAGE_SIZE) {
+            m->memory[i] = (uint8_t)i;
+        }
+        log_notice("memory: %zu KB", m->memory_size / 1024);
+    }
+
+    /* Configure the node_id of the NCodec objects (if provided). */
+    const char* node_id = model_instance_annotation((ModelDesc*)m, "node_id");
+    for (SignalVector* sv = m->model.sv; node_id && sv && sv->name; sv++) {
+        if (sv->is_binary == false) continue;
+        for (uint32_t i = 0; i < sv->count; i++) {
+            NCODEC* nc = sv->codec(sv, i);
+            if (nc == NULL) continue;
+            ncodec_config(nc, (struct NCodecConfigItem){
+                                  .name = "node_id",
+                                  .value = node_id,
+                              });
+        }
+    }
+
     /* Return the extended object. */
     return (ModelDesc*)m;
 }
@@ -61,14 +295,23 @@ ModelDesc* model_create(ModelDesc* model)
 int model_step(ModelDesc* model, double* model_time, double stop_time)
 {
     ExtendedModelDesc* m = (ExtendedModelDesc*)model;
+
     for (SignalVector* sv = m->model.sv; sv->name; sv++) {
-        uint32_t count =
-            _get_signal_change(sv, m->signal_change, &m->change_seed);
-        log_info("Signal count is : %d", count);
-        for (size_t i = 0; i < count; i++) {
-            sv->scalar[i] += 1.2;
+        if (sv->is_binary) {
+            _exchange_frames(m, sv);
+        } else {
+            _change_signals(m, sv);
         }
     }
+    _compute(m);
+
     *model_time = stop_time;
     return 0;
 }
+
+
+void model_destroy(ModelDesc* model)
+{
+    ExtendedModelDesc* m = (ExtendedModelDesc*)model;
+    free(m->memory);
+}
@@ -248,5 +248,13 @@ DLL_PUBLIC void*       signal_codec(SignalVector* sv, uint32_t index);
 DLL_PUBLIC const char* signal_annotation(
     SignalVector* sv, uint32_t index, const char* name);
 
+/* Provided by ModelC. */
+struct NCodecCanMessage;
+DLL_PUBLIC int signal_changed(
+    SignalVector* sv, const uint32_t** index, uint32_t* count);
+DLL_PUBLIC int signal_frame_read(SignalVector* sv, uint32_t index,
+    const uint32_t* frame_id, uint32_t frame_id_count,
+    const struct NCodecCanMessage** frames, uint32_t* count);
+
 
 #endif  // DSE_MODELC_MODEL_H_
@@ -10,6 +10,9 @@
 #include <dse/clib/collections/set.h>
 #include <dse/clib/collections/hashmap.h>
 #include <dse/clib/util/yaml.h>
+#include <dse/modelc/adapter/intern.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/adapter/realtime.h>
 #include <dse/modelc/controller/controller.h>
 #include <dse/modelc/model.h>
 #include <dse/modelc/schema.h>
@@ -22,6 +25,7 @@ typedef struct __signal_list_t {
     const char**     names;
     uint32_t         length;
     SignalTransform* transform;
+    SignalDeadband*  deadband;
 } __signal_list_t;
 
 
@@ -31,6 +35,49 @@ typedef enum ModelChannelType {
 } ModelChannelType;
 
 
+/* Storage of the signal vectors of a Model Function Channel (accounted). */
+static int64_t _vector_storage_size(uint32_t count, bool binary)
+{
+    /* Includes the changed index (uint32_t). */
+    if (binary) {
+        return count * (sizeof(void*) + 3 * sizeof(uint32_t) + sizeof(bool));
+    }
+    return count * (sizeof(double) + sizeof(uint32_t));
+}
+
+
+/* Release the signal storage of an MFC, the MFC can be configured again. */
+static void _mfc_release(ModelFunctionChannel* mfc)
+{
+    if (mfc->signal_value_double) {
+        realtime_free(mfc->signal_value_double);
+        memstat_add(MEMSTAT_CONTROLLER,
+            -_vector_storage_size(mfc->signal_count, false));
+    }
+    if (mfc->signal_value_binary) {
+        memstat_add(MEMSTAT_CONTROLLER,
+            -_vector_storage_size(mfc->signal_count, true));
+        for (uint32_t _ = 0; _ < mfc->signal_count; _++) {
+            if ((void*)mfc->signal_value_binary[_])
+                free((void*)mfc->signal_value_binary[_]);
+        }
+        free(mfc->signal_value_binary);
+    }
+    if (mfc->signal_value_binary_size) free(mfc->signal_value_binary_size);
+    if (mfc->signal_value_binary_buffer_size)
+        free(mfc->signal_value_binary_buffer_size);
+    if (mfc->signal_value_binary_reset_called)
+        free(mfc->signal_value_binary_reset_called);
+    if (mfc->signal_changed) free(mfc->signal_changed);
+    if (mfc->signal_changed_map) free(mfc->signal_changed_map);
+    if (mfc->signal_names) free(mfc->signal_names);
+    if (mfc->signal_map) free(mfc->signal_map);
+    if (mfc->signal_transform) free(mfc->signal_transform);
+    if (mfc->signal_deadband) free(mfc->signal_deadband);
+    *mfc = (ModelFunctionChannel){ .channel_name = mfc->channel_name };
+}
+
+
 void model_function_destroy(ModelFunction* model_function)
 {
     if (model_function) {
@@ -39,26 +86,7 @@ void model_function_destroy(ModelFunction* model_function)
         for (uint32_t i = 0; i < _keys_length; i++) {
             ModelFunctionChannel* _mfc =
                 hashmap_get(&model_function->channels, _keys[i]);
-            if (_mfc && _mfc->signal_value_double)
-                free(_mfc->signal_value_double);
-            if (_mfc && _mfc->signal_value_binary) {
-                for (uint32_t _ = 0; _ < _mfc->signal_count; _++) {
-                    if ((void*)_mfc->signal_value_binary[_])
-                        free((void*)_mfc->signal_value_binary[_]);
-                }
-                free(_mfc->signal_value_binary);
-            }
-            if (_mfc && _mfc->signal_value_binary_size)
-                free(_mfc->signal_value_binary_size);
-            if (_mfc && _mfc->signal_value_binary_buffer_size)
-                free(_mfc->signal_value_binary_buffer_size);
-            if (_mfc && _mfc->signal_value_binary_reset_called)
-                free(_mfc->signal_value_binary_reset_called);
-            if (_mfc && _mfc->signal_names) {
-                free(_mfc->signal_names);
-            }
-            if (_mfc && _mfc->signal_map) free(_mfc->signal_map);
-            if (_mfc && _mfc->signal_transform) free(_mfc->signal_transform);
+            if (_mfc) _mfc_release(_mfc);
         }
         hashmap_destroy(&model_function->channels);
         for (uint32_t _ = 0; _ < _keys_length; _++)
@@ -98,6 +126,7 @@ static ModelFunctionChannel* _get_mfc(ModelInstanceSpec* model_instance,
 static HashList         __handler_signal_list;
 static ModelChannelType __handler_signal_vector_type;
 static HashMap          __handler_transform_map;
+static HashMap          __handler_deadband_map;
 
 
 static SignalTransform* _parse_signal_transform(SchemaSignalObject* so)
@@ -121,11 +150,39 @@ static SignalTransform* _parse_signal_transform(SchemaSignalObject* so)
 }
 
 
+static SignalDeadband* _parse_signal_deadband(
+    SchemaSignalObject* so, SignalDeadband* group_deadband)
+{
+    SignalDeadband db = *group_deadband;
+    YamlNode*      a_node = dse_yaml_find_node(so->data, "annotations");
+    if (a_node) {
+        dse_yaml_get_double(a_node, "deadband", &db.absolute);
+        dse_yaml_get_double(a_node, "deadband_relative", &db.relative);
+    }
+    if (db.absolute == 0.0 && db.relative == 0.0) return NULL;
+
+    /* Create an object for the deadband. */
+    SignalDeadband* sd = malloc(sizeof(SignalDeadband));
+    *sd = db;
+    return sd;
+}
+
+
 static int _signal_group_match_handler(
     ModelInstanceSpec* model_instance, SchemaObject* object)
 {
     uint32_t index = 0;
 
+    /* Deadband annotations of the SignalGroup apply to all its signals. */
+    SignalDeadband group_deadband = { 0 };
+    YamlNode*      ga_node =
+        dse_yaml_find_node(object->doc, "metadata/annotations");
+    if (ga_node) {
+        dse_yaml_get_double(ga_node, "deadband", &group_deadband.absolute);
+        dse_yaml_get_double(
+            ga_node, "deadband_relative", &group_deadband.relative);
+    }
+
     /* Enumerate over the signals. */
     SchemaSignalObject* so;
     do {
@@ -139,6 +196,10 @@ static int _signal_group_match_handler(
             /* Locate an associated signal transform. */
             SignalTransform* st = _parse_signal_transform(so);
             if (st) hashmap_set_alt(&__handler_transform_map, so->signal, st);
+
+            /* Locate an associated signal deadband. */
+            SignalDeadband* sd = _parse_signal_deadband(so, &group_deadband);
+            if (sd) hashmap_set_alt(&__handler_deadband_map, so->signal, sd);
         }
         free(so);
     } while (1);
@@ -200,6 +261,7 @@ void _load_signals(ModelInstanceSpec* model_instance, ChannelSpec* channel_spec,
     /* Setup handler related storage. */
     hashlist_init(&__handler_signal_list, 512);
     hashmap_init(&__handler_transform_map);
+    hashmap_init(&__handler_deadband_map);
     __handler_signal_vector_type = *vector_type;
     /* Select and handle the schema objects (default name to provided name). */
     SchemaObjectSelector* selector = schema_build_channel_selector(
@@ -213,13 +275,19 @@ void _load_signals(ModelInstanceSpec* model_instance, ChannelSpec* channel_spec,
     if (signal_list->length) {
         signal_list->names = calloc(signal_list->length, sizeof(const char*));
         for (uint32_t i = 0; i < signal_list->length; i++) {
-            signal_list->names[i] = hashlist_at(&__handler_signal_list, i);
+            signal_list->names[i] =
+                intern_str(hashlist_at(&__handler_signal_list, i));
             log_info("  signal[%u] : %s", i, signal_list->names[i]);
             SignalTransform* st =
                 hashmap_get(&__handler_transform_map, signal_list->names[i]);
             if (st)
                 log_info("    transform[linear] : factor=%f, offset=%f",
                     st->linear.factor, st->linear.offset);
+            SignalDeadband* sd =
+                hashmap_get(&__handler_deadband_map, signal_list->names[i]);
+            if (sd)
+                log_info("    deadband : absolute=%f, relative=%f",
+                    sd->absolute, sd->relative);
         }
     }
     *vector_type = __handler_signal_vector_type;
@@ -235,10 +303,67 @@ void _load_signals(ModelInstanceSpec* model_instance, ChannelSpec* channel_spec,
             memcpy(&signal_list->transform[i], st, sizeof(SignalTransform));
         }
     }
+    /* Construct the signal deadband list. */
+    if (hashmap_number_keys(__handler_deadband_map)) {
+        signal_list->deadband =
+            calloc(signal_list->length, sizeof(SignalDeadband));
+        for (size_t i = 0; i < signal_list->length; i++) {
+            SignalDeadband* sd =
+                hashmap_get(&__handler_deadband_map, signal_list->names[i]);
+            if (sd == NULL) continue;
+            signal_list->deadband[i] = *sd;
+        }
+    }
     /* Clear handler related storage. */
     schema_release_selector(selector);
     hashlist_destroy(&__handler_signal_list);
     hashmap_destroy(&__handler_transform_map);
+    hashmap_destroy(&__handler_deadband_map);
+}
+
+
+static void _signal_list_free(__signal_list_t* signal_list)
+{
+    free(signal_list->names);
+    free(signal_list->transform);
+    free(signal_list->deadband);
+    *signal_list = (__signal_list_t){ 0 };
+}
+
+
+static bool _signal_list_equal(ModelFunctionChannel* mfc,
+    __signal_list_t* signal_list, ModelChannelType vector_type)
+{
+    bool binary = (mfc->signal_value_binary != NULL);
+    if (binary != (vector_type == MODEL_VECTOR_BINARY)) return false;
+    if (mfc->signal_count != signal_list->length) return false;
+    /* Signal names are interned. */
+    for (uint32_t i = 0; i < signal_list->length; i++) {
+        if (mfc->signal_names[i] != signal_list->names[i]) return false;
+    }
+    return true;
+}
+
+
+/* Values of the scalar signals retained by a changed signal set (caller to
+   free). */
+static double* _mfc_retain_values(ModelFunctionChannel* mfc,
+    __signal_list_t* signal_list, ModelChannelType vector_type)
+{
+    if (mfc->signal_value_double == NULL) return NULL;
+    if (vector_type != MODEL_VECTOR_DOUBLE) return NULL;
+    if (signal_list->length == 0) return NULL;
+
+    double* values = calloc(signal_list->length, sizeof(double));
+    for (uint32_t i = 0; i < signal_list->length; i++) {
+        for (uint32_t j = 0; j < mfc->signal_count; j++) {
+            if (signal_list->names[i] == mfc->signal_names[j]) {
+                values[i] = mfc->signal_value_double[j];
+                break;
+            }
+        }
+    }
+    return values;
 }
 
 
@@ -250,6 +375,11 @@ Configure a connection from this Model to a Channel on the Simulation Bus. The
 Channel can then be represented by a Signal Vector making access to individual
 Signals and their configuration (annotations) easy.
 
+A Channel which is already configured (e.g. when the Model is reloaded) keeps
+its Signal Vector storage. When the signal set of the Channel has changed, the
+Channel is configured again and the values of the retained (scalar) signals
+are kept.
+
 Parameters
 ----------
 model_instance (ModelInstanceSpec*)
@@ -291,36 +421,45 @@ int model_configure_channel(
         return 1;
     }
 
-    /* Already configured? Then return.*/
-    if (mfc->signal_names && mfc->signal_count) {
-        // Enforce that only one signal vector is set, no matter what.
-        if (mfc->signal_value_double)
-            channel_desc->vector_double = mfc->signal_value_double;
-        else if (mfc->signal_value_binary)
-            channel_desc->vector_binary = mfc->signal_value_binary;
-        else {
-            log_error("Already configured channel did not have initialised "
-                      "signal vector!");
-            free(channel_spec);
-            return 1;
-        }
-        log_notice(
-            "Previously configured channel detected: %s", channel_spec->name);
-        channel_desc->signal_count = mfc->signal_count;
-        free(channel_spec);
-        return 0;
-    }
-
     /* Load signals via SignalGroups. */
-    __signal_list_t  signal_list = { NULL, 0 };
+    __signal_list_t  signal_list = { 0 };
     ModelChannelType vector_type = MODEL_VECTOR_DOUBLE;
     assert(model_instance->spec);
     _load_signals(model_instance, channel_spec, &signal_list, &vector_type);
     log_notice("  Unique signals identified: %u", signal_list.length);
 
+    /* Already configured (e.g. reload of the Model)? Then return, unless the
+       signal set has changed. */
+    double* retained = NULL;
+    if (mfc->signal_names && mfc->signal_count) {
+        if (_signal_list_equal(mfc, &signal_list, vector_type)) {
+            _signal_list_free(&signal_list);
+            // Enforce that only one signal vector is set, no matter what.
+            if (mfc->signal_value_double)
+                channel_desc->vector_double = mfc->signal_value_double;
+            else if (mfc->signal_value_binary)
+                channel_desc->vector_binary = mfc->signal_value_binary;
+            else {
+                log_error("Already configured channel did not have "
+                          "initialised signal vector!");
+                free(channel_spec);
+                return 1;
+            }
+            log_notice("Previously configured channel detected: %s",
+                channel_spec->name);
+            channel_desc->signal_count = mfc->signal_count;
+            free(channel_spec);
+            return 0;
+        }
+        log_notice("Signal set changed, configure channel again: %s",
+            channel_spec->name);
+        retained = _mfc_retain_values(mfc, &signal_list, vector_type);
+        _mfc_release(mfc);
+    }
+
     /* Init the channel and register signals. */
     controller_init_channel(model_instance, channel_spec->name,
-        signal_list.names, signal_list.length);
+        signal_list.names, signal_list.length, signal_list.deadband);
 
     free(channel_spec);
 
@@ -328,8 +467,16 @@ int model_configure_channel(
     log_info("Allocate signal vector type %d for %u signals.", vector_type,
         signal_list.length);
     if (vector_type == MODEL_VECTOR_DOUBLE) {
-        mfc->signal_value_double = calloc(signal_list.length, sizeof(double));
+        mfc->signal_value_double =
+            realtime_calloc(signal_list.length, sizeof(double));
+        if (retained) {
+            memcpy(mfc->signal_value_double, retained,
+                signal_list.length * sizeof(double));
+            free(retained);
+        }
         channel_desc->vector_double = mfc->signal_value_double;
+        memstat_add(MEMSTAT_CONTROLLER,
+            _vector_storage_size(signal_list.length, false));
         log_debug("%p", channel_desc->vector_double);
     } else if (vector_type == MODEL_VECTOR_BINARY) {
         /* Allocate the binary vectors. */
@@ -345,17 +492,22 @@ int model_configure_channel(
         channel_desc->vector_binary_size = mfc->signal_value_binary_size;
         channel_desc->vector_binary_buffer_size =
             mfc->signal_value_binary_buffer_size;
+        memstat_add(MEMSTAT_CONTROLLER,
+            _vector_storage_size(signal_list.length, true));
     } else {
         log_error("Unsupported signal vector type! No signals available for "
                   "channel!");
         channel_desc->signal_count = 0;
         return 1;
     }
+    mfc->signal_changed = calloc(signal_list.length, sizeof(uint32_t));
+    mfc->signal_changed_count = 0;
 
     /* MFC is owner and should free. */
     mfc->signal_count = channel_desc->signal_count = signal_list.length;
     mfc->signal_names = channel_desc->signal_names = signal_list.names;
     mfc->signal_transform = signal_list.transform;
+    mfc->signal_deadband = signal_list.deadband;
 
     /* Brutal, eh? */
     return 0;
@@ -4,6 +4,9 @@
 
 #include <errno.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/ncodec/codec.h>
@@ -13,6 +16,23 @@
 #define UNUSED(x) ((void)x)
 
 
+/* Frame Index of a binary signal (see model_sv_stream_frames()). */
+typedef struct __FrameIndex {
+    bool              valid;
+    /* State of the binary signal when the index was built. */
+    uint32_t          seq;
+    void*             binary;
+    uint32_t          length;
+    /* Frames (views), sorted by frame_id, node_id and stream position. */
+    NCodecCanMessage* frame;
+    uint32_t          count;
+    uint32_t          size;
+    /* Result of the most recent lookup. */
+    NCodecCanMessage* result;
+    uint32_t          result_size;
+} __FrameIndex;
+
+
 /* Stream Interface for binary signals (supports NCodec). */
 typedef struct __BinarySignalStream {
     NCodecStreamVTable s;
@@ -20,6 +40,9 @@ typedef struct __BinarySignalStream {
     SignalVector*      sv;
     uint32_t           idx;
     uint32_t           pos;
+    /* Frame Index. */
+    const uint32_t*    seq; /* Marshal sequence (optional). */
+    __FrameIndex       index;
 } __BinarySignalStream;
 
 
@@ -63,6 +86,7 @@ static size_t stream_write(NCODEC* nc, uint8_t* data, size_t len)
     uint32_t              s_len = _s->sv->length[_s->idx];
 
     /* Write from current pos (i.e. truncate). */
+    _s->index.valid = false;
     if (_s->pos > s_len) _s->pos = s_len;
     _s->sv->length[_s->idx] = _s->pos;
     _s->sv->append(_s->sv, _s->idx, data, len);
@@ -95,6 +119,7 @@ static int64_t stream_seek(NCODEC* nc, size_t pos, int op)
             _s->pos = s_len;
         } else if (op == NCODEC_SEEK_RESET) {
             /* Reset before stream_write has truncate effect. */
+            _s->index.valid = false;
             _s->pos = 0;
             _s->sv->length[_s->idx] = 0;
             _s->sv->reset_called[_s->idx] = true;
@@ -162,7 +187,190 @@ void* model_sv_stream_create(SignalVector* sv, uint32_t idx)
 
 void model_sv_stream_destroy(void* stream)
 {
-    if (stream) free(stream);
+    if (stream) {
+        __BinarySignalStream* _s = stream;
+        free(_s->index.frame);
+        free(_s->index.result);
+        free(stream);
+    }
+}
+
+void model_sv_stream_set_seq(void* stream, const uint32_t* seq)
+{
+    if (stream) ((__BinarySignalStream*)stream)->seq = seq;
+}
+
+
+/* Frame Index. */
+
+static int _frame_compare(const void* left, const void* right)
+{
+    const NCodecCanMessage* l = left;
+    const NCodecCanMessage* r = right;
+
+    if (l->frame_id != r->frame_id) return (l->frame_id < r->frame_id) ? -1 : 1;
+    if (l->sender.node_id != r->sender.node_id) {
+        return (l->sender.node_id < r->sender.node_id) ? -1 : 1;
+    }
+    /* Same frame/node, keep the stream order (buffer position). */
+    if (l->buffer != r->buffer) return (l->buffer < r->buffer) ? -1 : 1;
+    return 0;
+}
+
+static bool _frame_index_valid(__BinarySignalStream* s)
+{
+    __FrameIndex* index = &s->index;
+    if (index->valid == false) return false;
+    if (s->seq && *s->seq != index->seq) return false;
+    if (s->sv->binary[s->idx] != index->binary) return false;
+    if (s->sv->length[s->idx] != index->length) return false;
+    return true;
+}
+
+static int _frame_index_build(void* nc, __BinarySignalStream* s)
+{
+    __FrameIndex* index = &s->index;
+    uint32_t      pos = s->pos;
+
+    /* Decode each frame (once) from the start of the stream, the frames
+       reference the stream buffer. The stream position is restored. */
+    index->count = 0;
+    s->pos = 0;
+    while (1) {
+        NCodecCanMessage msg = {};
+        int              len = ncodec_read(nc, &msg);
+        if (len < 0) break;
+        if (index->count == index->size) {
+            uint32_t size = index->size ? index->size * 2 : 64;
+            void*    p = realloc(index->frame, size * sizeof(NCodecCanMessage));
+            if (p == NULL) {
+                s->pos = pos;
+                return -ENOMEM;
+            }
+            index->frame = p;
+            index->size = size;
+        }
+        index->frame[index->count++] = msg;
+    }
+    s->pos = pos;
+    if (index->count > 1) {
+        qsort(index->frame, index->count, sizeof(NCodecCanMessage),
+            _frame_compare);
+    }
+
+    index->seq = s->seq ? *s->seq : 0;
+    index->binary = s->sv->binary[s->idx];
+    index->length = s->sv->length[s->idx];
+    index->valid = true;
+    return 0;
+}
+
+static uint32_t _frame_lower_bound(__FrameIndex* index, uint32_t frame_id)
+{
+    uint32_t lo = 0;
+    uint32_t hi = index->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->frame[mid].frame_id < frame_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int _frame_result_add(__FrameIndex* index, uint32_t count,
+    const NCodecCanMessage* frame, uint32_t frame_count)
+{
+    if (count + frame_count > index->result_size) {
+        uint32_t size = count + frame_count;
+        void*    p = realloc(index->result, size * sizeof(NCodecCanMessage));
+        if (p == NULL) return -ENOMEM;
+        index->result = p;
+        index->result_size = size;
+    }
+    memcpy(&index->result[count], frame,
+        frame_count * sizeof(NCodecCanMessage));
+    return 0;
+}
+
+/**
+ *  model_sv_stream_frames
+ *
+ *  Read the frames of a binary signal stream, filtered by frame_id. The frames
+ *  of the stream are decoded once (with the NCodec) and indexed, the index is
+ *  rebuilt only when the binary signal changes (i.e. on the next step). The
+ *  index is built from the start of the stream, the stream position is not
+ *  changed (e.g. frames written in this step are also selected).
+ *
+ *  Parameters
+ *  ----------
+ *  nc : void* (NCODEC*)
+ *      The NCodec object of the binary signal.
+ *  frame_id : const uint32_t*
+ *      List of frame_ids to select, NULL selects all frames.
+ *  frame_id_count : uint32_t
+ *      Number of frame_ids in the list.
+ *  frames : const NCodecCanMessage**
+ *      Pointer which is set to the selected frames (views, referencing the
+ *      stream buffer). The frames are ordered by frame_id (in order of the
+ *      frame_id list), node_id and stream position.
+ *  count : uint32_t*
+ *      Pointer to a variable which is set to the number of selected frames.
+ *
+ *  Returns
+ *  -------
+ *      0 : The frames were selected.
+ *      -ENOSTR : The NCodec object has no (binary signal) stream.
+ *      -ENOMEM : The index could not be allocated.
+ */
+int model_sv_stream_frames(void* nc, const uint32_t* frame_id,
+    uint32_t frame_id_count, const NCodecCanMessage** frames, uint32_t* count)
+{
+    NCodecInstance* _nc = (NCodecInstance*)nc;
+    if (_nc == NULL || _nc->stream == NULL) return -ENOSTR;
+    if (_nc->stream->read != stream_read) return -ENOSTR;
+
+    __BinarySignalStream* _s = (__BinarySignalStream*)_nc->stream;
+    __FrameIndex*         index = &_s->index;
+    int                   rc;
+
+    *frames = NULL;
+    *count = 0;
+    if (_frame_index_valid(_s) == false) {
+        rc = _frame_index_build(nc, _s);
+        if (rc) return rc;
+    }
+    if (index->count == 0) return 0;
+
+    /* All frames. */
+    if (frame_id == NULL) {
+        *frames = index->frame;
+        *count = index->count;
+        return 0;
+    }
+
+    /* Selected frames, lookup each frame_id. */
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < frame_id_count; i++) {
+        uint32_t first = _frame_lower_bound(index, frame_id[i]);
+        uint32_t last = first;
+        while (last < index->count &&
+               index->frame[last].frame_id == frame_id[i]) {
+            last++;
+        }
+        if (last == first) continue;
+        rc = _frame_result_add(index, n, &index->frame[first], last - first);
+        if (rc) return rc;
+        n += last - first;
+    }
+    if (n) {
+        *frames = index->result;
+        *count = n;
+    }
+
+    return 0;
 }
 
 
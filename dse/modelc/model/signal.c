@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <stdlib.h>
+#include <errno.h>
 #include <assert.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
@@ -274,6 +275,7 @@ static int _add_sv(void* _mfc, void* _sv_data)
             void*   stream = model_sv_stream_create(current_sv, i);
             NCODEC* nc = ncodec_open(current_sv->mime_type[i], stream);
             if (nc) {
+                model_sv_stream_set_seq(stream, &mfc->signal_value_binary_seq);
                 ncodec_trace_configure(nc, data->mi);
                 current_sv->ncodec[i] = nc;
             } else {
@@ -609,3 +611,155 @@ NULL
 */
 extern const char* signal_annotation(
     SignalVector* sv, uint32_t index, const char* name);
+
+
+/**
+signal_changed
+==============
+
+Get the list of signals which were changed (i.e. updated by the SimBus) since
+the previous step of the Model. Event driven Models can use this list to
+operate only on changed signals, rather than scanning the entire Signal
+Vector.
+
+The list is updated before each step of the Model and remains valid until the
+next step.
+
+Parameters
+----------
+sv (SignalVector*)
+: The Signal Vector object containing the signals.
+
+index (const uint32_t**)
+: Pointer which is set to the list of changed signal indexes (in ascending
+  order), NULL if no signals changed.
+
+count (uint32_t*)
+: Pointer to a variable which is set to the number of changed signals.
+
+Returns
+-------
+0
+: The operation completed without error.
+
+-EINVAL (-22)
+: Bad arguments.
+
+Example (Code Usage)
+-------
+
+```c
+const uint32_t* index;
+uint32_t        count;
+signal_changed(sv, &index, &count);
+for (uint32_t i = 0; i < count; i++) {
+    process(sv->signal[index[i]], sv->scalar[index[i]]);
+}
+```
+*/
+int signal_changed(SignalVector* sv, const uint32_t** index, uint32_t* count)
+{
+    if (sv == NULL || index == NULL || count == NULL) return -EINVAL;
+
+    *index = NULL;
+    *count = 0;
+    if (sv->mi == NULL || sv->mi->private == NULL) return 0;
+
+    /* The index list is held by the Model Function Channel (not part of the
+       SignalVector ABI). */
+    ModelFunction* mf =
+        controller_get_model_function(sv->mi, sv->function_name);
+    if (mf == NULL) return 0;
+    ModelFunctionChannel* mfc = hashmap_get(&mf->channels, sv->name);
+    if (mfc == NULL || mfc->signal_changed == NULL) return 0;
+    if (mfc->signal_changed_count) {
+        *index = mfc->signal_changed;
+        *count = mfc->signal_changed_count;
+    }
+
+    return 0;
+}
+
+
+/**
+signal_frame_read
+=================
+
+Read the frames of a binary signal (with a Network Codec) selected by their
+frame_id. The frames of the binary signal are decoded once per step and
+indexed by frame_id and node_id, a Model then only receives the frames it is
+interested in (without decoding and discarding unrelated frames).
+
+The index is built on the first call after the binary signal was updated
+(i.e. once per step). When building the index all frames of the binary
+signal are read from the Network Codec (from the start of the stream), the
+position of the stream is not changed. The selected frames reference the
+buffer of the binary signal and remain valid until the binary signal is
+modified (e.g. by signal_reset()) or the next step of the Model.
+
+Parameters
+----------
+sv (SignalVector*)
+: The Signal Vector object containing the signals.
+
+index (uint32_t)
+: Index of the binary signal.
+
+frame_id (const uint32_t*)
+: List of frame_ids to select, NULL selects all frames.
+
+frame_id_count (uint32_t)
+: Number of frame_ids in the list.
+
+frames (const NCodecCanMessage**)
+: Pointer which is set to the selected frames, NULL if no frames were
+  selected. The frames are ordered by frame_id (in the order of the frame_id
+  list), then by node_id and finally in the order of the stream.
+
+count (uint32_t*)
+: Pointer to a variable which is set to the number of selected frames.
+
+Returns
+-------
+0
+: The operation completed without error.
+
+-EINVAL (-22)
+: Bad arguments.
+
+-ENOSTR (-60)
+: The binary signal has no Network Codec.
+
+-ENOMEM (-12)
+: The frame index could not be allocated.
+
+Example (Code Usage)
+-------
+
+```c
+static const uint32_t rx_frames[] = { 0x101, 0x2f0 };
+
+const NCodecCanMessage* frames;
+uint32_t                count;
+signal_frame_read(sv, 0, rx_frames, 2, &frames, &count);
+for (uint32_t i = 0; i < count; i++) {
+    process(frames[i].frame_id, frames[i].buffer, frames[i].len);
+}
+signal_reset(sv, 0);
+```
+*/
+int signal_frame_read(SignalVector* sv, uint32_t index,
+    const uint32_t* frame_id, uint32_t frame_id_count,
+    const NCodecCanMessage** frames, uint32_t* count)
+{
+    if (sv == NULL || frames == NULL || count == NULL) return -EINVAL;
+    if (sv->is_binary == false || index >= sv->count) return -EINVAL;
+    if (frame_id == NULL && frame_id_count) return -EINVAL;
+
+    *frames = NULL;
+    *count = 0;
+    if (sv->ncodec == NULL || sv->ncodec[index] == NULL) return -ENOSTR;
+
+    return model_sv_stream_frames(
+        sv->ncodec[index], frame_id, frame_id_count, frames, count);
+}
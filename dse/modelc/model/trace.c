@@ -42,9 +42,9 @@ static const char* _get_codec_config(NCodecInstance* nc, const char* name)
 static void _trace_log(
     NCodecInstance* nc, NCodecMessage* m, const char* direction)
 {
-    NCodecTraceData*  td = nc->private;
-    NCodecCanMessage* msg = m;
-    static char       b[NCT_BUFFER_LEN];
+    NCodecTraceData*     td = nc->private;
+    NCodecCanMessage*    msg = m;
+    static __thread char b[NCT_BUFFER_LEN];
 
     /* Setup bus identifier (on first call). */
     if (strlen(td->bus_identifier) == 0) {
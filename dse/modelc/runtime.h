@@ -84,6 +84,10 @@ typedef struct SimulationSpec {
     const char*        sim_path;
     /* Operational properties needed for loopback operation. */
     bool               mode_loopback;
+    /* Realtime Profile (see adapter/realtime.h), NULL if not configured. */
+    const char*        realtime;
+    /* Receive on an I/O thread (see adapter/transport/prefetch.h). */
+    bool               prefetch;
 } SimulationSpec;
 
 
@@ -110,6 +114,8 @@ typedef struct ModelCArguments {
     uint32_t    steps;
     /* The simulation is in a different location (i.e. not the CWD). */
     const char* sim_path;
+    /* Realtime Profile (e.g. "cpu=2,priority=80,mlock"). */
+    const char* realtime;
 } ModelCArguments;
 
 
@@ -145,6 +151,10 @@ DLL_PUBLIC void          model_sv_destroy(SignalVector* sv);
 /* ncodec.c - Stream Interface (for NCodec). */
 DLL_PRIVATE void* model_sv_stream_create(SignalVector* sv, uint32_t idx);
 DLL_PRIVATE void  model_sv_stream_destroy(void* stream);
+DLL_PRIVATE void  model_sv_stream_set_seq(void* stream, const uint32_t* seq);
+DLL_PRIVATE int   model_sv_stream_frames(void* nc, const uint32_t* frame_id,
+      uint32_t frame_id_count, const struct NCodecCanMessage** frames,
+      uint32_t* count);
 
 
 /* model.c - Model Interface. */
@@ -5,12 +5,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <unistd.h>
 #include <dse/clib/util/yaml.h>
 #include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/intern.h>
+#include <dse/modelc/adapter/realtime.h>
 #include <dse/modelc/adapter/simbus/simbus.h>
 #include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/controller/controller.h>
 #include <dse/modelc/runtime.h>
 #include <dse/logger.h>
 
@@ -27,6 +31,29 @@
 #define MODEL_NAME          "simbus"
 
 
+/* Print the Channel Statistics written by a running SimBus. */
+static int _print_stats(const char* path)
+{
+    if (path == NULL) {
+        fprintf(stderr, "Statistics file not specified (use --stats <file> "
+                        "or set " ENV_SIMBUS_STATSFILE ")!\n");
+        return 1;
+    }
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Statistics file not available: %s\n", path);
+        return 1;
+    }
+    char   buffer[1024];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        fwrite(buffer, 1, len, stdout);
+    }
+    fclose(file);
+    return 0;
+}
+
+
 /* SimBus main program entry point. */
 int main(int argc, char** argv)
 {
@@ -34,6 +61,11 @@ int main(int argc, char** argv)
 
     ModelCArguments args;
 
+    /* Query the statistics of a running SimBus. */
+    if (argc > 1 && strcmp(argv[1], "--stats") == 0) {
+        exit(_print_stats(argc > 2 ? argv[2] : getenv(ENV_SIMBUS_STATSFILE)));
+    }
+
     /* Additional bookkeeping data. */
     log_notice("Version: %s", MODELC_VERSION);
 
@@ -69,36 +101,19 @@ int main(int argc, char** argv)
     log_notice("  Model UID: %d", adapter->bus_adapter_model->model_uid);
 
 
-    /* Configure all specified channels. */
-    YamlNode* model_node;
-    model_node = dse_yaml_find_node_in_seq_in_doclist(
+    /* Configure the Bus (channels, deadband and lookahead). */
+    simbus_host_configure(adapter, args.yaml_doc_list, args.name);
+    YamlNode* model_node = dse_yaml_find_node_in_seq_in_doclist(
         args.yaml_doc_list, "Stack", "spec/models", "name", args.name);
-    YamlNode* ch_seq_node;
-    ch_seq_node = dse_yaml_find_node(model_node, "channels");
-    if (ch_seq_node) {
-        for (uint32_t i = 0; i < hashlist_length(&ch_seq_node->sequence); i++) {
-            YamlNode* ch_node = hashlist_at(&ch_seq_node->sequence, i);
-            YamlNode* n_node = dse_yaml_find_node(ch_node, "name");
-            YamlNode* emc_node =
-                dse_yaml_find_node(ch_node, "expectedModelCount");
-            uint32_t _model_count = (emc_node) ? atol(emc_node->scalar) : 0;
-
-            log_notice("  Channel: %s (expected models=%u)", n_node->scalar,
-                _model_count);
-            adapter_init_channel(
-                adapter->bus_adapter_model, n_node->scalar, NULL, 0);
-            simbus_adapter_init_channel(
-                adapter->bus_adapter_model, n_node->scalar, _model_count);
-        }
-    } else {
-        /* Fallback if missing configuration. */
-        log_error("No channel configuration found, fallback ...");
-        log_error(
-            "  Channel: %s (expected models=%u)", ADAPTER_FALLBACK_CHANNEL, 1);
-        adapter_init_channel(
-            adapter->bus_adapter_model, ADAPTER_FALLBACK_CHANNEL, NULL, 0);
-        simbus_adapter_init_channel(
-            adapter->bus_adapter_model, ADAPTER_FALLBACK_CHANNEL, 1);
+
+    /* Realtime Profile, CLI or Stack annotation. */
+    const char* realtime = args.realtime;
+    if (realtime == NULL && model_node) {
+        YamlNode* a_node = dse_yaml_find_node(model_node, "annotations");
+        if (a_node) realtime = dse_yaml_get_scalar(a_node, REALTIME_ANNOTATION);
+    }
+    if (realtime_configure(realtime)) {
+        log_error("Realtime profile not correctly specified: %s", realtime);
     }
 
     log_notice("Start the Bus ...");
@@ -115,6 +130,7 @@ int main(int argc, char** argv)
         log_simbus("========================================");
     }
     adapter_destroy(adapter);
+    intern_destroy();
 
     exit(0);
 }
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# Copyright 2024 Robert Bosch GmbH
+#
+# SPDX-License-Identifier: Apache-2.0
+"""
+Merge the timeline files (SIMBUS_TIMELINE) of a simulation into one Chrome
+Trace Event file, which can be loaded by Perfetto (ui.perfetto.dev) or
+chrome://tracing.
+
+    $ merge.py -o sim.json /tmp/sim.simbus.1234.json /tmp/sim.modelc.*.json
+
+Each event is annotated with the bus cycle (args.cycle), the index of its
+simulation time in the merged set of simulation times. Processes with the same
+pid (i.e. from different hosts) are assigned a new pid.
+
+The timelines of processes on the same host share the monotonic clock. For
+processes on different hosts use --align, which offsets the clock of each file
+so that its first span of the first common simulation time starts with that of
+the first file (i.e. the transport latency of that cycle is not visible).
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        doc = json.load(f)
+    if isinstance(doc, list):
+        return doc
+    return doc.get('traceEvents', [])
+
+
+def span_times(events):
+    return {round(e['args']['time'], 9) for e in events
+            if e.get('ph') == 'X' and 'time' in e.get('args', {})}
+
+
+def first_ts(events, time):
+    ts = [e['ts'] for e in events if e.get('ph') == 'X'
+          and round(e.get('args', {}).get('time', -1), 9) == time]
+    return min(ts) if ts else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Merge timeline files.')
+    parser.add_argument('files', nargs='+', help='timeline files')
+    parser.add_argument('-o', '--output', default='-', help='output file')
+    parser.add_argument('--align', action='store_true',
+                        help='align the clocks of the files (cross host)')
+    args = parser.parse_args()
+
+    timelines = [load(p) for p in args.files]
+
+    # Clock alignment, by the first simulation time common to all files.
+    offsets = [0.0] * len(timelines)
+    if args.align and len(timelines) > 1:
+        common = set.intersection(*[span_times(t) for t in timelines])
+        if common:
+            t0 = min(common)
+            ref = first_ts(timelines[0], t0)
+            for i, t in enumerate(timelines):
+                offsets[i] = ref - first_ts(t, t0)
+        else:
+            print('No common simulation time, clocks not aligned.',
+                  file=sys.stderr)
+
+    # Bus cycle numbers, from the merged simulation times.
+    times = sorted(set().union(*[span_times(t) for t in timelines]))
+    cycle = {t: i for i, t in enumerate(times)}
+
+    merged = []
+    used_pids = set()
+    next_pid = 1 + max([e.get('pid', 0) for t in timelines for e in t] + [0])
+    for i, events in enumerate(timelines):
+        pids = {}
+        for pid in sorted({e.get('pid', 0) for e in events}):
+            if pid in used_pids:
+                pids[pid] = next_pid
+                next_pid += 1
+            else:
+                pids[pid] = pid
+            used_pids.add(pids[pid])
+        for e in events:
+            e['pid'] = pids[e.get('pid', 0)]
+            if e.get('ph') == 'X':
+                e['ts'] = round(e['ts'] + offsets[i], 3)
+                t = round(e.get('args', {}).get('time', -1), 9)
+                if t in cycle:
+                    e['args']['cycle'] = cycle[t]
+            merged.append(e)
+
+    doc = {'displayTimeUnit': 'ns', 'traceEvents': merged}
+    if args.output == '-':
+        json.dump(doc, sys.stdout)
+    else:
+        with open(args.output, 'w') as f:
+            json.dump(doc, f)
+
+
+if __name__ == '__main__':
+    main()
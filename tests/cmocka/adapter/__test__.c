@@ -0,0 +1,32 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <dse/testing.h>
+#include <dse/logger.h>
+
+
+extern uint8_t __log_level__; /* LOG_ERROR LOG_INFO LOG_DEBUG LOG_TRACE */
+
+
+extern int run_encoding_tests(void);
+extern int run_intern_tests(void);
+extern int run_prefetch_tests(void);
+extern int run_profile_tests(void);
+extern int run_realtime_tests(void);
+extern int run_tracelog_tests(void);
+
+
+int main()
+{
+    __log_level__ = LOG_QUIET;
+
+    int rc = 0;
+    rc |= run_encoding_tests();
+    rc |= run_intern_tests();
+    rc |= run_prefetch_tests();
+    rc |= run_profile_tests();
+    rc |= run_realtime_tests();
+    rc |= run_tracelog_tests();
+    return rc;
+}
@@ -0,0 +1,345 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <errno.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/modelc/adapter/adapter.h>
+#include <dse/modelc/adapter/encoding.h>
+#include <dse/modelc/adapter/intern.h>
+#include <dse/modelc/adapter/private.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof((x)) / sizeof((x)[0]))
+
+
+typedef struct EncodingMock {
+    Channel  channel;
+    Channel  peer; /* Decodes what channel encodes. */
+    SvBuffer buffer;
+} EncodingMock;
+
+
+static const char* __signals[] = { "one", "two", "three", "four" };
+
+
+static void _channel_init(Channel* channel)
+{
+    channel->name = "test";
+    hashmap_init(&channel->signal_values);
+    for (uint32_t i = 0; i < ARRAY_SIZE(__signals); i++) {
+        SignalValue* sv = _get_signal_value(channel, __signals[i]);
+        sv->uid = 1000 + i;
+    }
+    _refresh_index(channel);
+}
+
+
+static void _channel_destroy(Channel* channel)
+{
+    for (uint32_t i = 0; i < channel->index.count; i++) {
+        free(channel->index.map[i].signal->bin);
+    }
+    hashmap_destroy(&channel->signal_values);
+    _destroy_index(channel);
+    free(channel->forward.written);
+}
+
+
+static int test_setup(void** state)
+{
+    EncodingMock* mock = calloc(1, sizeof(EncodingMock));
+    assert_non_null(mock);
+
+    _channel_init(&mock->channel);
+    _channel_init(&mock->peer);
+
+    *state = mock;
+    return 0;
+}
+
+
+static int test_teardown(void** state)
+{
+    EncodingMock* mock = *state;
+
+    if (mock) {
+        _channel_destroy(&mock->channel);
+        _channel_destroy(&mock->peer);
+        sv_buffer_destroy(&mock->buffer);
+        free(mock);
+    }
+    intern_destroy();
+    return 0;
+}
+
+
+static uint32_t _encoded_uids(SvBuffer* buffer, uint32_t* uid, uint32_t size)
+{
+    SvV2Header h;
+    assert_true(sv_encoding_is_v2(buffer->data, buffer->length));
+    memcpy(&h, buffer->data, sizeof(h));
+    assert_true(h.scalar_count <= size);
+    memcpy(uid, buffer->data + sizeof(h), h.scalar_count * sizeof(uint32_t));
+    return h.scalar_count;
+}
+
+
+void test_encoding__deadband(void** state)
+{
+    EncodingMock* mock = *state;
+    Channel*      ch = &mock->channel;
+    SignalValue*  one = _get_signal_value(ch, "one");
+    SignalValue*  two = _get_signal_value(ch, "two");
+    uint32_t      uid[4];
+
+    /* Signal one: absolute deadband, signal two: relative deadband. */
+    one->deadband = 0.5;
+    two->deadband_relative = 0.1;
+    one->val = one->final_val = one->tx_val = 10.0;
+    two->val = two->final_val = two->tx_val = 100.0;
+
+    typedef struct {
+        double   one;
+        double   two;
+        uint32_t count;
+        uint32_t uid[2];
+    } TC;
+    TC tc[] = {
+        /* Changes within the deadband are not sent. */
+        { 10.4, 109.0, 0, {} },
+        { 9.6, 91.0, 0, {} },
+        /* Changes beyond the deadband are sent. */
+        { 10.6, 100.0, 1, { 1000 } },
+        { 10.6, 111.0, 1, { 1001 } },
+        /* Measured from the last sent value (10.6, 111.0). */
+        { 11.0, 120.0, 0, {} },
+        { 11.2, 90.0, 2, { 1000, 1001 } },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        log_trace("Index: %zu (%f, %f)", i, tc[i].one, tc[i].two);
+        one->final_val = tc[i].one;
+        two->final_val = tc[i].two;
+        assert_int_equal(sv_encode_v2(ch, &mock->buffer, false), 0);
+        uint32_t count = _encoded_uids(&mock->buffer, uid, ARRAY_SIZE(uid));
+        assert_int_equal(count, tc[i].count);
+        for (uint32_t j = 0; j < count; j++) {
+            assert_int_equal(uid[j], tc[i].uid[j]);
+        }
+        if (count == 0) {
+            /* The Model keeps its (unsent) value. */
+            assert_double_equal(one->val, one->final_val, 0.0);
+            assert_double_equal(two->val, two->final_val, 0.0);
+        }
+    }
+    assert_double_equal(one->tx_val, 11.2, 0.0);
+    assert_double_equal(two->tx_val, 90.0, 0.0);
+}
+
+
+void test_encoding__no_deadband(void** state)
+{
+    EncodingMock* mock = *state;
+    Channel*      ch = &mock->channel;
+    SignalValue*  three = _get_signal_value(ch, "three");
+    uint32_t      uid[4];
+
+    /* Without a deadband any change is sent. */
+    three->val = three->final_val = 1.0;
+    three->final_val = 1.000001;
+    assert_int_equal(sv_encode_v2(ch, &mock->buffer, false), 0);
+    assert_int_equal(_encoded_uids(&mock->buffer, uid, ARRAY_SIZE(uid)), 1);
+    assert_int_equal(uid[0], 1002);
+}
+
+
+void test_encoding__roundtrip_model(void** state)
+{
+    EncodingMock* mock = *state;
+    Channel*      ch = &mock->channel;
+    Channel*      bus = &mock->peer;
+    SignalValue*  one = _get_signal_value(ch, "one");
+    SignalValue*  three = _get_signal_value(ch, "three");
+    SignalValue*  four = _get_signal_value(ch, "four");
+
+    /* Model -> SimBus, changed scalars and a binary signal. */
+    one->final_val = 1.5;
+    three->final_val = -42.25;
+    _signal_value_bin_append(ch, four, "hello", 5);
+    assert_int_equal(sv_encode_v2(ch, &mock->buffer, false), 0);
+    assert_double_equal(one->tx_val, 1.5, 0.0);
+    assert_double_equal(three->tx_val, -42.25, 0.0);
+    assert_int_equal(four->bin_size, 0); /* Consumed by the encoder. */
+
+    assert_int_equal(
+        sv_decode_v2(bus, mock->buffer.data, mock->buffer.length, true), 0);
+    double expect[] = { 1.5, 0.0, -42.25, 0.0 };
+    for (uint32_t i = 0; i < ARRAY_SIZE(__signals); i++) {
+        SignalValue* sv = _get_signal_value(bus, __signals[i]);
+        assert_double_equal(sv->final_val, expect[i], 0.0);
+        assert_double_equal(sv->val, 0.0, 0.0); /* Resolved by the SimBus. */
+        assert_false(sv->changed);
+    }
+    SignalValue* bus_four = _get_signal_value(bus, "four");
+    assert_int_equal(bus_four->bin_size, 5);
+    assert_memory_equal(bus_four->bin, "hello", 5);
+
+    /* The written signals (in order of the encoding). */
+    assert_int_equal(bus->forward.written_count, 3);
+    assert_ptr_equal(bus->forward.written[0], _get_signal_value(bus, "one"));
+    assert_ptr_equal(bus->forward.written[1], _get_signal_value(bus, "three"));
+    assert_ptr_equal(bus->forward.written[2], bus_four);
+
+    /* Unchanged signals are not encoded. */
+    one->val = one->final_val;
+    three->val = three->final_val;
+    assert_int_equal(sv_encode_v2(ch, &mock->buffer, false), 0);
+    SvV2Header h;
+    memcpy(&h, mock->buffer.data, sizeof(h));
+    assert_int_equal(h.scalar_count, 0);
+    assert_int_equal(h.binary_count, 0);
+    assert_int_equal(mock->buffer.length, sizeof(SvV2Header));
+}
+
+
+void test_encoding__roundtrip_bus(void** state)
+{
+    EncodingMock* mock = *state;
+    Channel*      bus = &mock->channel;
+    Channel*      ch = &mock->peer;
+    SignalValue*  two = _get_signal_value(bus, "two");
+    SignalValue*  four = _get_signal_value(bus, "four");
+
+    /* SimBus -> Model. */
+    two->final_val = 3e10;
+    _signal_value_bin_append(bus, four, "world!", 6);
+    assert_int_equal(sv_encode_v2(bus, &mock->buffer, true), 0);
+    assert_int_equal(four->bin_size, 6); /* Not consumed (SimBus). */
+
+    assert_int_equal(
+        sv_decode_v2(ch, mock->buffer.data, mock->buffer.length, false), 0);
+    bool   changed[] = { false, true, false, true };
+    double expect[] = { 0.0, 3e10, 0.0, 0.0 };
+    for (uint32_t i = 0; i < ARRAY_SIZE(__signals); i++) {
+        SignalValue* sv = _get_signal_value(ch, __signals[i]);
+        assert_int_equal(sv->changed, changed[i]);
+        assert_double_equal(sv->val, expect[i], 0.0);
+        assert_double_equal(sv->final_val, expect[i], 0.0);
+        assert_double_equal(sv->tx_val, expect[i], 0.0);
+    }
+    SignalValue* ch_four = _get_signal_value(ch, "four");
+    assert_int_equal(ch_four->bin_size, 6);
+    assert_memory_equal(ch_four->bin, "world!", 6);
+    assert_int_equal(ch->forward.written_count, 0);
+}
+
+
+void test_encoding__decode_malformed(void** state)
+{
+    EncodingMock* mock = *state;
+    Channel*      ch = &mock->channel;
+    Channel*      peer = &mock->peer;
+
+    _get_signal_value(ch, "one")->final_val = 1.0;
+    _get_signal_value(ch, "two")->final_val = 2.0;
+    assert_int_equal(sv_encode_v2(ch, &mock->buffer, false), 0);
+    assert_true(sv_encoding_is_v2(mock->buffer.data, mock->buffer.length));
+
+    /* Truncated. */
+    errno = 0;
+    assert_int_equal(
+        sv_decode_v2(peer, mock->buffer.data, mock->buffer.length - 1, false),
+        -1);
+    assert_int_equal(errno, EBADMSG);
+    assert_false(sv_encoding_is_v2(mock->buffer.data, sizeof(SvV2Header) - 1));
+
+    /* V1 (MsgPack) encoding. */
+    uint8_t v1[] = { 0x92, 0x91, 0x01, 0x91, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0 };
+    assert_false(sv_encoding_is_v2(v1, sizeof(v1)));
+    errno = 0;
+    assert_int_equal(sv_decode_v2(peer, v1, sizeof(v1), false), -1);
+    assert_int_equal(errno, EBADMSG);
+
+    /* Unknown UIDs are skipped. */
+    uint32_t uid = 4242;
+    memcpy(mock->buffer.data + sizeof(SvV2Header), &uid, sizeof(uid));
+    assert_int_equal(
+        sv_decode_v2(peer, mock->buffer.data, mock->buffer.length, false), 0);
+    assert_false(_get_signal_value(peer, "one")->changed);
+    assert_true(_get_signal_value(peer, "two")->changed);
+    assert_double_equal(_get_signal_value(peer, "two")->val, 2.0, 0.0);
+}
+
+
+void test_encoding__roundtrip_batch(void** state)
+{
+    EncodingMock* mock = *state;
+    Channel*      ch = &mock->channel;
+    Channel*      bus = &mock->peer;
+    SignalValue*  one = _get_signal_value(ch, "one");
+    SvBuffer      batch = { 0 };
+
+    /* Each step produces a delta, queued in the batch. */
+    for (uint32_t i = 0; i < 3; i++) {
+        one->final_val = 10.0 + i;
+        assert_int_equal(sv_encode_v2(ch, &mock->buffer, false), 0);
+        assert_int_equal(sv_batch_append(&batch, 0.001 * (i + 1),
+                             mock->buffer.data, mock->buffer.length),
+            0);
+        one->val = one->final_val;
+    }
+    assert_true(sv_encoding_is_batch(batch.data, batch.length));
+    assert_false(sv_encoding_is_v2(batch.data, batch.length));
+    assert_int_equal(batch.length % 8, 0);
+
+    /* The deltas are returned in order (and decode in place). */
+    size_t         offset = 0;
+    double         model_time;
+    const uint8_t* delta;
+    uint32_t       delta_length;
+    for (uint32_t i = 0; i < 3; i++) {
+        assert_int_equal(sv_batch_next(batch.data, batch.length, &offset,
+                             &model_time, &delta, &delta_length),
+            1);
+        assert_double_equal(model_time, 0.001 * (i + 1), 0.0);
+        assert_true(sv_encoding_is_v2(delta, delta_length));
+        assert_int_equal(sv_decode_v2(bus, delta, delta_length, true), 0);
+        assert_double_equal(
+            _get_signal_value(bus, "one")->final_val, 10.0 + i, 0.0);
+    }
+    assert_int_equal(sv_batch_next(batch.data, batch.length, &offset,
+                         &model_time, &delta, &delta_length),
+        0);
+
+    /* Truncated batch. */
+    offset = 0;
+    errno = 0;
+    assert_int_equal(sv_batch_next(batch.data, sizeof(SvBatchHeader) + 4,
+                         &offset, &model_time, &delta, &delta_length),
+        -1);
+    assert_int_equal(errno, EBADMSG);
+    sv_buffer_destroy(&batch);
+}
+
+
+int run_encoding_tests(void)
+{
+    void* s = test_setup;
+    void* t = test_teardown;
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_encoding__deadband, s, t),
+        cmocka_unit_test_setup_teardown(test_encoding__no_deadband, s, t),
+        cmocka_unit_test_setup_teardown(test_encoding__roundtrip_model, s, t),
+        cmocka_unit_test_setup_teardown(test_encoding__roundtrip_bus, s, t),
+        cmocka_unit_test_setup_teardown(test_encoding__decode_malformed, s, t),
+        cmocka_unit_test_setup_teardown(test_encoding__roundtrip_batch, s, t),
+    };
+
+    return cmocka_run_group_tests_name("ENCODING", tests, NULL, NULL);
+}
@@ -0,0 +1,150 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <string.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/intern.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof((x)) / sizeof((x)[0]))
+
+
+static int test_teardown(void** state)
+{
+    UNUSED(state);
+
+    intern_destroy();
+    return 0;
+}
+
+
+void test_intern__intern_lookup(void** state)
+{
+    UNUSED(state);
+
+    const char* names[] = { "one", "two", "three", "" };
+    uint32_t    ids[ARRAY_SIZE(names)];
+
+    for (size_t i = 0; i < ARRAY_SIZE(names); i++) {
+        ids[i] = intern_id(names[i]);
+        assert_int_equal(ids[i], i + 1);
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(names); i++) {
+        const char* s = intern_lookup(ids[i]);
+        assert_non_null(s);
+        assert_string_equal(s, names[i]);
+        /* The table holds a copy. */
+        assert_ptr_not_equal(s, names[i]);
+        assert_ptr_equal(intern_str(names[i]), s);
+    }
+
+    /* NULL and unknown ids. */
+    assert_int_equal(intern_id(NULL), 0);
+    assert_null(intern_str(NULL));
+    assert_null(intern_lookup(0));
+    assert_null(intern_lookup(ARRAY_SIZE(names) + 1));
+}
+
+
+void test_intern__duplicates(void** state)
+{
+    UNUSED(state);
+
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%s", "signal");
+
+    uint32_t    id = intern_id("signal");
+    const char* s = intern_str("signal");
+    assert_int_equal(id, 1);
+    /* Same content (different pointer), same id and interned string. */
+    assert_int_equal(intern_id(buffer), id);
+    assert_ptr_equal(intern_str(buffer), s);
+    /* Similar strings are distinct. */
+    assert_int_not_equal(intern_id("signal2"), id);
+    assert_int_not_equal(intern_id("Signal"), id);
+
+    uint32_t count;
+    intern_stats(&count, NULL);
+    assert_int_equal(count, 3);
+}
+
+
+void test_intern__growth(void** state)
+{
+    UNUSED(state);
+
+    /* Beyond the initial table and arena chunk sizes. */
+    const uint32_t count = 5000;
+    const char*    str[5000];
+    char           name[64];
+    size_t         bytes_initial;
+
+    intern_id("first");
+    intern_stats(NULL, &bytes_initial);
+    str[0] = intern_str("first");
+    for (uint32_t i = 1; i < count; i++) {
+        snprintf(name, sizeof(name), "model.channel.signal_%u_%032u", i, i);
+        assert_int_equal(intern_id(name), i + 1);
+        str[i] = intern_str(name);
+    }
+
+    uint32_t _count;
+    size_t   bytes;
+    intern_stats(&_count, &bytes);
+    assert_int_equal(_count, count);
+    assert_true(bytes > bytes_initial);
+
+    /* Previously interned pointers remain valid, ids are stable. */
+    assert_string_equal(str[0], "first");
+    assert_int_equal(intern_id("first"), 1);
+    for (uint32_t i = 1; i < count; i++) {
+        snprintf(name, sizeof(name), "model.channel.signal_%u_%032u", i, i);
+        assert_ptr_equal(intern_lookup(i + 1), str[i]);
+        assert_string_equal(str[i], name);
+        assert_int_equal(intern_id(name), i + 1);
+    }
+    intern_stats(&_count, NULL);
+    assert_int_equal(_count, count);
+}
+
+
+void test_intern__destroy(void** state)
+{
+    UNUSED(state);
+
+    assert_int_equal(intern_id("one"), 1);
+    assert_int_equal(intern_id("two"), 2);
+
+    intern_destroy();
+    uint32_t count;
+    size_t   bytes;
+    intern_stats(&count, &bytes);
+    assert_int_equal(count, 0);
+    assert_int_equal(bytes, 0);
+    assert_null(intern_lookup(1));
+
+    /* The table can be used again, ids restart. */
+    assert_int_equal(intern_id("two"), 1);
+    assert_string_equal(intern_lookup(1), "two");
+    intern_destroy();
+    intern_destroy();
+}
+
+
+int run_intern_tests(void)
+{
+    void* t = test_teardown;
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_teardown(test_intern__intern_lookup, t),
+        cmocka_unit_test_teardown(test_intern__duplicates, t),
+        cmocka_unit_test_teardown(test_intern__growth, t),
+        cmocka_unit_test_teardown(test_intern__destroy, t),
+    };
+
+    return cmocka_run_group_tests_name("INTERN", tests, NULL, NULL);
+}
@@ -0,0 +1,330 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/transport/endpoint.h>
+#include <dse/modelc/adapter/transport/prefetch.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof((x)) / sizeof((x)[0]))
+
+#define MESSAGE_COUNT 200 /* More than PREFETCH_QUEUE_SLOTS. */
+#define MESSAGE_SIZE  16
+
+
+typedef struct PrefetchMock {
+    Endpoint endpoint;
+    /* Transport. */
+    uint32_t message_count;
+    uint32_t sent;
+    uint32_t no_message; /* Return "no message" before the next message. */
+    uint32_t recv_calls;
+    uint32_t interrupt_calls;
+    bool     disconnected;
+} PrefetchMock;
+
+
+static void _sleep_ms(long ms)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = ms * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+
+static int32_t mock_recv_fbs(Endpoint* endpoint, const char** channel_name,
+    uint8_t** buffer, uint32_t* buffer_length)
+{
+    PrefetchMock* mock = (PrefetchMock*)endpoint;
+
+    __atomic_add_fetch(&mock->recv_calls, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mock->no_message, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&mock->no_message, 1, __ATOMIC_SEQ_CST);
+        errno = ECANCELED;
+        return 0;
+    }
+    bool stop = __atomic_load_n(&endpoint->stop_request, __ATOMIC_SEQ_CST);
+    if (stop || mock->sent == mock->message_count) {
+        /* A (short) transport timeout. */
+        _sleep_ms(1);
+        errno = ETIME;
+        return -1;
+    }
+
+    if (*buffer_length < MESSAGE_SIZE) {
+        *buffer = realloc(*buffer, MESSAGE_SIZE);
+        *buffer_length = MESSAGE_SIZE;
+    }
+    memset(*buffer, 0, MESSAGE_SIZE);
+    memcpy(*buffer, &mock->sent, sizeof(uint32_t));
+    *channel_name = "test";
+    __atomic_add_fetch(&mock->sent, 1, __ATOMIC_SEQ_CST);
+    return MESSAGE_SIZE;
+}
+
+
+static void mock_interrupt(Endpoint* endpoint)
+{
+    PrefetchMock* mock = (PrefetchMock*)endpoint;
+
+    __atomic_store_n(&endpoint->stop_request, true, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&mock->interrupt_calls, 1, __ATOMIC_SEQ_CST);
+}
+
+
+static void mock_disconnect(Endpoint* endpoint)
+{
+    PrefetchMock* mock = (PrefetchMock*)endpoint;
+
+    mock->disconnected = true;
+}
+
+
+static int test_setup(void** state)
+{
+    PrefetchMock* mock = calloc(1, sizeof(PrefetchMock));
+    assert_non_null(mock);
+
+    mock->endpoint.recv_fbs = mock_recv_fbs;
+    mock->endpoint.interrupt = mock_interrupt;
+    mock->endpoint.disconnect = mock_disconnect;
+
+    *state = mock;
+    return 0;
+}
+
+
+static int test_teardown(void** state)
+{
+    PrefetchMock* mock = *state;
+
+    if (mock) {
+        endpoint_prefetch_stop(&mock->endpoint);
+        free(mock);
+    }
+    return 0;
+}
+
+
+void test_prefetch__recv(void** state)
+{
+    PrefetchMock* mock = *state;
+    Endpoint*     ep = &mock->endpoint;
+    uint8_t*      buffer = NULL;
+    uint32_t      buffer_length = 0;
+
+    mock->message_count = MESSAGE_COUNT;
+    assert_int_equal(
+        endpoint_prefetch_start(ep, TRANSPORT_REDISSTREAMS, 0.1), 0);
+    assert_non_null(ep->prefetch);
+    assert_ptr_not_equal(ep->recv_fbs, mock_recv_fbs);
+
+    /* Let the I/O thread fill the queue. */
+    _sleep_ms(20);
+    uint32_t sent = __atomic_load_n(&mock->sent, __ATOMIC_SEQ_CST);
+    assert_int_equal(sent, PREFETCH_QUEUE_SLOTS);
+
+    /* Messages are received in order, the buffers are swapped. */
+    for (uint32_t i = 0; i < MESSAGE_COUNT; i++) {
+        const char* channel_name = NULL;
+        uint8_t*    _buffer = buffer;
+        int32_t     length =
+            ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length);
+        assert_int_equal(length, MESSAGE_SIZE);
+        assert_string_equal(channel_name, "test");
+        assert_non_null(buffer);
+        if (i) assert_ptr_not_equal(buffer, _buffer);
+        uint32_t index;
+        memcpy(&index, buffer, sizeof(uint32_t));
+        assert_int_equal(index, i);
+    }
+
+    /* No further messages, the transport timeout is not returned. */
+    const char* channel_name = NULL;
+    errno = 0;
+    assert_int_equal(
+        ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length), -1);
+    assert_int_equal(errno, ETIME);
+
+    /* Stop, the transport functions are restored. */
+    endpoint_prefetch_stop(ep);
+    assert_null(ep->prefetch);
+    assert_ptr_equal(ep->recv_fbs, mock_recv_fbs);
+    assert_ptr_equal(ep->interrupt, mock_interrupt);
+    assert_ptr_equal(ep->disconnect, mock_disconnect);
+    assert_true(ep->stop_request);
+    assert_int_equal(mock->interrupt_calls, 1);
+    free(buffer);
+}
+
+
+void test_prefetch__interrupt(void** state)
+{
+    PrefetchMock* mock = *state;
+    Endpoint*     ep = &mock->endpoint;
+    uint8_t*      buffer = NULL;
+    uint32_t      buffer_length = 0;
+    const char*   channel_name = NULL;
+
+    assert_int_equal(endpoint_prefetch_start(ep, TRANSPORT_REDISSTREAMS, 5), 0);
+
+    /* The consumer is woken (well before the timeout). */
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ep->interrupt(ep);
+    errno = 0;
+    assert_int_equal(
+        ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length), 0);
+    assert_int_equal(errno, ECANCELED);
+    assert_null(channel_name);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    assert_true(end.tv_sec - start.tv_sec < 1);
+    assert_true(ep->stop_request);
+    assert_int_equal(mock->interrupt_calls, 1);
+
+    /* Disconnect stops the I/O thread. */
+    ep->disconnect(ep);
+    assert_null(ep->prefetch);
+    assert_true(mock->disconnected);
+    free(buffer);
+}
+
+
+void test_prefetch__interrupt_thread(void** state)
+{
+    PrefetchMock* mock = *state;
+    Endpoint*     ep = &mock->endpoint;
+    uint8_t*      buffer = NULL;
+    uint32_t      buffer_length = 0;
+    const char*   channel_name = NULL;
+
+    /* The redispubsub interrupt is not called from the other threads, the
+       stop request is observed by the transport (at its timeout). */
+    assert_int_equal(endpoint_prefetch_start(ep, TRANSPORT_REDISPUBSUB, 5), 0);
+    ep->interrupt(ep);
+    assert_int_equal(
+        ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length), 0);
+    assert_true(ep->stop_request);
+    endpoint_prefetch_stop(ep);
+    assert_int_equal(mock->interrupt_calls, 0);
+    free(buffer);
+}
+
+
+void test_prefetch__no_message(void** state)
+{
+    PrefetchMock* mock = *state;
+    Endpoint*     ep = &mock->endpoint;
+    uint8_t*      buffer = NULL;
+    uint32_t      buffer_length = 0;
+    const char*   channel_name = NULL;
+
+    /* The transport returns no message, then a message. */
+    mock->no_message = 1;
+    mock->message_count = 1;
+    assert_int_equal(endpoint_prefetch_start(ep, TRANSPORT_MQ, 5), 0);
+    _sleep_ms(20);
+
+    /* The I/O thread waits for the consumer (it does not retry). */
+    uint32_t calls = __atomic_load_n(&mock->recv_calls, __ATOMIC_SEQ_CST);
+    assert_int_equal(calls, 1);
+    assert_int_equal(mock->sent, 0);
+
+    /* The consumer receives the message (after the I/O thread resumed). */
+    int32_t length = 0;
+    for (int i = 0; i < 3 && length == 0; i++) {
+        length = ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length);
+    }
+    assert_int_equal(length, MESSAGE_SIZE);
+    assert_string_equal(channel_name, "test");
+    assert_int_equal(mock->sent, 1);
+
+    /* The consumer waits while the transport returns no message. */
+    endpoint_prefetch_stop(ep);
+    mock->no_message = 1;
+    mock->message_count = 2;
+    ep->stop_request = false;
+    assert_int_equal(endpoint_prefetch_start(ep, TRANSPORT_MQ, 5), 0);
+    errno = 0;
+    length = ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length);
+    if (length == 0) {
+        /* The no message result was returned to the consumer. */
+        assert_int_equal(errno, ECANCELED);
+        length = ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length);
+    }
+    assert_int_equal(length, MESSAGE_SIZE);
+    assert_int_equal(mock->sent, 2);
+    free(buffer);
+}
+
+
+void test_prefetch__recv_bound(void** state)
+{
+    PrefetchMock* mock = *state;
+    Endpoint*     ep = &mock->endpoint;
+    uint8_t*      buffer = NULL;
+    uint32_t      buffer_length = 0;
+    const char*   channel_name = NULL;
+
+    /* No messages, the receive is bounded (well before the timeout). */
+    assert_int_equal(endpoint_prefetch_start(ep, TRANSPORT_REDISSTREAMS, 5), 0);
+    __atomic_store_n(&ep->recv_bound_ms, 20, __ATOMIC_RELAXED);
+    assert_true(endpoint_recv_timeout(ep, 5) < 0.021);
+    assert_true(endpoint_recv_timeout(ep, 0.01) < 0.011);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    errno = 0;
+    assert_int_equal(
+        ep->recv_fbs(ep, &channel_name, &buffer, &buffer_length), -1);
+    assert_int_equal(errno, ETIME);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    assert_true(end.tv_sec - start.tv_sec < 1);
+
+    /* Without a bound, the transport timeout applies. */
+    __atomic_store_n(&ep->recv_bound_ms, 0, __ATOMIC_RELAXED);
+    assert_true(endpoint_recv_timeout(ep, 5) > 4.9);
+    endpoint_prefetch_stop(ep);
+    free(buffer);
+}
+
+
+void test_prefetch__not_supported(void** state)
+{
+    PrefetchMock* mock = *state;
+    Endpoint*     ep = &mock->endpoint;
+
+    errno = 0;
+    assert_int_equal(endpoint_prefetch_start(ep, TRANSPORT_REDIS, 1), -1);
+    assert_int_equal(errno, ENOTSUP);
+    assert_null(ep->prefetch);
+    assert_ptr_equal(ep->recv_fbs, mock_recv_fbs);
+
+    errno = 0;
+    assert_int_equal(endpoint_prefetch_start(NULL, TRANSPORT_MQ, 1), -1);
+    assert_int_equal(errno, EINVAL);
+}
+
+
+int run_prefetch_tests(void)
+{
+    void* s = test_setup;
+    void* t = test_teardown;
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_prefetch__recv, s, t),
+        cmocka_unit_test_setup_teardown(test_prefetch__interrupt, s, t),
+        cmocka_unit_test_setup_teardown(test_prefetch__interrupt_thread, s, t),
+        cmocka_unit_test_setup_teardown(test_prefetch__no_message, s, t),
+        cmocka_unit_test_setup_teardown(test_prefetch__recv_bound, s, t),
+        cmocka_unit_test_setup_teardown(test_prefetch__not_supported, s, t),
+    };
+
+    return cmocka_run_group_tests_name("PREFETCH", tests, NULL, NULL);
+}
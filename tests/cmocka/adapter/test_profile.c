@@ -0,0 +1,100 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof((x)) / sizeof((x)[0]))
+
+
+/* profile.c (simbus_private.h requires the flatbuffer schemas). */
+extern void simbus_profile_init(double bus_step_size);
+extern void simbus_profile_accumulate_model_part(uint32_t model_uid,
+    uint64_t me, uint64_t mp, uint64_t net, struct timespec ref_ts);
+extern void simbus_profile_accumulate_cycle_total(
+    uint64_t simbus_cycle_total_ns, struct timespec ref_ts);
+extern void simbus_profile_dump_critical_path(FILE* file);
+extern void simbus_profile_destroy(void);
+
+
+static int test_setup(void** state)
+{
+    UNUSED(state);
+
+    simbus_profile_init(0.0005);
+    return 0;
+}
+
+
+static int test_teardown(void** state)
+{
+    UNUSED(state);
+
+    simbus_profile_destroy();
+    return 0;
+}
+
+
+static struct timespec _ts_us(uint32_t us)
+{
+    return (struct timespec){ .tv_sec = 1, .tv_nsec = us * 1000 };
+}
+
+
+void test_profile__critical_path(void** state)
+{
+    UNUSED(state);
+
+    /* Arrival of each Model (us) per cycle, Models 2 and 3 share a Notify
+       (same arrival time). */
+    uint32_t arrival[][3] = {
+        { 100, 300, 300 }, /* Group (2, 3) last, gap 200 us. */
+        { 500, 100, 100 }, /* Model 1 last, gap 400 us. */
+        { 200, 200, 200 }, /* All in one Notify, no gap. */
+    };
+    for (size_t c = 0; c < ARRAY_SIZE(arrival); c++) {
+        for (uint32_t i = 0; i < 3; i++) {
+            simbus_profile_accumulate_model_part(
+                i + 1, 0, 0, 0, _ts_us(arrival[c][i]));
+        }
+        simbus_profile_accumulate_cycle_total(0, _ts_us(1000));
+    }
+
+    char*  buffer = NULL;
+    size_t size = 0;
+    FILE*  file = open_memstream(&buffer, &size);
+    assert_non_null(file);
+    simbus_profile_dump_critical_path(file);
+    fclose(file);
+    assert_non_null(buffer);
+
+    /* CP(%), Gap(us) and Slack(us):cycles of each Model. */
+    assert_non_null(strstr(buffer, " Critical Path: (cycles=3)\n"));
+    assert_non_null(
+        strstr(buffer, "  1          66.67   200.0      <1:2 <256:1\n"));
+    assert_non_null(
+        strstr(buffer, "  2          66.67   100.0      <1:2 <512:1\n"));
+    assert_non_null(
+        strstr(buffer, "  3          66.67   100.0      <1:2 <512:1\n"));
+    free(buffer);
+}
+
+
+int run_profile_tests(void)
+{
+    void* s = test_setup;
+    void* t = test_teardown;
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_profile__critical_path, s, t),
+    };
+
+    return cmocka_run_group_tests_name("PROFILE", tests, NULL, NULL);
+}
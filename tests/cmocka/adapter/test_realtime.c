@@ -0,0 +1,117 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/realtime.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof((x)) / sizeof((x)[0]))
+
+
+void test_realtime__disabled(void** state)
+{
+    UNUSED(state);
+
+    assert_int_equal(realtime_configure(NULL), 0);
+    assert_false(realtime_profile()->enabled);
+    assert_int_equal(realtime_configure(""), 0);
+    assert_false(realtime_profile()->enabled);
+    assert_int_equal(realtime_configure("off"), 0);
+    assert_false(realtime_profile()->enabled);
+    assert_int_equal(realtime_profile()->cpu, -1);
+    assert_int_equal(realtime_profile()->priority, 0);
+}
+
+
+void test_realtime__valid(void** state)
+{
+    UNUSED(state);
+
+    typedef struct {
+        const char* spec;
+        int32_t     cpu;
+        int32_t     priority;
+        int32_t     policy;
+        bool        mlock;
+        bool        hugepages;
+        size_t      arena_mb;
+    } TC;
+    TC tc[] = {
+        { "cpu=2,priority=80,mlock", 2, 80, REALTIME_POLICY_FIFO, true, false,
+            REALTIME_ARENA_DEFAULT_MB },
+        { "cpu=0", 0, 0, REALTIME_POLICY_FIFO, false, false,
+            REALTIME_ARENA_DEFAULT_MB },
+        { "cpu=1023,priority=1,policy=rr", 1023, 1, REALTIME_POLICY_RR, false,
+            false, REALTIME_ARENA_DEFAULT_MB },
+        { "priority=99,policy=fifo", -1, 99, REALTIME_POLICY_FIFO, false,
+            false, REALTIME_ARENA_DEFAULT_MB },
+        { "hugepages,arena=16", -1, 0, REALTIME_POLICY_FIFO, false, true, 16 },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        assert_int_equal(realtime_configure(tc[i].spec), 0);
+        RealtimeProfile* rt = realtime_profile();
+        assert_true(rt->enabled);
+        assert_int_equal(rt->cpu, tc[i].cpu);
+        assert_int_equal(rt->priority, tc[i].priority);
+        assert_int_equal(rt->policy, tc[i].policy);
+        assert_int_equal(rt->mlock, tc[i].mlock);
+        assert_int_equal(rt->hugepages, tc[i].hugepages);
+        assert_int_equal(rt->arena_size, tc[i].arena_mb * 1024 * 1024);
+    }
+}
+
+
+void test_realtime__invalid(void** state)
+{
+    UNUSED(state);
+
+    const char* cpu[] = { "cpu", "cpu=", "cpu=-1", "cpu=1024", "cpu=two",
+        "cpu=2x" };
+    for (size_t i = 0; i < ARRAY_SIZE(cpu); i++) {
+        assert_int_equal(realtime_configure(cpu[i]), -EINVAL);
+        assert_int_equal(realtime_profile()->cpu, -1);
+    }
+
+    const char* priority[] = { "priority", "priority=0", "priority=100",
+        "priority=-5", "priority=high" };
+    for (size_t i = 0; i < ARRAY_SIZE(priority); i++) {
+        assert_int_equal(realtime_configure(priority[i]), -EINVAL);
+        assert_int_equal(realtime_profile()->priority, 0);
+    }
+
+    const char* policy[] = { "policy", "policy=", "policy=batch",
+        "policy=FIFO", "policy=other" };
+    for (size_t i = 0; i < ARRAY_SIZE(policy); i++) {
+        assert_int_equal(realtime_configure(policy[i]), -EINVAL);
+        assert_int_equal(realtime_profile()->policy, REALTIME_POLICY_FIFO);
+    }
+
+    /* Valid options are configured, invalid options are not. */
+    assert_int_equal(
+        realtime_configure("cpu=3,priority=200,policy=rr,foo"), -EINVAL);
+    RealtimeProfile* rt = realtime_profile();
+    assert_int_equal(rt->cpu, 3);
+    assert_int_equal(rt->priority, 0);
+    assert_int_equal(rt->policy, REALTIME_POLICY_RR);
+
+    assert_int_equal(realtime_configure("arena=0"), -EINVAL);
+    assert_int_equal(realtime_profile()->arena_size,
+        REALTIME_ARENA_DEFAULT_MB * 1024 * 1024);
+}
+
+
+int run_realtime_tests(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_realtime__disabled),
+        cmocka_unit_test(test_realtime__valid),
+        cmocka_unit_test(test_realtime__invalid),
+    };
+
+    return cmocka_run_group_tests_name("REALTIME", tests, NULL, NULL);
+}
@@ -0,0 +1,81 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/modelc/adapter/tracelog.h>
+
+
+#define UNUSED(x)        ((void)x)
+#define TRACEFILE        "/tmp/test_tracelog.trace"
+#define PRODUCER_COUNT   4
+#define PRODUCER_SIGNALS 1000
+
+
+static void* _producer(void* arg)
+{
+    uint32_t uid = (uint32_t)(uintptr_t)arg;
+    for (uint32_t i = 0; i < PRODUCER_SIGNALS; i++) {
+        tracelog_signal(TRACELOG_FMT_SIGNAL_VALUE, uid, 0, i, 0, "signal");
+    }
+    return NULL;
+}
+
+
+void test_tracelog__producers(void** state)
+{
+    UNUSED(state);
+
+    /* Two Adapters (bus and model) open the trace log. */
+    assert_int_equal(tracelog_open(TRACEFILE, TRACELOG_ALL), 0);
+    assert_int_equal(tracelog_open(TRACEFILE, TRACELOG_ALL), 0);
+    assert_true(tracelog_enabled(TRACELOG_SIGNAL));
+
+    pthread_t thread[PRODUCER_COUNT];
+    for (uintptr_t i = 0; i < PRODUCER_COUNT; i++) {
+        pthread_create(&thread[i], NULL, _producer, (void*)(i + 1));
+    }
+    for (uint32_t i = 0; i < PRODUCER_COUNT; i++) {
+        pthread_join(thread[i], NULL);
+    }
+
+    /* The first close keeps the trace log running. */
+    tracelog_close();
+    assert_true(tracelog_enabled(TRACELOG_SIGNAL));
+    tracelog_close();
+    assert_false(tracelog_enabled(TRACELOG_SIGNAL));
+
+    /* The trace file has the process id as suffix. */
+    char path[100];
+    snprintf(path, sizeof(path), "%s.%d", TRACEFILE, (int)getpid());
+    FILE* file = fopen(path, "r");
+    assert_non_null(file);
+    uint32_t count[PRODUCER_COUNT + 1] = { 0 };
+    char     line[200];
+    while (fgets(line, sizeof(line), file)) {
+        unsigned int uid;
+        if (sscanf(line, " SignalValue: %u", &uid) != 1) continue;
+        if (uid <= PRODUCER_COUNT) count[uid]++;
+    }
+    fclose(file);
+    remove(path);
+    for (uint32_t i = 1; i <= PRODUCER_COUNT; i++) {
+        assert_int_equal(count[i], PRODUCER_SIGNALS);
+    }
+}
+
+
+int run_tracelog_tests(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_tracelog__producers),
+    };
+
+    return cmocka_run_group_tests_name("TRACELOG", tests, NULL, NULL);
+}
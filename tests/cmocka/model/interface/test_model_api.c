@@ -4,14 +4,19 @@
 
 #include <unistd.h>
 #include <stdbool.h>
+#include <dlfcn.h>
 #include <linux/limits.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
+#include <dse/modelc/adapter/memstat.h>
+#include <dse/modelc/controller/model_private.h>
 #include <dse/mocks/simmock.h>
 
 
 extern ModelSignalIndex __model_index__(
     ModelDesc* m, const char* vname, const char* sname);
+void stub_setup_objects(Controller* c, Endpoint* e);
+void stub_release_objects(Controller* c, Endpoint* e);
 
 static char __entry_path__[PATH_MAX];
 
@@ -235,6 +240,85 @@ void test_model_api__binary_stream_reset(void** state)
 }
 
 
+#define MINIMAL_SIGNAL_COUNTER  0
+#define MINIMAL_SIGNAL_RELOADED 1
+
+void test_model_api__model_reload(void** state)
+{
+    chdir("../../../../dse/modelc/build/_out/examples/minimal");
+
+    const char* inst_names[] = {
+        MINIMAL_INST_NAME,
+    };
+    char* argv[] = {
+        (char*)"test_model_api",
+        (char*)"--name=" MINIMAL_INST_NAME,
+        (char*)"--logger=5",  // 1=debug, 5=QUIET (commit with 5!)
+        (char*)"data/simulation.yaml",
+        (char*)"data/model.yaml",
+    };
+    SimMock* mock = *state = simmock_alloc(inst_names, ARRAY_SIZE(inst_names));
+    simmock_configure(mock, argv, ARRAY_SIZE(argv), ARRAY_SIZE(inst_names));
+    ModelMock* model = simmock_find_model(mock, MINIMAL_INST_NAME);
+    simmock_load(mock);
+    simmock_load_model_check(model, false, true, false);
+    simmock_setup(mock, "data_channel", NULL);
+    for (uint32_t i = 0; i < 3; i++) {
+        assert_int_equal(simmock_step(mock, true), 0);
+    }
+    SignalVector* sv = model->mi->model_desc->sv;
+    assert_int_equal(sv->count, 1);
+    double counter = sv->scalar[MINIMAL_SIGNAL_COUNTER];
+    assert_true(counter > 0.0);
+
+    /* A Controller with a compiled marshal plan. */
+    Controller controller = {
+        .marshal_plan = memstat_malloc(MEMSTAT_CONTROLLER, sizeof(MarshalItem)),
+        .marshal_plan_count = 1,
+    };
+    stub_setup_objects(&controller, NULL);
+
+    /* Change the signal set (an additional SignalGroup), then reload. */
+    mock->doc_list = model->mi->yaml_doc_list = dse_yaml_load_file(
+        "../../../../../../tests/cmocka/build/_out/resources/model/reload.yaml",
+        model->mi->yaml_doc_list);
+    ModelInstancePrivate* mip = model->mi->private;
+    ControllerModel*      cm = mip->controller_model;
+    cm->handle = dlopen(
+        model->mi->model_definition.full_path, RTLD_NOW | RTLD_LOCAL);
+    assert_non_null(cm->handle);
+    assert_int_equal(controller_reload_models(&mock->sim), 0);
+
+    /* The marshal plan is compiled again (by the next step). */
+    assert_null(controller.marshal_plan);
+    assert_int_equal(controller.marshal_plan_count, 0);
+
+    /* The channel has the changed signal set, values are retained. */
+    sv = model->mi->model_desc->sv;
+    assert_non_null(sv);
+    assert_int_equal(sv->count, 2);
+    assert_string_equal(sv->signal[MINIMAL_SIGNAL_COUNTER], "counter");
+    assert_string_equal(sv->signal[MINIMAL_SIGNAL_RELOADED], "reloaded");
+    assert_double_equal(sv->scalar[MINIMAL_SIGNAL_COUNTER], counter, 0.0);
+    assert_double_equal(sv->scalar[MINIMAL_SIGNAL_RELOADED], 0.0, 0.0);
+    ModelFunction* mf =
+        controller_get_model_function(model->mi, sv->function_name);
+    ModelFunctionChannel* mfc = hashmap_get(&mf->channels, sv->name);
+    assert_non_null(mfc);
+    assert_int_equal(mfc->signal_count, 2);
+    assert_null(mfc->signal_map);
+
+    /* Reload without a change, the signal storage is kept. */
+    double* storage = mfc->signal_value_double;
+    assert_non_null(cm->handle);
+    assert_int_equal(controller_reload_models(&mock->sim), 0);
+    assert_ptr_equal(mfc->signal_value_double, storage);
+    assert_int_equal(model->mi->model_desc->sv->count, 2);
+
+    stub_release_objects(&controller, NULL);
+}
+
+
 int run_model_api_tests(void)
 {
     void* s = test_setup;
@@ -246,6 +330,7 @@ int run_model_api_tests(void)
         cmocka_unit_test_setup_teardown(test_model_api__model_index, s, t),
         cmocka_unit_test_setup_teardown(test_model_api__model_annotation, s, t),
         cmocka_unit_test_setup_teardown(test_model_api__binary_stream_reset, s, t),
+        cmocka_unit_test_setup_teardown(test_model_api__model_reload, s, t),
     };
 
     return cmocka_run_group_tests_name("MODEL / API", tests, NULL, NULL);
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <string.h>
+#include <errno.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/util/yaml.h>
@@ -369,6 +370,105 @@ void test_ncodec__call_sequence(void** state)
 }
 
 
+void test_ncodec__frame_read(void** state)
+{
+    ModelCMock* mock = *state;
+    int         rc;
+
+    /* Use the "binary" signal vector. */
+    SignalVector* sv_save = mock->mi->model_desc->sv;
+    assert_int_equal(_sv_count(sv_save), 1);
+    SignalVector* sv = sv_save;
+    while (sv && sv->name) {
+        if (strcmp(sv->name, "binary") == 0) break;
+        /* Next signal vector. */
+        sv++;
+    }
+    NCODEC* nc = sv->codec(sv, 2);
+    assert_non_null(nc);
+
+    /* Write frames (spoof node_id). */
+    const char* payload[] = { "one", "two", "three", "four" };
+    uint32_t    frame_id[] = { 43, 42, 44, 42 };
+    _adjust_node_id(nc, "42");
+    ncodec_truncate(nc);
+    for (uint32_t i = 0; i < ARRAY_SIZE(payload); i++) {
+        ncodec_write(nc, &(struct NCodecCanMessage){ .frame_id = frame_id[i],
+                             .buffer = (uint8_t*)payload[i],
+                             .len = strlen(payload[i]) });
+    }
+    ncodec_flush(nc);
+    _adjust_node_id(nc, "2");
+    ncodec_seek(nc, 0, NCODEC_SEEK_SET);
+
+    /* Select frames. */
+    const NCodecCanMessage* frames = NULL;
+    uint32_t                count = 0;
+    uint32_t                select[] = { 42, 99, 44 };
+    rc = signal_frame_read(sv, 2, select, ARRAY_SIZE(select), &frames, &count);
+    assert_int_equal(rc, 0);
+    assert_int_equal(count, 3);
+    assert_non_null(frames);
+    assert_int_equal(frames[0].frame_id, 42);
+    assert_memory_equal(frames[0].buffer, "two", 3);
+    assert_int_equal(frames[1].frame_id, 42);
+    assert_memory_equal(frames[1].buffer, "four", 4);
+    assert_int_equal(frames[2].frame_id, 44);
+    assert_memory_equal(frames[2].buffer, "three", 5);
+
+    /* Second lookup uses the same index. */
+    rc = signal_frame_read(sv, 2, NULL, 0, &frames, &count);
+    assert_int_equal(rc, 0);
+    assert_int_equal(count, 4);
+    assert_int_equal(frames[0].frame_id, 42);
+    assert_int_equal(frames[3].frame_id, 44);
+    uint32_t none[] = { 99 };
+    rc = signal_frame_read(sv, 2, none, ARRAY_SIZE(none), &frames, &count);
+    assert_int_equal(rc, 0);
+    assert_int_equal(count, 0);
+    assert_null(frames);
+
+    /* Reset invalidates the index. */
+    sv->reset(sv, 2);
+    rc = signal_frame_read(sv, 2, NULL, 0, &frames, &count);
+    assert_int_equal(rc, 0);
+    assert_int_equal(count, 0);
+
+    /* Write, then read (the stream position is at the end of the stream). */
+    _adjust_node_id(nc, "42");
+    ncodec_truncate(nc);
+    for (uint32_t i = 0; i < ARRAY_SIZE(payload); i++) {
+        ncodec_write(nc, &(struct NCodecCanMessage){ .frame_id = frame_id[i],
+                             .buffer = (uint8_t*)payload[i],
+                             .len = strlen(payload[i]) });
+    }
+    ncodec_flush(nc);
+    _adjust_node_id(nc, "2");
+    int64_t pos = ncodec_tell(nc);
+    assert_true(pos > 0);
+    rc = signal_frame_read(sv, 2, select, ARRAY_SIZE(select), &frames, &count);
+    assert_int_equal(rc, 0);
+    assert_int_equal(count, 3);
+    assert_memory_equal(frames[0].buffer, "two", 3);
+    assert_memory_equal(frames[1].buffer, "four", 4);
+    assert_memory_equal(frames[2].buffer, "three", 5);
+    /* The stream position is not changed. */
+    assert_int_equal(ncodec_tell(nc), pos);
+    ncodec_seek(nc, 0, NCODEC_SEEK_SET);
+    NCodecCanMessage msg = {};
+    assert_true(ncodec_read(nc, &msg) > 0);
+    assert_int_equal(msg.frame_id, 43);
+
+    /* Bad arguments. */
+    assert_int_equal(signal_frame_read(NULL, 2, NULL, 0, &frames, &count),
+        -EINVAL);
+    assert_int_equal(signal_frame_read(sv, 2, NULL, 1, &frames, &count),
+        -EINVAL);
+    assert_int_equal(signal_frame_read(sv, 0, NULL, 0, &frames, &count),
+        -ENOSTR);
+}
+
+
 int run_ncodec_tests(void)
 {
     void* s = test_setup;
@@ -381,6 +481,7 @@ int run_ncodec_tests(void)
         cmocka_unit_test_setup_teardown(test_ncodec__truncate, s, t),
         cmocka_unit_test_setup_teardown(test_ncodec__config, s, t),
         cmocka_unit_test_setup_teardown(test_ncodec__call_sequence, s, t),
+        cmocka_unit_test_setup_teardown(test_ncodec__frame_read, s, t),
     };
 
     return cmocka_run_group_tests_name("NCODEC", tests, NULL, NULL);
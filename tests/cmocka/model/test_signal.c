@@ -3,9 +3,11 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <string.h>
+#include <errno.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/util/yaml.h>
+#include <dse/modelc/controller/controller.h>
 #include <dse/modelc/model.h>
 #include <dse/modelc/runtime.h>
 
@@ -337,6 +339,50 @@ void test_signal__binary_echo(void** state)
 }
 
 
+void test_signal__changed(void** state)
+{
+    /* The changed index list is set by the controller (marshal from the
+     * Adapter), see test_transform__marshal_changed(). This test covers the
+     * Model API aspects.
+     */
+    ModelCMock* mock = *state;
+
+    SignalVector* sv = mock->mi->model_desc->sv;
+    while (sv && sv->name) {
+        if (strcmp(sv->name, "scalar") == 0) break;
+        /* Next signal vector. */
+        sv++;
+    }
+    assert_string_equal(sv->name, "scalar");
+    ModelFunction* mf = controller_get_model_function(mock->mi, "model_step");
+    assert_non_null(mf);
+    ModelFunctionChannel* mfc = hashmap_get(&mf->channels, "scalar");
+    assert_non_null(mfc);
+    assert_non_null(mfc->signal_changed);
+
+    /* Initial conditions. */
+    const uint32_t* index = (const uint32_t*)sv;
+    uint32_t        count = 42;
+    assert_int_equal(signal_changed(sv, &index, &count), 0);
+    assert_null(index);
+    assert_int_equal(count, 0);
+
+    /* Changed signal (as set by the controller). */
+    mfc->signal_changed[0] = 1;
+    mfc->signal_changed_count = 1;
+    assert_int_equal(signal_changed(sv, &index, &count), 0);
+    assert_non_null(index);
+    assert_int_equal(count, 1);
+    assert_int_equal(index[0], 1);
+    assert_string_equal(sv->signal[index[0]], "scalar_bar");
+
+    /* Bad arguments. */
+    assert_int_equal(signal_changed(NULL, &index, &count), -EINVAL);
+    assert_int_equal(signal_changed(sv, NULL, &count), -EINVAL);
+    assert_int_equal(signal_changed(sv, &index, NULL), -EINVAL);
+}
+
+
 int run_signal_tests(void)
 {
     void* s = test_setup;
@@ -348,6 +394,7 @@ int run_signal_tests(void)
         cmocka_unit_test_setup_teardown(test_signal__annotations, s, t),
         cmocka_unit_test_setup_teardown(test_signal__group_annotations, s, t),
         cmocka_unit_test_setup_teardown(test_signal__binary_echo, s, t),
+        cmocka_unit_test_setup_teardown(test_signal__changed, s, t),
     };
 
     return cmocka_run_group_tests_name("SIGNAL", tests, NULL, NULL);
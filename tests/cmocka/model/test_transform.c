@@ -150,6 +150,7 @@ void test_transform__parse_no_transform(void** state)
     ModelFunctionChannel* mfc = hashmap_get(&mf->channels, "scalar");
     assert_non_null(mfc);
     assert_null(mfc->signal_transform);
+    assert_null(mfc->signal_deadband);
 }
 
 
@@ -199,6 +200,104 @@ void test_transform__parse(void** state)
 }
 
 
+void test_transform__parse_deadband(void** state)
+{
+    ModelCMock* mock = *state;
+
+    /* Deadband table (internal variable). */
+    ModelFunction* mf = controller_get_model_function(mock->mi, "model_step");
+    assert_non_null(mf);
+    ModelFunctionChannel* mfc = hashmap_get(&mf->channels, "scalar");
+    assert_non_null(mfc);
+    assert_int_equal(mfc->signal_count, 5);
+    assert_non_null(mfc->signal_deadband);
+
+    /* Check the deadband table. */
+    double tc[][2] = {
+        { 0.5, 0.0 },
+        { 0.0, 0.0 },  // No deadband.
+        { 0.0, 0.01 },
+        { 0.0, 0.0 },
+        { 0.0, 0.0 },
+    };
+    SignalDeadband* sd = mfc->signal_deadband;
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        log_trace("Index: %d (%f, %f)", i, tc[i][0], tc[i][1]);
+        assert_double_equal(sd[i].absolute, tc[i][0], 0.0);
+        assert_double_equal(sd[i].relative, tc[i][1], 0.0);
+    }
+}
+
+
+void test_transform__marshal_changed(void** state)
+{
+    ModelCMock* mock = *state;
+
+    SignalVector* sv = mock->mi->model_desc->sv;
+    assert_string_equal(sv->name, "scalar");
+    assert_int_equal(sv->count, 5);
+    ModelFunction* mf = controller_get_model_function(mock->mi, "model_step");
+    assert_non_null(mf);
+    ModelFunctionChannel* mfc = hashmap_get(&mf->channels, "scalar");
+    assert_non_null(mfc);
+
+    /* Signals (as marshalled from the Adapter), the channel index has the
+       reverse order of the signal map. */
+    SignalValue signal[5] = { 0 };
+    SignalMap   sm[5];
+    SignalMap   index_map[5];
+    for (uint32_t i = 0; i < ARRAY_SIZE(sm); i++) {
+        sm[i] = (SignalMap){ .name = sv->signal[i], .signal = &signal[i] };
+        signal[i].index = ARRAY_SIZE(sm) - 1 - i;
+        index_map[signal[i].index] = sm[i];
+    }
+    SignalValue* changed[5];
+    Channel      ch = { .name = "scalar" };
+    ch.index.map = index_map;
+    ch.index.count = ARRAY_SIZE(index_map);
+    ch.index.valid = true;
+    ch.changed.signal = changed;
+    ch.changed.capacity = ARRAY_SIZE(changed);
+
+    typedef struct {
+        bool     changed[5];
+        uint32_t count;
+        uint32_t index[5];
+    } TC;
+    TC tc[] = {
+        { { false, true, false, true, true }, 3, { 1, 3, 4 } },
+        { { true, false, false, false, false }, 1, { 0 } },
+        { { false, false, false, false, false }, 0, {} },
+        { { true, true, true, true, true }, 5, { 0, 1, 2, 3, 4 } },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc) * 2; i++) {
+        /* The changed list (reverse order of reception), then the overflow
+           condition (all signals are evaluated). */
+        TC* t = &tc[i % ARRAY_SIZE(tc)];
+        log_trace("Index: %zu (count=%u)", i, t->count);
+        ch.changed.count = 0;
+        ch.changed.overflow = (i >= ARRAY_SIZE(tc));
+        for (uint32_t si = ARRAY_SIZE(signal); si-- > 0;) {
+            signal[si].changed = t->changed[si];
+            if (t->changed[si] && !ch.changed.overflow) {
+                changed[ch.changed.count++] = &signal[si];
+            }
+        }
+        controller_changed_to_model(mfc, sm, &ch);
+
+        /* Exactly the changed signals, in ascending order. */
+        const uint32_t* index = NULL;
+        uint32_t        count = 42;
+        assert_int_equal(signal_changed(sv, &index, &count), 0);
+        assert_int_equal(count, t->count);
+        if (count == 0) assert_null(index);
+        for (uint32_t j = 0; j < count; j++) {
+            assert_int_equal(index[j], t->index[j]);
+        }
+    }
+}
+
+
 static int test_setup_simmmock(void** state)
 {
     UNUSED(state);
@@ -358,6 +457,10 @@ int run_transform_tests(void)
             test_setup_signal, test_teardown),
         cmocka_unit_test_setup_teardown(
             test_transform__parse, test_setup_transform, test_teardown),
+        cmocka_unit_test_setup_teardown(test_transform__parse_deadband,
+            test_setup_transform, test_teardown),
+        cmocka_unit_test_setup_teardown(test_transform__marshal_changed,
+            test_setup_transform, test_teardown),
         cmocka_unit_test_setup_teardown(test_transform__marshal_to_model,
             test_setup_simmmock, test_teardown_simmock),
         //   cmocka_unit_test_setup_teardown(test_transform__marshal_from_model,